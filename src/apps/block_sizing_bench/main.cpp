@@ -0,0 +1,119 @@
+// Benchmark for class block sizing after a toggle: full compute_class_block_sizes (what the
+// canvas used to run on every toggle) vs ClassBlockSizer re-measuring only dirty blocks.
+// Runs ImGui headless with the default font; no window is opened.
+//
+// Usage: block_sizing_bench [class_count] [toggles]
+#include <diagram_loaders/synthetic_class_diagram.hpp>
+#include <diagram_render/class_block_sizer.hpp>
+#include <diagram_render/nested_expansion.hpp>
+#include <diagram_render/renderer.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+void begin_headless_frame() {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int w = 0, h = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+    ImGui::NewFrame();
+}
+
+bool same_sizes(const std::unordered_map<std::string, diagram_placement::Rect>& a,
+    const std::unordered_map<std::string, diagram_placement::Rect>& b)
+{
+    if (a.size() != b.size()) return false;
+    for (const auto& [id, r] : a) {
+        auto it = b.find(id);
+        if (it == b.end() || it->second.width != r.width || it->second.height != r.height) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? static_cast<std::size_t>(std::strtoul(argv[1], nullptr, 10)) : 20000;
+    const int toggles = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+    begin_headless_frame();
+
+    const diagram_model::ClassDiagram diagram = diagram_loaders::generate_synthetic_class_diagram(count);
+
+    // Every tenth class open, with its first parent card expanded inside it, so blocks embed
+    // other classes' content the way a working session does.
+    std::unordered_map<std::string, bool> expanded;
+    diagram_render::NestedExpansion nested;
+    for (std::size_t i = 0; i < diagram.classes.size(); i += 10) {
+        const auto& c = diagram.classes[i];
+        expanded[c.id] = true;
+        if (!c.parent_class_ids.empty()) nested.set_path(c.id + "/parent/0", true);
+    }
+
+    // The toggled card: a child card of an expanded class that has children.
+    const diagram_model::DiagramClass* owner = nullptr;
+    for (std::size_t i = 0; i < diagram.classes.size() && !owner; i += 10)
+        if (!diagram.classes[i].child_objects.empty()) owner = &diagram.classes[i];
+    if (!owner) {
+        std::fprintf(stderr, "no expanded class with children in the diagram\n");
+        return 1;
+    }
+    const std::string nested_path = owner->id + "/child/0";
+    const diagram_render::NestedPathKey nested_key = diagram_render::nested_child_key(
+        diagram_render::nested_root_key(owner->id), diagram_render::NestedSection::Child, 0);
+
+    auto t0 = Clock::now();
+    diagram_render::ClassBlockSizer sizer;
+    sizer.reset(diagram, expanded, nested);
+    const double reset_ms = ms_since(t0);
+
+    double full_ms = 0.0;
+    double incremental_ms = 0.0;
+    std::size_t measured = 0;
+    bool match = true;
+    for (int t = 0; t < toggles; ++t) {
+        nested.toggle(nested_key);
+
+        t0 = Clock::now();
+        const auto full = diagram_render::compute_class_block_sizes(diagram, expanded, nested);
+        full_ms += ms_since(t0);
+
+        t0 = Clock::now();
+        sizer.mark_block_dirty(owner->id);
+        sizer.update(expanded, nested);
+        incremental_ms += ms_since(t0);
+        measured += sizer.last_measured_count();
+
+        match = match && same_sizes(full, sizer.sizes());
+    }
+
+    std::printf("classes=%zu expanded=%zu nested open=%zu toggled=%s\n",
+        diagram.classes.size(), expanded.size(), nested.size(), nested_path.c_str());
+    std::printf("reset        %10.3f ms\n", reset_ms);
+    std::printf("full         %10.3f ms/toggle\n", full_ms / toggles);
+    std::printf("incremental  %10.3f ms/toggle  blocks measured=%.1f  speedup=%.0fx%s\n",
+        incremental_ms / toggles, static_cast<double>(measured) / toggles,
+        incremental_ms > 0.0 ? full_ms / incremental_ms : 0.0, match ? "" : "  MISMATCH");
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    return match ? 0 : 1;
+}
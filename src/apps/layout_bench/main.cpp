@@ -0,0 +1,348 @@
+// Layout benchmark: runs every placement engine over a corpus (sample JSONs + synthetic
+// diagrams) and records time, memory and layout quality. Results are written as JSON; with
+// --compare the run is checked against a baseline file and regressions are reported.
+//
+// Usage: layout_bench [--data DIR] [--sizes 100,1000,5000] [--repeats N] [--out FILE]
+//                     [--compare BASELINE] [--time-tolerance 0.25] [--quality-tolerance 0.05]
+#include <diagram_loaders/debug_class_diagram.hpp>
+#include <diagram_loaders/json_loader.hpp>
+#include <diagram_loaders/synthetic_class_diagram.hpp>
+#include <diagram_placement/class_diagram_placement.hpp>
+#include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/graph_layout.hpp>
+#include <diagram_placement/layout_metrics.hpp>
+#include <diagram_placement/orthogonal_router.hpp>
+#include <diagram_placement/physics_layout.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+using diagram_placement::LayoutMetrics;
+
+// Peak resident set of the whole process so far. It never goes down, so cases run in
+// increasing size order and each value is an upper bound for that run.
+double peak_rss_mb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<double>(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+    return 0.0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+#endif
+}
+
+struct Case {
+    std::string name;
+    std::optional<diagram_model::ClassDiagram> class_diagram;
+    std::optional<diagram_model::Diagram> diagram;
+};
+
+struct EngineResult {
+    LayoutMetrics metrics;
+    int iterations = 0;
+};
+
+struct Engine {
+    const char* name;
+    bool for_class_diagrams;
+    std::function<EngineResult(const Case&)> run;
+};
+
+struct Run {
+    std::string case_name;
+    std::string engine;
+    double time_ms = 0.0;
+    double peak_rss_mb = 0.0;
+    int iterations = 0;
+    LayoutMetrics metrics;
+};
+
+EngineResult measure_class_layout(const diagram_model::ClassDiagram& diagram,
+    const diagram_placement::PlacedClassDiagram& placed, bool orthogonal_routes)
+{
+    diagram_placement::ConnectionGeometry geometry;
+    diagram_placement::build_connection_topology(diagram, geometry);
+    if (orthogonal_routes) {
+        diagram_placement::OrthogonalRouter router;
+        router.route(placed, geometry);
+    } else {
+        diagram_placement::route_connection_lines(placed, geometry);
+    }
+    return { diagram_placement::compute_layout_metrics(placed, geometry), 0 };
+}
+
+diagram_placement::PlacedClassDiagram settle_physics(const diagram_model::ClassDiagram& diagram, int& steps) {
+    constexpr int kMaxSteps = 3000;
+    diagram_placement::PhysicsLayout layout;
+    layout.build(diagram, {}, nullptr);
+    steps = 0;
+    while (!layout.is_settled() && steps < kMaxSteps) {
+        layout.step(1.0f / 60.0f);
+        ++steps;
+    }
+    return layout.get_placed();
+}
+
+// Engines are timed including routing, since that is what a frame pays after a layout change.
+std::vector<Engine> make_engines() {
+    std::vector<Engine> engines;
+    engines.push_back({ "grid_placer", true, [](const Case& c) {
+        const auto placed = diagram_placement::place_class_diagram(*c.class_diagram, {});
+        return measure_class_layout(*c.class_diagram, placed, false);
+    } });
+    engines.push_back({ "physics", true, [](const Case& c) {
+        int steps = 0;
+        const auto placed = settle_physics(*c.class_diagram, steps);
+        EngineResult result = measure_class_layout(*c.class_diagram, placed, false);
+        result.iterations = steps;
+        return result;
+    } });
+    engines.push_back({ "physics_orthogonal", true, [](const Case& c) {
+        int steps = 0;
+        const auto placed = settle_physics(*c.class_diagram, steps);
+        EngineResult result = measure_class_layout(*c.class_diagram, placed, true);
+        result.iterations = steps;
+        return result;
+    } });
+    engines.push_back({ "graph_layout", false, [](const Case& c) {
+        diagram_placement::GraphLayout layout;
+        layout.sync(*c.diagram);
+        int iterations = 0;
+        while (!layout.is_settled() && iterations < 1000) {
+            layout.step();
+            ++iterations;
+        }
+        return EngineResult{ diagram_placement::compute_layout_metrics(layout.placed()), iterations };
+    } });
+    return engines;
+}
+
+// Node/edge view of a class diagram (one node per class, one edge per parent link), so the
+// generic engine also gets synthetic inputs of known size.
+diagram_model::Diagram to_node_diagram(const diagram_model::ClassDiagram& classes) {
+    diagram_model::Diagram out;
+    out.name = classes.name;
+    out.nodes.reserve(classes.classes.size());
+    for (const auto& c : classes.classes) {
+        diagram_model::Node node;
+        node.id = c.id;
+        node.label = c.type_name;
+        out.nodes.push_back(std::move(node));
+        for (const auto& parent : c.parent_class_ids)
+            out.edges.push_back({ c.id + "->" + parent, c.id, parent, "" });
+    }
+    return out;
+}
+
+std::vector<Case> make_corpus(const std::string& data_dir, const std::vector<std::size_t>& sizes) {
+    std::vector<Case> corpus;
+    if (auto d = diagram_loaders::load_class_diagram_from_json_file(data_dir + "/example_class_diagram.json"))
+        corpus.push_back({ "example_class_diagram", std::move(*d), std::nullopt });
+    else
+        (void)fprintf(stderr, "warning: %s/example_class_diagram.json not loaded\n", data_dir.c_str());
+    if (auto d = diagram_loaders::load_diagram_from_json_file(data_dir + "/example_diagram.json"))
+        corpus.push_back({ "example_diagram", std::nullopt, std::move(*d) });
+    else
+        (void)fprintf(stderr, "warning: %s/example_diagram.json not loaded\n", data_dir.c_str());
+    corpus.push_back({ "debug_class_diagram", diagram_loaders::generate_debug_class_diagram(), std::nullopt });
+
+    std::vector<std::size_t> sorted = sizes;
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t n : sorted) {
+        auto classes = diagram_loaders::generate_synthetic_class_diagram(n);
+        auto nodes = to_node_diagram(classes);
+        corpus.push_back({ "synthetic_" + std::to_string(n), std::move(classes), std::move(nodes) });
+    }
+    return corpus;
+}
+
+nlohmann::json to_json(const Run& r) {
+    const LayoutMetrics& m = r.metrics;
+    return {
+        { "case", r.case_name },
+        { "engine", r.engine },
+        { "time_ms", r.time_ms },
+        { "peak_rss_mb", r.peak_rss_mb },
+        { "iterations", r.iterations },
+        { "blocks", m.block_count },
+        { "edges", m.edge_count },
+        { "residual_overlaps", m.residual_overlaps },
+        { "edge_crossings", m.edge_crossings },
+        { "total_edge_length", m.total_edge_length },
+        { "bbox_width", m.bbox_width },
+        { "bbox_height", m.bbox_height },
+        { "aspect_ratio", m.aspect_ratio },
+    };
+}
+
+struct Tolerances {
+    double time = 0.25;     // relative slowdown allowed for time and memory
+    double quality = 0.05;  // relative growth allowed for crossings and edge length
+};
+
+// Prints one line per regression; returns how many were found.
+int compare_with_baseline(const std::vector<Run>& runs, const nlohmann::json& baseline, const Tolerances& tol) {
+    int regressions = 0;
+    const nlohmann::json baseline_runs = baseline.value("runs", nlohmann::json::array());
+    auto report = [&](const Run& r, const char* what, double before, double after) {
+        (void)printf("REGRESSION %s/%s %s: %.3f -> %.3f\n", r.case_name.c_str(), r.engine.c_str(), what, before, after);
+        ++regressions;
+    };
+    for (const Run& r : runs) {
+        const nlohmann::json* base = nullptr;
+        for (const auto& b : baseline_runs) {
+            if (b.value("case", "") == r.case_name && b.value("engine", "") == r.engine) {
+                base = &b;
+                break;
+            }
+        }
+        if (!base) {
+            (void)printf("new        %s/%s (not in baseline)\n", r.case_name.c_str(), r.engine.c_str());
+            continue;
+        }
+        const double time = base->value("time_ms", 0.0);
+        // Sub-millisecond runs are noise-dominated; require an absolute difference as well.
+        if (r.time_ms > time * (1.0 + tol.time) && r.time_ms - time > 1.0)
+            report(r, "time_ms", time, r.time_ms);
+        const double rss = base->value("peak_rss_mb", 0.0);
+        if (rss > 0.0 && r.peak_rss_mb > rss * (1.0 + tol.time))
+            report(r, "peak_rss_mb", rss, r.peak_rss_mb);
+        const double overlaps = base->value("residual_overlaps", 0.0);
+        if (static_cast<double>(r.metrics.residual_overlaps) > overlaps)
+            report(r, "residual_overlaps", overlaps, static_cast<double>(r.metrics.residual_overlaps));
+        const double crossings = base->value("edge_crossings", 0.0);
+        if (static_cast<double>(r.metrics.edge_crossings) > crossings * (1.0 + tol.quality)
+            && r.metrics.edge_crossings > static_cast<std::size_t>(crossings))
+            report(r, "edge_crossings", crossings, static_cast<double>(r.metrics.edge_crossings));
+        const double length = base->value("total_edge_length", 0.0);
+        if (r.metrics.total_edge_length > length * (1.0 + tol.quality) + 1e-6)
+            report(r, "total_edge_length", length, r.metrics.total_edge_length);
+    }
+    return regressions;
+}
+
+std::vector<std::size_t> parse_sizes(const std::string& s) {
+    std::vector<std::size_t> out;
+    std::size_t pos = 0;
+    while (pos < s.size()) {
+        std::size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        const std::size_t n = std::strtoul(s.substr(pos, comma - pos).c_str(), nullptr, 10);
+        if (n > 0) out.push_back(n);
+        pos = comma + 1;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string data_dir = LAYOUT_BENCH_DATA_DIR;
+    std::vector<std::size_t> sizes = { 100, 1000, 5000 };
+    int repeats = 3;
+    std::string out_path = "layout_bench_results.json";
+    std::string baseline_path;
+    Tolerances tol;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--data" && has_value) {
+            data_dir = argv[++i];
+        } else if (arg == "--sizes" && has_value) {
+            sizes = parse_sizes(argv[++i]);
+        } else if (arg == "--repeats" && has_value) {
+            repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--out" && has_value) {
+            out_path = argv[++i];
+        } else if (arg == "--compare" && has_value) {
+            baseline_path = argv[++i];
+        } else if (arg == "--time-tolerance" && has_value) {
+            tol.time = std::atof(argv[++i]);
+        } else if (arg == "--quality-tolerance" && has_value) {
+            tol.quality = std::atof(argv[++i]);
+        } else {
+            (void)fprintf(stderr, "unknown or incomplete argument: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    const std::vector<Case> corpus = make_corpus(data_dir, sizes);
+    const std::vector<Engine> engines = make_engines();
+
+    std::vector<Run> runs;
+    (void)printf("%-24s %-20s %10s %8s %6s %9s %9s %12s %7s\n",
+        "case", "engine", "time_ms", "rss_mb", "iters", "overlaps", "crossings", "edge_length", "aspect");
+    for (const Case& c : corpus) {
+        for (const Engine& engine : engines) {
+            if (engine.for_class_diagrams ? !c.class_diagram : !c.diagram) continue;
+            Run run;
+            run.case_name = c.name;
+            run.engine = engine.name;
+            run.time_ms = 1e300;
+            // Best of N: layouts are deterministic, so only the timing varies between repeats.
+            for (int r = 0; r < repeats; ++r) {
+                const auto t0 = std::chrono::steady_clock::now();
+                const EngineResult result = engine.run(c);
+                const auto t1 = std::chrono::steady_clock::now();
+                run.time_ms = std::min(run.time_ms, std::chrono::duration<double, std::milli>(t1 - t0).count());
+                run.metrics = result.metrics;
+                run.iterations = result.iterations;
+            }
+            run.peak_rss_mb = peak_rss_mb();
+            const LayoutMetrics& m = run.metrics;
+            (void)printf("%-24s %-20s %10.2f %8.1f %6d %9zu %9zu %12.0f %7.2f\n",
+                run.case_name.c_str(), run.engine.c_str(), run.time_ms, run.peak_rss_mb, run.iterations,
+                m.residual_overlaps, m.edge_crossings, m.total_edge_length, m.aspect_ratio);
+            runs.push_back(std::move(run));
+        }
+    }
+
+    nlohmann::json results = { { "schema", 1 }, { "runs", nlohmann::json::array() } };
+    for (const Run& r : runs)
+        results["runs"].push_back(to_json(r));
+    if (std::ofstream out(out_path); out) {
+        out << results.dump(2) << '\n';
+        (void)printf("results written to %s\n", out_path.c_str());
+    } else {
+        (void)fprintf(stderr, "cannot write %s\n", out_path.c_str());
+        return 2;
+    }
+
+    if (!baseline_path.empty()) {
+        std::ifstream in(baseline_path);
+        nlohmann::json baseline = nlohmann::json::parse(in, nullptr, false);
+        if (!in || baseline.is_discarded()) {
+            (void)fprintf(stderr, "cannot read baseline %s\n", baseline_path.c_str());
+            return 2;
+        }
+        const int regressions = compare_with_baseline(runs, baseline, tol);
+        (void)printf("%d regression(s) against %s\n", regressions, baseline_path.c_str());
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
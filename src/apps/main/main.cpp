@@ -5,25 +5,40 @@
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_opengl3.h"
 #include <canvas/canvas.hpp>
+#include <canvas/frame_profiler_overlay.hpp>
 #include <diagram_loaders/json_loader.hpp>
 #include <diagram_loaders/debug_class_diagram.hpp>
+#include <profiling/trace.hpp>
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 #include <SDL3/SDL_opengl.h>
 #include <cstdio>
 #include <optional>
 #include <string>
-#include <vector>
 
 int main(int argc, char* argv[])
 {
-    bool auto_overlap_test = false;
+    bool bundle_edges = false;
+    bool show_profiler = false;
+    std::string profile_csv = "frame_profile.csv";  // "Save CSV" in the overlay, --profile-csv at exit
+    bool profile_csv_at_exit = false;
+    std::string trace_path = "trace.json";  // F4 stops recording and writes here; --trace at exit
     for (int i = 1; i < argc; ++i) {
-        if (std::string(argv[i]) == "--auto-overlap-test") {
-            auto_overlap_test = true;
+        if (std::string(argv[i]) == "--bundle-edges") {
+            bundle_edges = true;
+        } else if (std::string(argv[i]) == "--profiler") {
+            show_profiler = true;
+        } else if (std::string(argv[i]) == "--profile-csv" && i + 1 < argc) {
+            profile_csv = argv[++i];
+            profile_csv_at_exit = true;
+        } else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+            profiling::set_tracing_enabled(true);
         }
     }
 
+    profiling::set_trace_thread_name("main");
+
     SDL_SetMainReady();
     // SDL3: SDL_Init returns true on success, false on failure
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
@@ -123,34 +138,11 @@ int main(int argc, char* argv[])
         class_diagram = diagram_loaders::generate_debug_class_diagram();
 
     canvas::DiagramCanvas diagram_canvas;
+    diagram_canvas.set_edge_bundling_enabled(bundle_edges);
     if (class_diagram)
         diagram_canvas.set_class_diagram(&*class_diagram);
 
     bool running = true;
-    int frame = 0;
-    struct ToggleAction {
-        int frame_index;
-        const char* id;
-        bool expanded;
-    };
-    const std::vector<ToggleAction> auto_actions = {
-        {10, "NPC", true},
-        {35, "UIElement", true},
-        {60, "Bow", true},
-        {85, "Sword", true},
-        {110, "WallTile", true},
-        {150, "NPC", false},
-        {175, "UIElement", false},
-        {200, "Bow", false},
-        {225, "Sword", false},
-        {250, "WallTile", false},
-        {290, "NPC", true},
-        {315, "UIElement", true},
-    };
-    std::size_t next_action = 0;
-    int settled_frames = 0;
-    const int max_test_frames = 1200;
-    int test_exit_code = 0;
 
     while (running) {
         SDL_Event event;
@@ -180,27 +172,21 @@ int main(int argc, char* argv[])
         }
         ImGui::End();
 
-        if (auto_overlap_test) {
-            while (next_action < auto_actions.size() && frame >= auto_actions[next_action].frame_index) {
-                diagram_canvas.set_class_block_expanded(auto_actions[next_action].id, auto_actions[next_action].expanded);
-                ++next_action;
-            }
+        // F3 toggles the frame profiler overlay.
+        if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) show_profiler = !show_profiler;
+        canvas::draw_frame_profiler_overlay(diagram_canvas.profiler(), profile_csv.c_str(), &show_profiler);
 
-            const bool all_actions_done = next_action >= auto_actions.size();
-            const bool settled = diagram_canvas.is_layout_settled();
-            if (all_actions_done && settled) {
-                ++settled_frames;
+        // F4 starts a Chrome trace; the next F4 stops it and writes trace_path.
+        if (ImGui::IsKeyPressed(ImGuiKey_F4, false)) {
+            if (!profiling::tracing_enabled()) {
+                profiling::clear_trace();
+                profiling::set_tracing_enabled(true);
             } else {
-                settled_frames = 0;
-            }
-
-            if (settled_frames >= 30 || frame >= max_test_frames) {
-                const std::size_t overlaps = diagram_canvas.current_overlap_count();
-                (void)fprintf(stderr,
-                    "[auto-overlap-test] finished frame=%d settled=%d overlap_count=%zu\n",
-                    frame, settled ? 1 : 0, overlaps);
-                test_exit_code = overlaps == 0 ? 0 : 2;
-                running = false;
+                profiling::set_tracing_enabled(false);
+                if (profiling::write_chrome_trace(trace_path))
+                    (void)fprintf(stderr, "trace written to %s\n", trace_path.c_str());
+                else
+                    (void)fprintf(stderr, "cannot write %s\n", trace_path.c_str());
             }
         }
 
@@ -214,9 +200,13 @@ int main(int argc, char* argv[])
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         SDL_GL_SwapWindow(window);
-        ++frame;
     }
 
+    if (profile_csv_at_exit && !diagram_canvas.profiler().write_csv(profile_csv))
+        (void)fprintf(stderr, "cannot write %s\n", profile_csv.c_str());
+    if (profiling::tracing_enabled() && !profiling::write_chrome_trace(trace_path))
+        (void)fprintf(stderr, "cannot write %s\n", trace_path.c_str());
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL3_Shutdown();
     ImGui::DestroyContext();
@@ -224,8 +214,5 @@ int main(int argc, char* argv[])
     SDL_GL_DestroyContext(gl_context);
     SDL_DestroyWindow(window);
     SDL_Quit();
-    if (auto_overlap_test) {
-        return test_exit_code;
-    }
     return 0;
 }
@@ -0,0 +1,102 @@
+// Microbenchmark for the rectangle overlap kernels: all-pairs overlap count over random rects,
+// plain pairwise loop vs RectBatch with each kernel the CPU supports.
+//
+// Usage: rect_overlap_bench [rect_count] [repeats]
+#include <diagram_placement/rect_batch.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+using diagram_placement::RectBatch;
+using diagram_placement::RectBatchIsa;
+
+struct Rect {
+    double left, top, right, bottom;
+};
+
+constexpr double kGap = 4.0;
+
+std::size_t count_pairs_plain(const std::vector<Rect>& rects) {
+    std::size_t pairs = 0;
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        const Rect& a = rects[i];
+        for (std::size_t j = i + 1; j < rects.size(); ++j) {
+            const Rect& b = rects[j];
+            if (a.right + kGap <= b.left || b.right + kGap <= a.left
+                || a.bottom + kGap <= b.top || b.bottom + kGap <= a.top)
+                continue;
+            ++pairs;
+        }
+    }
+    return pairs;
+}
+
+std::size_t count_pairs_batch(const RectBatch& batch) {
+    std::size_t pairs = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        batch.for_each_overlap(batch.left(i), batch.top(i), batch.right(i), batch.bottom(i), i + 1,
+            kGap, false, [&](std::size_t) { ++pairs; });
+    }
+    return pairs;
+}
+
+template <class Fn>
+double best_ms(int repeats, std::size_t& result, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        result = fn();
+        const auto t1 = std::chrono::steady_clock::now();
+        const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? static_cast<std::size_t>(std::strtoul(argv[1], nullptr, 10)) : 4000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    // Block-sized rects on a square area with roughly constant density.
+    std::mt19937 rng(12345);
+    const double side = 120.0 * std::sqrt(static_cast<double>(count));
+    std::uniform_real_distribution<double> pos(0.0, side);
+    std::uniform_real_distribution<double> size(40.0, 220.0);
+    std::vector<Rect> rects(count);
+    RectBatch batch;
+    batch.reserve(count);
+    for (auto& r : rects) {
+        r.left = pos(rng);
+        r.top = pos(rng);
+        r.right = r.left + size(rng);
+        r.bottom = r.top + size(rng);
+        batch.push_back(r.left, r.top, r.right, r.bottom);
+    }
+
+    std::size_t pairs = 0;
+    const double plain_ms = best_ms(repeats, pairs, [&] { return count_pairs_plain(rects); });
+    (void)printf("rects=%zu pairs tested=%zu\n", count, count * (count - 1) / 2);
+    (void)printf("%-8s %10.3f ms  overlaps=%zu\n", "plain", plain_ms, pairs);
+
+    const RectBatchIsa default_isa = diagram_placement::rect_batch_isa();
+    for (RectBatchIsa isa : { RectBatchIsa::Scalar, RectBatchIsa::Sse2, RectBatchIsa::Avx2 }) {
+        if (!diagram_placement::set_rect_batch_isa(isa)) {
+            (void)printf("%-8s unavailable\n", diagram_placement::rect_batch_isa_name(isa));
+            continue;
+        }
+        std::size_t batch_pairs = 0;
+        const double ms = best_ms(repeats, batch_pairs, [&] { return count_pairs_batch(batch); });
+        (void)printf("%-8s %10.3f ms  overlaps=%zu  speedup=%.2fx%s\n",
+            diagram_placement::rect_batch_isa_name(isa), ms, batch_pairs, plain_ms / ms,
+            batch_pairs == pairs ? "" : "  MISMATCH");
+    }
+    diagram_placement::set_rect_batch_isa(default_isa);
+    return 0;
+}
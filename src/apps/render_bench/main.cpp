@@ -0,0 +1,259 @@
+// Headless render benchmark: drives DiagramCanvas::update_and_draw on synthetic class diagrams
+// with a scripted camera and reports per-frame draw-list build time, vertex/index counts and
+// heap allocations for several zoom levels and expansion ratios. ImGui runs with the default
+// font and its atlas built in memory; no window, no GPU. Allocations are counted by
+// profiling_alloc_hooks and split by frame profiler phase. Each camera lap is run twice and only
+// the second is measured, so the frames are steady state; with --max-steady-allocs the bench
+// fails if any of them allocates more.
+//
+// Usage: render_bench [--classes 2000] [--expanded 0,0.1,0.5,1] [--zooms 0.1,0.25,0.5,1,2]
+//                     [--frames 120] [--settle-frames 900] [--max-steady-allocs N]
+#include <canvas/canvas.hpp>
+#include <diagram_loaders/synthetic_class_diagram.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <profiling/allocation_counters.hpp>
+#include <profiling/frame_profiler.hpp>
+#include "imgui.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float display_width = 1920.0f;
+constexpr float display_height = 1080.0f;
+constexpr float camera_radius_px = 240.0f;  // the camera circles the focus point at this radius
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+struct FrameStats {
+    double build_ms = 0.0;   // update_and_draw: input, physics, lines, draw-list build
+    double render_ms = 0.0;  // ImGui::Render
+    int vertices = 0;
+    int indices = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t allocated_bytes = 0;
+    std::array<std::int64_t, profiling::frame_phase_count> phase_allocations{};  // inside update_and_draw
+};
+
+// Allocations per frame by phase for one (expanded, zoom) run.
+struct AllocationRow {
+    double ratio = 0.0;
+    double zoom = 0.0;
+    std::array<double, profiling::frame_phase_count> phase_mean{};
+    std::uint64_t worst = 0;  // most allocations in one frame
+    std::array<std::int64_t, profiling::frame_phase_count> worst_phases{};
+};
+
+// One ImGui frame with the canvas filling the display, like the app's main window.
+FrameStats run_frame(canvas::DiagramCanvas& canvas) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(display_width, display_height);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int w = 0, h = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+
+    FrameStats stats;
+    const profiling::AllocationCount allocs_before = profiling::process_allocations();
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("Diagram", nullptr,
+        ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoBringToFrontOnFocus);
+    const ImVec2 canvas_size = ImGui::GetContentRegionAvail();
+    ImGui::BeginChild("canvas", canvas_size, false, ImGuiWindowFlags_NoScrollbar);
+    auto t0 = Clock::now();
+    canvas.update_and_draw(canvas_size.x, canvas_size.y);
+    stats.build_ms = ms_since(t0);
+    ImGui::EndChild();
+    ImGui::End();
+
+    t0 = Clock::now();
+    ImGui::Render();
+    stats.render_ms = ms_since(t0);
+    if (const ImDrawData* data = ImGui::GetDrawData()) {
+        stats.vertices = data->TotalVtxCount;
+        stats.indices = data->TotalIdxCount;
+    }
+    const profiling::AllocationCount allocs_after = profiling::process_allocations();
+    stats.allocations = allocs_after.count - allocs_before.count;
+    stats.allocated_bytes = allocs_after.bytes - allocs_before.bytes;
+    if (const profiling::FrameSample* sample = canvas.profiler().last())
+        stats.phase_allocations = sample->phase_allocations;
+    return stats;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const std::size_t i = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    return values[std::min(i, values.size() - 1)];
+}
+
+std::vector<double> parse_list(const std::string& s) {
+    std::vector<double> out;
+    std::size_t pos = 0;
+    while (pos < s.size()) {
+        std::size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) comma = s.size();
+        out.push_back(std::atof(s.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::size_t class_count = 2000;
+    std::vector<double> expanded_ratios = { 0.0, 0.1, 0.5, 1.0 };
+    std::vector<double> zooms = { 0.1, 0.25, 0.5, 1.0, 2.0 };
+    int frames = 120;
+    int settle_frames = 900;
+    long long max_steady_allocs = -1;  // no limit
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--classes" && has_value) {
+            class_count = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--expanded" && has_value) {
+            expanded_ratios = parse_list(argv[++i]);
+        } else if (arg == "--zooms" && has_value) {
+            zooms = parse_list(argv[++i]);
+        } else if (arg == "--frames" && has_value) {
+            frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--settle-frames" && has_value) {
+            settle_frames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--max-steady-allocs" && has_value) {
+            max_steady_allocs = std::max(0LL, std::atoll(argv[++i]));
+        } else {
+            (void)fprintf(stderr, "unknown or incomplete argument: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+
+    const diagram_model::ClassDiagram diagram = diagram_loaders::generate_synthetic_class_diagram(class_count);
+    const std::string& focus_id = diagram.classes[diagram.classes.size() / 2].id;
+
+    (void)printf("classes=%zu frames=%d display=%.0fx%.0f\n",
+        diagram.classes.size(), frames, display_width, display_height);
+    (void)printf("%9s %6s %7s %10s %10s %10s %10s %10s %10s %12s %12s\n",
+        "expanded", "zoom", "settle", "build_ms", "build_p95", "build_max", "render_ms",
+        "vertices", "indices", "allocs/frame", "KiB/frame");
+
+    std::vector<AllocationRow> allocation_rows;
+    bool over_limit = false;
+    for (const double ratio : expanded_ratios) {
+        // A fresh canvas per ratio, so each starts from the same placement.
+        canvas::DiagramCanvas canvas;
+        canvas.set_class_diagram(&diagram);
+        // Every 1/ratio-th class, spread evenly over the diagram.
+        for (std::size_t i = 0; i < diagram.classes.size(); ++i) {
+            if (std::floor(static_cast<double>(i + 1) * ratio) > std::floor(static_cast<double>(i) * ratio))
+                canvas.set_class_block_expanded(diagram.classes[i].id, true);
+        }
+
+        int settled_after = 0;
+        canvas.set_zoom(1.0f);
+        while (settled_after < settle_frames && !canvas.is_layout_settled()) {
+            run_frame(canvas);
+            ++settled_after;
+        }
+
+        for (const double zoom : zooms) {
+            canvas.set_zoom(static_cast<float>(zoom));
+            // One frame so the canvas knows its region size, then centre the focus class.
+            run_frame(canvas);
+            canvas.focus_on_class(focus_id);
+
+            std::vector<double> build_ms;
+            double render_ms = 0.0;
+            double vertices = 0.0;
+            double indices = 0.0;
+            double allocations = 0.0;
+            double bytes = 0.0;
+            AllocationRow row;
+            row.ratio = ratio;
+            row.zoom = zoom;
+            // Scripted camera: circle around the focus point, one turn per lap. The first lap
+            // fills the caches for every card on the way and is not measured.
+            for (int lap = 0; lap < 2; ++lap) {
+                float angle = 0.0f;
+                for (int f = 0; f < frames; ++f) {
+                    const float next = 6.2831853f * static_cast<float>(f + 1) / static_cast<float>(frames);
+                    canvas.pan(camera_radius_px * (std::cos(next) - std::cos(angle)),
+                        camera_radius_px * (std::sin(next) - std::sin(angle)));
+                    angle = next;
+
+                    const FrameStats s = run_frame(canvas);
+                    if (lap == 0) continue;
+                    build_ms.push_back(s.build_ms);
+                    render_ms += s.render_ms;
+                    vertices += s.vertices;
+                    indices += s.indices;
+                    allocations += static_cast<double>(s.allocations);
+                    bytes += static_cast<double>(s.allocated_bytes);
+                    for (std::size_t p = 0; p < profiling::frame_phase_count; ++p)
+                        row.phase_mean[p] += static_cast<double>(s.phase_allocations[p]) / frames;
+                    if (s.allocations > row.worst) {
+                        row.worst = s.allocations;
+                        row.worst_phases = s.phase_allocations;
+                    }
+                }
+            }
+            allocation_rows.push_back(row);
+            if (max_steady_allocs >= 0 && row.worst > static_cast<std::uint64_t>(max_steady_allocs))
+                over_limit = true;
+
+            double build_sum = 0.0;
+            for (double ms : build_ms) build_sum += ms;
+            const double n = static_cast<double>(frames);
+            (void)printf("%9.2f %6.2f %7d %10.3f %10.3f %10.3f %10.3f %10.0f %10.0f %12.1f %12.1f\n",
+                ratio, zoom, settled_after, build_sum / n, percentile(build_ms, 0.95),
+                percentile(build_ms, 1.0), render_ms / n, vertices / n, indices / n,
+                allocations / n, bytes / n / 1024.0);
+        }
+    }
+
+    // Where the allocations of a frame come from; the rest of a frame (ImGui itself) is
+    // the difference to allocs/frame above.
+    (void)printf("\nallocations per frame inside update_and_draw, by phase (mean; worst frame in brackets)\n");
+    (void)printf("%9s %6s", "expanded", "zoom");
+    for (std::size_t p = 0; p < profiling::frame_phase_count; ++p)
+        (void)printf(" %16s", profiling::frame_phase_name(static_cast<profiling::FramePhase>(p)));
+    (void)printf(" %10s\n", "worst");
+    for (const AllocationRow& row : allocation_rows) {
+        (void)printf("%9.2f %6.2f", row.ratio, row.zoom);
+        for (std::size_t p = 0; p < profiling::frame_phase_count; ++p) {
+            char cell[32];
+            (void)snprintf(cell, sizeof(cell), "%.1f [%lld]", row.phase_mean[p],
+                static_cast<long long>(row.worst_phases[p]));
+            (void)printf(" %16s", cell);
+        }
+        (void)printf(" %10llu%s\n", static_cast<unsigned long long>(row.worst),
+            max_steady_allocs >= 0 && row.worst > static_cast<std::uint64_t>(max_steady_allocs) ? "  OVER LIMIT" : "");
+    }
+
+    ImGui::DestroyContext();
+    if (over_limit) {
+        (void)fprintf(stderr, "steady-state frames allocated more than %lld times\n", max_steady_allocs);
+        return 1;
+    }
+    return 0;
+}
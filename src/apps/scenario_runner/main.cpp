@@ -0,0 +1,150 @@
+// Headless scenario runner: plays a scripted interaction (expand, collapse, nested toggles, block
+// drags, pan, zoom; see scenario/scenario.hpp) against a class diagram with a fixed time step
+// and reports, per step, the time spent, frames until the layout settled and block overlaps,
+// then the final overlap count. ImGui runs with the default font and its atlas built in memory;
+// no window, no GPU. Meant as a repeatable interactive perf and overlap regression test:
+// the exit code is 2 if blocks still overlap at the end, 3 if the layout never settled.
+//
+// Usage: scenario_runner <scenario.json> [--diagram <class_diagram.json> | --classes N]
+//                        [--trace <file>]
+// The diagram defaults to the scenario's "diagram" entry, relative to the scenario file.
+#include <canvas/canvas.hpp>
+#include <diagram_loaders/json_loader.hpp>
+#include <diagram_loaders/synthetic_class_diagram.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <profiling/trace.hpp>
+#include <scenario/scenario.hpp>
+#include <scenario/scenario_runner.hpp>
+#include "imgui.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace {
+
+constexpr float display_width = 1920.0f;
+constexpr float display_height = 1080.0f;
+
+// One ImGui frame with the canvas filling the display, like the app's main window.
+double run_frame(canvas::DiagramCanvas& canvas, float dt) {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(display_width, display_height);
+    io.DeltaTime = dt;
+    unsigned char* pixels = nullptr;
+    int w = 0, h = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin("Diagram", nullptr,
+        ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove
+        | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoBringToFrontOnFocus);
+    const ImVec2 canvas_size = ImGui::GetContentRegionAvail();
+    ImGui::BeginChild("canvas", canvas_size, false, ImGuiWindowFlags_NoScrollbar);
+    canvas.update_and_draw(canvas_size.x, canvas_size.y);
+    ImGui::EndChild();
+    ImGui::End();
+    ImGui::Render();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+const char* step_trigger(const scenario::ScenarioStep& step, char* buf, std::size_t size) {
+    switch (step.trigger) {
+    case scenario::StepTrigger::AtFrame: (void)snprintf(buf, size, "@%d", step.at_frame); return buf;
+    case scenario::StepTrigger::AfterSettle: return "settled";
+    case scenario::StepTrigger::AfterPrevious: break;
+    }
+    return "next";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string scenario_path;
+    std::string diagram_path;
+    std::size_t class_count = 0;  // synthetic diagram instead of a file
+    std::string trace_path;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--diagram" && has_value) {
+            diagram_path = argv[++i];
+        } else if (arg == "--classes" && has_value) {
+            class_count = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--trace" && has_value) {
+            trace_path = argv[++i];
+        } else if (scenario_path.empty() && !arg.empty() && arg[0] != '-') {
+            scenario_path = arg;
+        } else {
+            (void)fprintf(stderr, "unknown or incomplete argument: %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (scenario_path.empty()) {
+        (void)fprintf(stderr, "usage: scenario_runner <scenario.json> [--diagram <file> | --classes N] [--trace <file>]\n");
+        return 1;
+    }
+
+    std::string error;
+    const std::optional<scenario::Scenario> script = scenario::load_scenario_from_json_file(scenario_path, &error);
+    if (!script) {
+        (void)fprintf(stderr, "%s: %s\n", scenario_path.c_str(), error.c_str());
+        return 1;
+    }
+    if (diagram_path.empty() && class_count == 0 && !script->diagram.empty())
+        diagram_path = (std::filesystem::path(scenario_path).parent_path() / script->diagram).string();
+
+    std::optional<diagram_model::ClassDiagram> class_diagram;
+    if (class_count > 0) {
+        class_diagram = diagram_loaders::generate_synthetic_class_diagram(class_count);
+    } else if (!diagram_path.empty()) {
+        class_diagram = diagram_loaders::load_class_diagram_from_json_file(diagram_path);
+        if (!class_diagram) {
+            (void)fprintf(stderr, "cannot load class diagram %s\n", diagram_path.c_str());
+            return 1;
+        }
+    } else {
+        (void)fprintf(stderr, "no diagram: the scenario has none, pass --diagram or --classes\n");
+        return 1;
+    }
+
+    profiling::set_trace_thread_name("main");
+    if (!trace_path.empty()) profiling::set_tracing_enabled(true);
+
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+
+    canvas::DiagramCanvas diagram_canvas;
+    diagram_canvas.set_class_diagram(&*class_diagram);
+    const scenario::ScenarioReport report = scenario::run_scenario(diagram_canvas, *script, run_frame);
+
+    (void)printf("scenario=%s classes=%zu dt=%.4f steps=%zu\n", scenario_path.c_str(),
+        class_diagram->classes.size(), script->dt, script->steps.size());
+    (void)printf("%4s %8s %14s %-24s %6s %6s %10s %10s %10s %7s %8s %8s\n",
+        "step", "trigger", "action", "target", "frame", "frames", "action_ms", "total_ms", "max_frame",
+        "settle", "peak_ov", "end_ov");
+    for (const scenario::StepReport& r : report.steps) {
+        const scenario::ScenarioStep& step = script->steps[r.step];
+        char trigger[16];
+        (void)printf("%4zu %8s %14s %-24s %6d %6d %10.3f %10.3f %10.3f %7d %8zu %8zu%s\n",
+            r.step, step_trigger(step, trigger, sizeof(trigger)), scenario::step_action_name(step.action),
+            step.target.c_str(), r.start_frame, r.frames, r.action_ms, r.total_ms, r.max_frame_ms,
+            r.settle_frames, r.peak_overlap, r.end_overlap, r.applied ? "" : "  NOT APPLIED");
+    }
+    if (report.steps.size() < script->steps.size())
+        (void)printf("steps not reached: %zu\n", script->steps.size() - report.steps.size());
+    (void)printf("frames=%d total_ms=%.3f settled=%d peak_overlap=%zu final_overlap=%zu\n",
+        report.frames, report.total_ms, report.settled ? 1 : 0, report.peak_overlap, report.final_overlap);
+
+    ImGui::DestroyContext();
+    if (!trace_path.empty() && !profiling::write_chrome_trace(trace_path))
+        (void)fprintf(stderr, "cannot write %s\n", trace_path.c_str());
+    if (report.final_overlap > 0) return 2;
+    return report.settled ? 0 : 3;
+}
@@ -4,7 +4,16 @@
 #include <diagram_model/class_diagram.hpp>
 #include <diagram_placement/physics_layout.hpp>
 #include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/edge_bundling.hpp>
+#include <diagram_placement/graph_layout.hpp>
+#include <diagram_placement/orthogonal_router.hpp>
+#include <diagram_render/class_block_sizer.hpp>
+#include <diagram_render/class_diagram_render_cache.hpp>
+#include <diagram_render/nested_expansion.hpp>
 #include <diagram_render/nested_hit_button.hpp>
+#include <diagram_render/viewport_culling.hpp>
+#include <profiling/frame_profiler.hpp>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -19,6 +28,7 @@ public:
     DiagramCanvas();
     ~DiagramCanvas();
 
+    // Passing the same diagram again re-reads it (call after editing it in place).
     void set_diagram(const diagram_model::Diagram* diagram);
     const diagram_model::Diagram* diagram() const;
 
@@ -28,16 +38,27 @@ public:
     const std::unordered_map<std::string, bool>& class_expanded() const { return class_expanded_; }
     bool set_class_block_expanded(const std::string& class_id, bool expanded);
 
-    std::unordered_map<std::string, bool>& nested_expanded() { return nested_expanded_; }
-    const std::unordered_map<std::string, bool>& nested_expanded() const { return nested_expanded_; }
+    // Expanded nested cards; NestedExpansion::set_path / expanded_paths give the string form.
+    diagram_render::NestedExpansion& nested_expanded() { return nested_expanded_; }
+    const diagram_render::NestedExpansion& nested_expanded() const { return nested_expanded_; }
+    // Expands or collapses the nested card at a string path ("Player/child/0/parent/1") and
+    // re-measures its block; false if the path is malformed or its class is unknown.
+    bool set_nested_card_expanded(const std::string& path, bool expanded);
 
     void focus_on_class(const std::string& class_id);
 
+    // Drag without the mouse (scenario runner): moves the block's top-left corner by (dx, dy)
+    // world units from where it was at begin_block_drag, as an Alt+drag would.
+    bool begin_block_drag(const std::string& class_id);
+    void drag_block_by(double dx, double dy);
+    void end_block_drag();
+
     void set_grid_step(float step) { grid_step_ = step; }
     float grid_step() const { return grid_step_; }
 
     void pan(float dx, float dy);
     void zoom_at(float screen_x, float screen_y, float zoom_delta);
+    // Keeps the point at the centre of the last drawn region in place, like focus_on_class.
     void zoom_at_center(float zoom_delta);
 
     void screen_to_world(float screen_x, float screen_y, double& world_x, double& world_y) const;
@@ -52,20 +73,41 @@ public:
     std::size_t current_overlap_count() const { return active_overlap_pairs_.size(); }
     bool is_layout_settled() const { return physics_layout_.is_settled(); }
 
+    // Merge lines that share a target anchor (hub classes) into one trunk per hub.
+    void set_edge_bundling_enabled(bool enabled);
+    bool edge_bundling_enabled() const { return edge_bundling_enabled_; }
+
     bool update_and_draw(float region_width, float region_height);
 
+    // Phase timings and counters of the last update_and_draw calls.
+    profiling::FrameProfiler& profiler() { return profiler_; }
+    const profiling::FrameProfiler& profiler() const { return profiler_; }
+
 private:
     const diagram_model::Diagram* diagram_ = nullptr;
+    diagram_placement::GraphLayout graph_layout_;
     const diagram_model::ClassDiagram* class_diagram_ = nullptr;
     std::unordered_map<std::string, bool> class_expanded_;
-    std::unordered_map<std::string, bool> nested_expanded_;
+    diagram_render::NestedExpansion nested_expanded_;
+    diagram_render::ClassBlockSizer block_sizer_;
     std::vector<diagram_render::NestedHitButton> nested_hit_buttons_;
     std::vector<diagram_render::NavHitButton> nav_hit_buttons_;
     std::vector<diagram_render::ClassHoverRegion> hover_regions_;
     std::string hovered_class_id_;
     std::unordered_set<std::string> highlighted_class_ids_;
-    std::vector<diagram_placement::ConnectionLine> connection_lines_;
+    diagram_placement::ConnectionGeometry connection_lines_;
     bool connection_lines_dirty_ = true;
+    diagram_placement::OrthogonalRouter edge_router_;
+    diagram_placement::ConnectionBundles connection_bundles_;
+    bool edge_bundling_enabled_ = false;
+    diagram_render::ClassDiagramRenderCache render_cache_;
+    // Placement of the last physics generation and the block grid over it, shared by culling,
+    // picking, hover and the overlap audit.
+    diagram_placement::PlacedClassDiagram displayed_;
+    diagram_render::ClassDiagramCullIndex cull_index_;
+    std::uint64_t displayed_generation_ = ~std::uint64_t{ 0 };  // physics generation of displayed_
+    std::uint64_t overlap_generation_ = ~std::uint64_t{ 0 };    // generation log_visual_overlaps checked
+    std::vector<std::uint32_t> blocks_at_;                       // scratch for point queries
     diagram_placement::PhysicsLayout physics_layout_;
     float offset_x_ = 0;
     float offset_y_ = 0;
@@ -82,13 +124,23 @@ private:
     std::string dragged_block_id_;
     double dragged_block_offset_x_ = 0.0;
     double dragged_block_offset_y_ = 0.0;
-    std::unordered_set<std::string> active_overlap_pairs_;
+    bool scripted_drag_ = false;  // begin_block_drag: offsets hold the block's start corner
+    // Overlapping pairs of the last audited placement as sorted packed class indices
+    // (overlap_pair_key in canvas.cpp), and the buffer the next audit fills.
+    std::vector<std::uint64_t> active_overlap_pairs_;
+    std::vector<std::uint64_t> overlap_scratch_;
     bool settle_error_reported_ = false;
+    profiling::FrameProfiler profiler_;
 
     void draw_grid(ImVec2 region_min, ImVec2 region_max);
+    const diagram_placement::PlacedClassDiagram& displayed_blocks();
+    const diagram_placement::PlacedClassBlock* pick_block_at(double wx, double wy);
     void handle_input(float region_width, float region_height);
     bool try_toggle_class_expanded(float screen_x, float screen_y);
+    void resize_class_block(const std::string& class_id);
     void log_visual_overlaps(const diagram_placement::PlacedClassDiagram& displayed);
+    void report_unsettled_overlaps();
+    std::string overlap_pair_name(std::uint64_t key) const;
 };
 
 } // namespace canvas
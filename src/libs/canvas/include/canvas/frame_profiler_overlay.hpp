@@ -0,0 +1,12 @@
+#pragma once
+
+#include <profiling/frame_profiler.hpp>
+
+namespace canvas {
+
+// Floating window with the last frame and rolling p50/p95/p99/max of every phase and counter.
+// Call between NewFrame and Render, outside other windows. Its "Save CSV" button writes the
+// recorded frames to csv_path. Clearing *open closes it.
+void draw_frame_profiler_overlay(const profiling::FrameProfiler& profiler, const char* csv_path, bool* open);
+
+} // namespace canvas
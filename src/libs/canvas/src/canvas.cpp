@@ -1,13 +1,17 @@
 #include <canvas/canvas.hpp>
-#include <diagram_placement/placer.hpp>
 #include <diagram_placement/class_diagram_layout_constants.hpp>
 #include <diagram_render/renderer.hpp>
+#include <diagram_render/text_measure_cache.hpp>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/spdlog.h>
 #include "imgui.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -15,14 +19,8 @@ namespace {
 const float class_button_size = 20.0f;
 const float class_padding = 8.0f;
 const float class_header_height = 28.0f;
-
-struct Obb {
-    double cx = 0.0;
-    double cy = 0.0;
-    double ex = 0.0;
-    double ey = 0.0;
-    double angle = 0.0;
-};
+const float grid_min_step_px = 8.0f;  // closest two grid lines get on screen
+const int grid_major_every = 5;        // grid levels are 5x apart
 
 std::filesystem::path find_project_root() {
     std::filesystem::path p = std::filesystem::current_path();
@@ -44,7 +42,11 @@ std::shared_ptr<spdlog::logger> overlap_logger() {
         const std::filesystem::path logs_dir = find_project_root() / "logs";
         std::filesystem::create_directories(logs_dir);
         const std::filesystem::path log_file = logs_dir / "diagram_overlap_latest.log";
-        logger = spdlog::basic_logger_mt("diagram_overlap_logger", log_file.string(), true);
+        // Asynchronous: the frame only formats and enqueues; writing and flushing happen on
+        // spdlog's background thread. When the queue is full the oldest message is dropped
+        // rather than blocking the frame.
+        logger = spdlog::create_async_nb<spdlog::sinks::basic_file_sink_mt>(
+            "diagram_overlap_logger", log_file.string(), true);
         logger->set_level(spdlog::level::info);
         logger->flush_on(spdlog::level::info);
         logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
@@ -55,76 +57,23 @@ std::shared_ptr<spdlog::logger> overlap_logger() {
     return logger;
 }
 
-Obb to_obb(const diagram_placement::Rect& r) {
-    Obb o;
-    o.cx = r.x + r.width * 0.5;
-    o.cy = r.y + r.height * 0.5;
-    o.ex = r.width * 0.5;
-    o.ey = r.height * 0.5;
-    o.angle = 0.0;
-    return o;
-}
-
-void obb_axes(const Obb& o, double& ax1x, double& ax1y, double& ax2x, double& ax2y) {
-    const double c = std::cos(o.angle);
-    const double s = std::sin(o.angle);
-    ax1x = c;  ax1y = s;
-    ax2x = -s; ax2y = c;
-}
-
-double projected_radius(const Obb& o, double lx, double ly) {
-    double a1x, a1y, a2x, a2y;
-    obb_axes(o, a1x, a1y, a2x, a2y);
-    const double p1 = std::abs(a1x * lx + a1y * ly) * o.ex;
-    const double p2 = std::abs(a2x * lx + a2y * ly) * o.ey;
-    return p1 + p2;
-}
-
-bool obb_intersects(const Obb& a, const Obb& b) {
-    const double dx = b.cx - a.cx;
-    const double dy = b.cy - a.cy;
-    double a1x, a1y, a2x, a2y, b1x, b1y, b2x, b2y;
-    obb_axes(a, a1x, a1y, a2x, a2y);
-    obb_axes(b, b1x, b1y, b2x, b2y);
-
-    const std::vector<std::pair<double, double>> axes = {
-        {a1x, a1y}, {a2x, a2y}, {b1x, b1y}, {b2x, b2y}
-    };
-    for (const auto& axis : axes) {
-        const double lx = axis.first;
-        const double ly = axis.second;
-        const double dist = std::abs(dx * lx + dy * ly);
-        const double ra = projected_radius(a, lx, ly);
-        const double rb = projected_radius(b, lx, ly);
-        if (dist > ra + rb) {
-            return false;
-        }
-    }
-    return true;
+// An overlapping pair as two class indices, the smaller one in the high half, so sorted keys
+// group pairs by their first class.
+std::uint64_t overlap_pair_key(std::size_t a, std::size_t b) {
+    if (a > b) std::swap(a, b);
+    return (static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b);
 }
 
-std::string pair_key(const std::string& a, const std::string& b) {
-    if (a < b) return a + "|" + b;
-    return b + "|" + a;
-}
+std::size_t overlap_pair_first(std::uint64_t key) { return static_cast<std::size_t>(key >> 32); }
+std::size_t overlap_pair_second(std::uint64_t key) { return static_cast<std::size_t>(key & 0xFFFFFFFFu); }
 
-bool pick_block_at(const diagram_placement::PlacedClassDiagram& placed,
-    double wx,
-    double wy,
-    std::string& out_id,
-    diagram_placement::Rect& out_rect)
+// get_placed emits blocks in class order, so a class's block is found by binary search.
+const diagram_placement::PlacedClassBlock* find_displayed_block(
+    const diagram_placement::PlacedClassDiagram& displayed, std::size_t class_index)
 {
-    for (auto it = placed.blocks.rbegin(); it != placed.blocks.rend(); ++it) {
-        const auto& b = *it;
-        if (wx >= b.rect.x && wx <= b.rect.x + b.rect.width &&
-            wy >= b.rect.y && wy <= b.rect.y + b.rect.height)
-        {
-            out_id = b.class_id;
-            out_rect = b.rect;
-            return true;
-        }
-    }
-    return false;
+    auto it = std::lower_bound(displayed.blocks.begin(), displayed.blocks.end(), class_index,
+        [](const diagram_placement::PlacedClassBlock& block, std::size_t ci) { return block.class_index < ci; });
+    return it != displayed.blocks.end() && it->class_index == class_index ? &*it : nullptr;
 }
 
 } // namespace
@@ -137,6 +86,8 @@ DiagramCanvas::~DiagramCanvas() = default;
 
 void DiagramCanvas::set_diagram(const diagram_model::Diagram* diagram) {
     diagram_ = diagram;
+    if (diagram_) graph_layout_.sync(*diagram_, true);
+    else graph_layout_.clear();
 }
 
 const diagram_model::Diagram* DiagramCanvas::diagram() const {
@@ -146,14 +97,33 @@ const diagram_model::Diagram* DiagramCanvas::diagram() const {
 void DiagramCanvas::set_class_diagram(const diagram_model::ClassDiagram* class_diagram) {
     class_diagram_ = class_diagram;
     dragging_block_ = false;
+    scripted_drag_ = false;
     dragged_block_id_.clear();
     active_overlap_pairs_.clear();
     settle_error_reported_ = false;
     connection_lines_dirty_ = true;
-    if (!class_diagram_) return;
+    connection_lines_.clear();
+    connection_bundles_.clear();
+    edge_router_.reset();
+    render_cache_.reset();
+    // Hit regions refer to classes of the previous diagram by index.
+    nested_hit_buttons_.clear();
+    nav_hit_buttons_.clear();
+    hover_regions_.clear();
+    displayed_.blocks.clear();
+    cull_index_.clear();
+    displayed_generation_ = ~std::uint64_t{ 0 };
+    overlap_generation_ = ~std::uint64_t{ 0 };
+    // Measured strings of the previous diagram are not needed any more.
+    diagram_render::TextMeasureCache::shared().invalidate();
+    if (!class_diagram_) {
+        block_sizer_.clear();
+        return;
+    }
 
-    auto block_sizes = diagram_render::compute_class_block_sizes(*class_diagram_, class_expanded_, nested_expanded_);
-    physics_layout_.build(*class_diagram_, class_expanded_, &block_sizes);
+    diagram_placement::build_connection_topology(*class_diagram_, connection_lines_);
+    block_sizer_.reset(*class_diagram_, class_expanded_, nested_expanded_);
+    physics_layout_.build(*class_diagram_, class_expanded_, &block_sizer_.sizes());
 }
 
 bool DiagramCanvas::set_class_block_expanded(const std::string& class_id, bool expanded) {
@@ -168,18 +138,61 @@ bool DiagramCanvas::set_class_block_expanded(const std::string& class_id, bool e
     if (!found) return false;
 
     class_expanded_[class_id] = expanded;
-    auto block_sizes = diagram_render::compute_class_block_sizes(*class_diagram_, class_expanded_, nested_expanded_);
-    auto it = block_sizes.find(class_id);
-    if (it != block_sizes.end()) {
-        physics_layout_.update_block_size(class_id, it->second.width, it->second.height, expanded);
-    } else {
-        physics_layout_.build(*class_diagram_, class_expanded_, &block_sizes);
-    }
+    resize_class_block(class_id);
     settle_error_reported_ = false;
     connection_lines_dirty_ = true;
     return true;
 }
 
+bool DiagramCanvas::set_nested_card_expanded(const std::string& path, bool expanded) {
+    if (!class_diagram_) return false;
+    std::string_view block_id;
+    const auto key = diagram_render::nested_path_key(path, &block_id);
+    if (!key || !block_sizer_.size_of(std::string(block_id))) return false;
+
+    nested_expanded_.set(*key, expanded);
+    resize_class_block(std::string(block_id));
+    settle_error_reported_ = false;
+    connection_lines_dirty_ = true;
+    return true;
+}
+
+bool DiagramCanvas::begin_block_drag(const std::string& class_id) {
+    if (!class_diagram_ || dragging_block_) return false;
+    for (const auto& block : displayed_blocks().blocks) {
+        if (block.class_id != class_id) continue;
+        dragging_block_ = true;
+        scripted_drag_ = true;
+        dragged_block_id_ = class_id;
+        dragged_block_offset_x_ = block.rect.x;
+        dragged_block_offset_y_ = block.rect.y;
+        physics_layout_.begin_drag(dragged_block_id_);
+        dragging_ = false;
+        return true;
+    }
+    return false;
+}
+
+void DiagramCanvas::drag_block_by(double dx, double dy) {
+    if (!scripted_drag_) return;
+    physics_layout_.drag_to(dragged_block_id_, dragged_block_offset_x_ + dx, dragged_block_offset_y_ + dy);
+}
+
+void DiagramCanvas::end_block_drag() {
+    if (!scripted_drag_) return;
+    physics_layout_.end_drag(dragged_block_id_);
+    dragging_block_ = false;
+    scripted_drag_ = false;
+    dragged_block_id_.clear();
+}
+
+void DiagramCanvas::set_edge_bundling_enabled(bool enabled) {
+    if (edge_bundling_enabled_ == enabled) return;
+    edge_bundling_enabled_ = enabled;
+    // Bundling rewrites member routes in place, so the routes have to be rebuilt either way.
+    connection_lines_dirty_ = true;
+}
+
 const diagram_model::ClassDiagram* DiagramCanvas::class_diagram() const {
     return class_diagram_;
 }
@@ -200,9 +213,7 @@ void DiagramCanvas::zoom_at(float screen_x, float screen_y, float zoom_delta) {
 }
 
 void DiagramCanvas::zoom_at_center(float zoom_delta) {
-    zoom_ *= zoom_delta;
-    if (zoom_ < 0.1f) zoom_ = 0.1f;
-    if (zoom_ > 10.0f) zoom_ = 10.0f;
+    zoom_at(last_region_width_ * 0.5f, last_region_height_ * 0.5f, zoom_delta);
 }
 
 void DiagramCanvas::screen_to_world(float screen_x, float screen_y, double& world_x, double& world_y) const {
@@ -222,56 +233,114 @@ void DiagramCanvas::set_view_center(float screen_region_width, float screen_regi
 
 void DiagramCanvas::draw_grid(ImVec2 region_min, ImVec2 region_max) {
     ImDrawList* dl = ImGui::GetWindowDrawList();
-    if (!dl) return;
-
-    const unsigned int grid_color = IM_COL32(60, 60, 65, 255);
-    const float grid_thickness = 1.0f;
+    if (!dl || grid_step_ <= 0.0f || zoom_ <= 0.0f) return;
+
+    // Finest step grid_step_ * 5^k that is still grid_min_step_px apart on screen. Every 5th
+    // line belongs to the next level and stays; the others fade out as they close in, so the
+    // switch to the next level is seamless and there are never more than a few hundred lines.
+    double step = grid_step_;
+    while (step * zoom_ < grid_min_step_px) step *= grid_major_every;
+    while (step / grid_major_every * zoom_ >= grid_min_step_px) step /= grid_major_every;
+    const float step_px = static_cast<float>(step * zoom_);
+    const float fade = std::clamp((step_px - grid_min_step_px) / (grid_min_step_px * (grid_major_every - 1)), 0.0f, 1.0f);
+    const unsigned int major_color = IM_COL32(60, 60, 65, 255);
+    const unsigned int minor_color = IM_COL32(60, 60, 65, static_cast<int>(fade * 255.0f + 0.5f));
+    const bool draw_minor = (minor_color & IM_COL32_A_MASK) != 0;
 
     double left_world, top_world, right_world, bottom_world;
     screen_to_world(region_min.x, region_min.y, left_world, top_world);
     screen_to_world(region_max.x, region_max.y, right_world, bottom_world);
+    const auto first_col = static_cast<std::int64_t>(std::ceil(left_world / step));
+    const auto last_col = static_cast<std::int64_t>(std::floor(right_world / step));
+    const auto first_row = static_cast<std::int64_t>(std::ceil(top_world / step));
+    const auto last_row = static_cast<std::int64_t>(std::floor(bottom_world / step));
+    if (last_col < first_col && last_row < first_row) return;
+
+    // One 1px quad per line, all in a single reservation; unused slots are returned at the end.
+    const int reserved = static_cast<int>(std::max<std::int64_t>(last_col - first_col + 1, 0)
+        + std::max<std::int64_t>(last_row - first_row + 1, 0));
+    dl->PrimReserve(reserved * 6, reserved * 4);
+    int emitted = 0;
+    auto is_major = [](std::int64_t i) { return i % grid_major_every == 0; };
+    for (std::int64_t i = first_col; i <= last_col; ++i) {
+        const bool major = is_major(i);
+        if (!major && !draw_minor) continue;
+        const float x = std::floor(static_cast<float>(i * step * zoom_ + offset_x_));
+        dl->PrimRect(ImVec2(x, region_min.y), ImVec2(x + 1.0f, region_max.y), major ? major_color : minor_color);
+        ++emitted;
+    }
+    for (std::int64_t i = first_row; i <= last_row; ++i) {
+        const bool major = is_major(i);
+        if (!major && !draw_minor) continue;
+        const float y = std::floor(static_cast<float>(i * step * zoom_ + offset_y_));
+        dl->PrimRect(ImVec2(region_min.x, y), ImVec2(region_max.x, y + 1.0f), major ? major_color : minor_color);
+        ++emitted;
+    }
+    dl->PrimUnreserve((reserved - emitted) * 6, (reserved - emitted) * 4);
+}
 
-    float step = grid_step_ * zoom_;
-    if (step < 8.0f) step = 8.0f;
-
-    double start_x = std::floor(left_world / grid_step_) * grid_step_;
-    double start_y = std::floor(top_world / grid_step_) * grid_step_;
+void DiagramCanvas::resize_class_block(const std::string& class_id) {
+    render_cache_.invalidate_card(class_id);
+    block_sizer_.mark_block_dirty(class_id);
+    const auto& changed = block_sizer_.update(class_expanded_, nested_expanded_);
+    auto push_size = [&](const std::string& id) {
+        const diagram_placement::Rect* r = block_sizer_.size_of(id);
+        if (!r) {
+            physics_layout_.build(*class_diagram_, class_expanded_, &block_sizer_.sizes());
+            return false;
+        }
+        auto eit = class_expanded_.find(id);
+        const bool exp = eit != class_expanded_.end() && eit->second;
+        physics_layout_.update_block_size(id, r->width, r->height, exp);
+        return true;
+    };
+    // The toggled block always gets its expanded flag pushed; other blocks only when their
+    // size changed too (after a font size change every block is re-measured).
+    if (!push_size(class_id)) return;
+    for (const auto& id : changed)
+        if (id != class_id) push_size(id);
+}
 
-    for (double wx = start_x; wx <= right_world + grid_step_; wx += grid_step_) {
-        float sx1, sy1, sx2, sy2;
-        world_to_screen(wx, top_world - 1000, sx1, sy1);
-        world_to_screen(wx, bottom_world + 1000, sx2, sy2);
-        dl->AddLine(ImVec2(sx1, sy1), ImVec2(sx2, sy2), grid_color, grid_thickness);
-    }
-    for (double wy = start_y; wy <= bottom_world + grid_step_; wy += grid_step_) {
-        float sx1, sy1, sx2, sy2;
-        world_to_screen(left_world - 1000, wy, sx1, sy1);
-        world_to_screen(right_world + 1000, wy, sx2, sy2);
-        dl->AddLine(ImVec2(sx1, sy1), ImVec2(sx2, sy2), grid_color, grid_thickness);
+const diagram_placement::PlacedClassDiagram& DiagramCanvas::displayed_blocks() {
+    if (displayed_generation_ != physics_layout_.generation()) {
+        displayed_ = physics_layout_.get_placed();
+        cull_index_.build_blocks(displayed_);
+        displayed_generation_ = physics_layout_.generation();
     }
+    return displayed_;
+}
+
+const diagram_placement::PlacedClassBlock* DiagramCanvas::pick_block_at(double wx, double wy) {
+    const auto& placed = displayed_blocks();
+    cull_index_.blocks_at(wx, wy, blocks_at_);
+    return blocks_at_.empty() ? nullptr : &placed.blocks[blocks_at_.back()];
 }
 
 bool DiagramCanvas::try_toggle_class_expanded(float screen_x, float screen_y) {
     if (!class_diagram_) return false;
-    diagram_placement::PlacedClassDiagram placed = physics_layout_.get_placed();
+    const auto& placed = displayed_blocks();
     double wx, wy;
     screen_to_world(screen_x, screen_y, wx, wy);
 
-    // Check main expand/collapse buttons on block headers.
-    for (const auto& block : placed.blocks) {
+    // Every button lies inside its block, so only blocks under the cursor are checked, and the
+    // hit regions from the last render pass only when there is one.
+    cull_index_.blocks_at(wx, wy, blocks_at_);
+    if (blocks_at_.empty()) return false;
+
+    // Check main expand/collapse buttons on block headers (only drawn at Full/Header detail).
+    for (const std::uint32_t bi : blocks_at_) {
+        const auto& block = placed.blocks[bi];
         const auto& cur = block.rect;
+        const auto lod = diagram_render::class_block_lod(cur.width, cur.height, zoom_);
+        if (lod != diagram_render::ClassBlockLod::Full && lod != diagram_render::ClassBlockLod::Header)
+            continue;
         double btn_x = cur.x + cur.width - class_padding - class_button_size;
         double btn_y = cur.y + (class_header_height - class_button_size) * 0.5;
         if (wx >= btn_x && wx <= btn_x + class_button_size && wy >= btn_y && wy <= btn_y + class_button_size) {
-            bool& exp = class_expanded_[block.class_id];
+            const std::string class_id = block.class_id;
+            bool& exp = class_expanded_[class_id];
             exp = !exp;
-            auto block_sizes = diagram_render::compute_class_block_sizes(*class_diagram_, class_expanded_, nested_expanded_);
-            auto it = block_sizes.find(block.class_id);
-            if (it != block_sizes.end()) {
-                physics_layout_.update_block_size(block.class_id, it->second.width, it->second.height, exp);
-            } else {
-                physics_layout_.build(*class_diagram_, class_expanded_, &block_sizes);
-            }
+            resize_class_block(class_id);
             return true;
         }
     }
@@ -279,20 +348,9 @@ bool DiagramCanvas::try_toggle_class_expanded(float screen_x, float screen_y) {
     // Check nested expand/collapse buttons (recorded during last render pass).
     for (const auto& hb : nested_hit_buttons_) {
         if (wx >= hb.x && wx <= hb.x + hb.w && wy >= hb.y && wy <= hb.y + hb.h) {
-            bool& exp = nested_expanded_[hb.path];
-            exp = !exp;
-            // Recompute the owning block's size.
-            auto block_sizes = diagram_render::compute_class_block_sizes(*class_diagram_, class_expanded_, nested_expanded_);
-            auto it = block_sizes.find(hb.block_class_id);
-            if (it != block_sizes.end()) {
-                bool block_exp = false;
-                auto eit = class_expanded_.find(hb.block_class_id);
-                if (eit != class_expanded_.end()) block_exp = eit->second;
-                physics_layout_.update_block_size(hb.block_class_id,
-                    it->second.width, it->second.height, block_exp);
-            } else {
-                physics_layout_.build(*class_diagram_, class_expanded_, &block_sizes);
-            }
+            nested_expanded_.toggle(hb.path);
+            // Nested paths are per block, so only the owning block is re-measured.
+            resize_class_block(class_diagram_->classes[hb.block_class_index].id);
             settle_error_reported_ = false;
             connection_lines_dirty_ = true;
             return true;
@@ -303,11 +361,12 @@ bool DiagramCanvas::try_toggle_class_expanded(float screen_x, float screen_y) {
     for (const auto& nb : nav_hit_buttons_) {
         if (wx >= nb.x && wx <= nb.x + nb.w && wy >= nb.y && wy <= nb.y + nb.h) {
             // Expand the target class card if it isn't already open.
-            auto it = class_expanded_.find(nb.target_class_id);
+            const std::string& target_id = class_diagram_->classes[nb.target_class_index].id;
+            auto it = class_expanded_.find(target_id);
             if (it == class_expanded_.end() || !it->second) {
-                set_class_block_expanded(nb.target_class_id, true);
+                set_class_block_expanded(target_id, true);
             }
-            focus_on_class(nb.target_class_id);
+            focus_on_class(target_id);
             return true;
         }
     }
@@ -316,7 +375,7 @@ bool DiagramCanvas::try_toggle_class_expanded(float screen_x, float screen_y) {
 }
 
 void DiagramCanvas::focus_on_class(const std::string& class_id) {
-    auto placed = physics_layout_.get_placed();
+    const auto& placed = displayed_blocks();
     for (const auto& block : placed.blocks) {
         if (block.class_id == class_id) {
             double cx = block.rect.x + block.rect.width * 0.5;
@@ -346,15 +405,12 @@ void DiagramCanvas::handle_input(float region_width, float region_height) {
             return;
 
         if (class_diagram_ && io.KeyAlt) {
-            std::string hit_id;
-            diagram_placement::Rect hit_rect;
-            auto placed = physics_layout_.get_placed();
-            if (pick_block_at(placed, wx, wy, hit_id, hit_rect)) {
+            if (const auto* hit = pick_block_at(wx, wy)) {
                 dragging_block_ = true;
-                dragged_block_id_ = hit_id;
-                dragged_block_offset_x_ = wx - hit_rect.x;
-                dragged_block_offset_y_ = wy - hit_rect.y;
-                physics_layout_.begin_drag(hit_id);
+                dragged_block_id_ = hit->class_id;
+                dragged_block_offset_x_ = wx - hit->rect.x;
+                dragged_block_offset_y_ = wy - hit->rect.y;
+                physics_layout_.begin_drag(dragged_block_id_);
                 dragging_ = false;
                 return;
             }
@@ -368,38 +424,38 @@ void DiagramCanvas::handle_input(float region_width, float region_height) {
     }
 
     if (ImGui::IsMouseClicked(1) && in_region && class_diagram_) {
-        std::string hit_id;
-        diagram_placement::Rect hit_rect;
-        auto placed = physics_layout_.get_placed();
-        if (pick_block_at(placed, wx, wy, hit_id, hit_rect)) {
+        if (const auto* hit = pick_block_at(wx, wy)) {
             dragging_block_ = true;
-            dragged_block_id_ = hit_id;
-            dragged_block_offset_x_ = wx - hit_rect.x;
-            dragged_block_offset_y_ = wy - hit_rect.y;
-            physics_layout_.begin_drag(hit_id);
+            dragged_block_id_ = hit->class_id;
+            dragged_block_offset_x_ = wx - hit->rect.x;
+            dragged_block_offset_y_ = wy - hit->rect.y;
+            physics_layout_.begin_drag(dragged_block_id_);
             dragging_ = false;
         }
     }
 
     if (ImGui::IsMouseReleased(0)) {
         dragging_ = false;
-        if (dragging_block_) {
+        if (dragging_block_ && !scripted_drag_) {
             physics_layout_.end_drag(dragged_block_id_);
             dragging_block_ = false;
             dragged_block_id_.clear();
         }
     }
-    if (ImGui::IsMouseReleased(1) && dragging_block_) {
+    if (ImGui::IsMouseReleased(1) && dragging_block_ && !scripted_drag_) {
         physics_layout_.end_drag(dragged_block_id_);
         dragging_block_ = false;
         dragged_block_id_.clear();
     }
 
     if (dragging_block_ && !dragged_block_id_.empty()) {
-        physics_layout_.drag_to(
-            dragged_block_id_,
-            wx - dragged_block_offset_x_,
-            wy - dragged_block_offset_y_);
+        // A scripted drag is moved by drag_block_by, not by the mouse.
+        if (!scripted_drag_) {
+            physics_layout_.drag_to(
+                dragged_block_id_,
+                wx - dragged_block_offset_x_,
+                wy - dragged_block_offset_y_);
+        }
         return;
     }
 
@@ -422,31 +478,66 @@ bool DiagramCanvas::update_and_draw(float region_width, float region_height) {
     last_region_width_ = region_width;
     last_region_height_ = region_height;
 
-    handle_input(region_width, region_height);
+    profiling::ScopedFrame profiled_frame(profiler_);
+    {
+        profiling::ScopedPhase phase(profiler_, profiling::FramePhase::Input);
+        handle_input(region_width, region_height);
+    }
 
     ImVec2 region_min = ImGui::GetCursorScreenPos();
     ImVec2 region_max = ImVec2(region_min.x + region_width, region_min.y + region_height);
 
     ImDrawList* draw_list = ImGui::GetWindowDrawList();
     if (!draw_list) return true;
+    const int vertices_before = draw_list->VtxBuffer.Size;
 
-    draw_grid(region_min, region_max);
+    {
+        profiling::ScopedPhase phase(profiler_, profiling::FramePhase::Render);
+        draw_grid(region_min, region_max);
+    }
 
     if (class_diagram_) {
-        physics_layout_.step(ImGui::GetIO().DeltaTime);
-        diagram_placement::PlacedClassDiagram displayed = physics_layout_.get_placed();
-        log_visual_overlaps(displayed);
+        {
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::PhysicsStep);
+            physics_layout_.step(ImGui::GetIO().DeltaTime);
+        }
+        profiler_.set_counter(profiling::FrameCounter::BodiesAwake, physics_layout_.awake_body_count());
+        {
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::GetPlaced);
+            displayed_blocks();
+        }
+        const diagram_placement::PlacedClassDiagram& displayed = displayed_;
+        {
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::OverlapAudit);
+            log_visual_overlaps(displayed);
+        }
 
         // Recompute connection lines when layout has changed, flagged dirty, or block is being dragged.
+        bool lines_rerouted = false;
         if (connection_lines_dirty_ || !physics_layout_.is_settled() || dragging_block_) {
-            connection_lines_ = diagram_placement::compute_connection_lines(*class_diagram_, displayed);
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::ConnectionLines);
+            lines_rerouted = true;
+            // While the whole layout is still settling every block moves each frame, so the cheap
+            // router is used; the obstacle-avoiding one takes over once only a few blocks move.
+            if (physics_layout_.is_settled() || dragging_block_) {
+                edge_router_.route(displayed, connection_lines_);
+            } else {
+                diagram_placement::route_connection_lines(displayed, connection_lines_);
+            }
+            if (edge_bundling_enabled_) {
+                diagram_placement::bundle_connection_lines(connection_lines_, connection_bundles_);
+            } else {
+                connection_bundles_.clear();
+            }
             if (physics_layout_.is_settled() && !dragging_block_) connection_lines_dirty_ = false;
+            profiler_.set_counter(profiling::FrameCounter::LinesRebuilt, static_cast<std::int64_t>(connection_lines_.size()));
         }
 
         // Detect hover: block-level (highlight parents) + row-level (highlight specific target).
-        hovered_class_id_.clear();
-        highlighted_class_ids_.clear();
         {
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::Hover);
+            hovered_class_id_.clear();
+            highlighted_class_ids_.clear();
             ImGuiIO& io = ImGui::GetIO();
             ImVec2 mouse = io.MousePos;
             ImVec2 win_min_pt = ImGui::GetWindowPos();
@@ -459,90 +550,132 @@ bool DiagramCanvas::update_and_draw(float region_width, float region_height) {
 
                 // Header hover: if mouse is over a block's header, highlight all its parents.
                 constexpr double hdr_h = diagram_placement::layout::header_height;
-                for (const auto& block : displayed.blocks) {
+                cull_index_.blocks_at(mx, my, blocks_at_);
+                for (const std::uint32_t bi : blocks_at_) {
+                    const auto& block = displayed.blocks[bi];
                     double bx = block.rect.x, by = block.rect.y;
                     double bw = block.rect.width;
+                    const auto lod = diagram_render::class_block_lod(bw, block.rect.height, zoom_);
+                    if (lod != diagram_render::ClassBlockLod::Full && lod != diagram_render::ClassBlockLod::Header)
+                        continue;
                     if (mx >= bx && mx <= bx + bw && my >= by && my <= by + hdr_h) {
                         hovered_class_id_ = block.class_id;
-                        for (const auto& cls : class_diagram_->classes) {
-                            if (cls.id == block.class_id) {
-                                for (const auto& pid : cls.parent_class_ids)
-                                    highlighted_class_ids_.insert(pid);
-                                break;
-                            }
+                        if (block.class_index < class_diagram_->classes.size()) {
+                            for (const auto& pid : class_diagram_->classes[block.class_index].parent_class_ids)
+                                highlighted_class_ids_.insert(pid);
                         }
                         break;
                     }
                 }
 
-                // Row-level hover regions: add specific targets to the highlighted set.
-                for (const auto& hr : hover_regions_) {
-                    if (mx >= hr.x && mx <= hr.x + hr.w && my >= hr.y && my <= hr.y + hr.h) {
-                        highlighted_class_ids_.insert(hr.target_class_id);
-                        break;
+                // Row-level hover regions: add specific targets to the highlighted set. They lie
+                // inside their blocks, so there is nothing to find outside every block.
+                if (!blocks_at_.empty()) {
+                    for (const auto& hr : hover_regions_) {
+                        if (mx >= hr.x && mx <= hr.x + hr.w && my >= hr.y && my <= hr.y + hr.h) {
+                            highlighted_class_ids_.insert(class_diagram_->classes[hr.target_class_index].id);
+                            break;
+                        }
                     }
                 }
             }
         }
 
+        // Blocks are indexed by displayed_blocks(); routes only when they changed.
+        if (lines_rerouted) {
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::ConnectionLines);
+            cull_index_.build_lines(&connection_lines_);
+        }
+        diagram_render::ClassDiagramViewport viewport;
+        {
+            double left, top, right, bottom;
+            screen_to_world(region_min.x, region_min.y, left, top);
+            screen_to_world(region_max.x, region_max.y, right, bottom);
+            viewport.visible = { left, top, right - left, bottom - top };
+            viewport.index = &cull_index_;
+        }
+
+        profiling::ScopedPhase phase(profiler_, profiling::FramePhase::Render);
         nested_hit_buttons_.clear();
         nav_hit_buttons_.clear();
         hover_regions_.clear();
         diagram_render::render_class_diagram(draw_list, *class_diagram_, displayed,
             offset_x_, offset_y_, zoom_, nested_expanded_, &nested_hit_buttons_, &nav_hit_buttons_,
-            &hover_regions_, hovered_class_id_, connection_lines_, highlighted_class_ids_);
+            &hover_regions_, hovered_class_id_, &connection_lines_, highlighted_class_ids_,
+            &connection_bundles_, &viewport, &render_cache_);
     } else if (diagram_) {
-        diagram_placement::PlacedDiagram placed = diagram_placement::place_diagram(*diagram_,
-            (double)region_width, (double)region_height);
-        diagram_render::render_diagram(draw_list, placed, offset_x_, offset_y_, zoom_);
+        // Layout is cached; it only iterates (within a frame budget) until it settles.
+        {
+            profiling::ScopedPhase phase(profiler_, profiling::FramePhase::GraphLayout);
+            graph_layout_.sync(*diagram_);
+            graph_layout_.step(50, 4.0);
+        }
+        profiling::ScopedPhase phase(profiler_, profiling::FramePhase::Render);
+        diagram_render::render_diagram(draw_list, graph_layout_.placed(), offset_x_, offset_y_, zoom_);
     }
 
+    profiler_.set_counter(profiling::FrameCounter::DrawVertices, draw_list->VtxBuffer.Size - vertices_before);
     return true;
 }
 
 void DiagramCanvas::log_visual_overlaps(const diagram_placement::PlacedClassDiagram& displayed) {
-    auto logger = overlap_logger();
-    std::unordered_set<std::string> current_pairs;
+    // Pairs only change with the placement; the settle check below still runs every frame.
+    if (overlap_generation_ == physics_layout_.generation()) {
+        report_unsettled_overlaps();
+        return;
+    }
+    overlap_generation_ = physics_layout_.generation();
 
+    overlap_scratch_.clear();
     for (std::size_t i = 0; i < displayed.blocks.size(); ++i) {
         const auto& a = displayed.blocks[i];
-        const Obb obb_a = to_obb(a.rect);
-        for (std::size_t j = i + 1; j < displayed.blocks.size(); ++j) {
-            const auto& b = displayed.blocks[j];
-            const Obb obb_b = to_obb(b.rect);
-            if (!obb_intersects(obb_a, obb_b)) {
-                continue;
-            }
-
-            const std::string key = pair_key(a.class_id, b.class_id);
-            current_pairs.insert(key);
-            if (active_overlap_pairs_.find(key) == active_overlap_pairs_.end()) {
-                logger->warn(
-                    "overlap_detected pair={} a={} b={} "
-                    "a_rect=({}, {}, {}, {}) b_rect=({}, {}, {}, {})",
-                    key, a.class_id, b.class_id,
-                    a.rect.x, a.rect.y, a.rect.width, a.rect.height,
-                    b.rect.x, b.rect.y, b.rect.width, b.rect.height);
-            }
+        // Blocks are axis-aligned; touching edges count as overlap.
+        cull_index_.visible_blocks(a.rect, blocks_at_);
+        for (const std::uint32_t j : blocks_at_) {
+            if (j <= i) continue;
+            overlap_scratch_.push_back(overlap_pair_key(a.class_index, displayed.blocks[j].class_index));
         }
     }
-
-    for (const auto& key : active_overlap_pairs_) {
-        if (current_pairs.find(key) == current_pairs.end()) {
-            logger->info("overlap_resolved pair={}", key);
+    std::sort(overlap_scratch_.begin(), overlap_scratch_.end());
+
+    // Both lists are sorted: one merge finds the new and the resolved pairs.
+    auto cur = overlap_scratch_.begin();
+    auto prev = active_overlap_pairs_.begin();
+    while (cur != overlap_scratch_.end() || prev != active_overlap_pairs_.end()) {
+        if (prev == active_overlap_pairs_.end() || (cur != overlap_scratch_.end() && *cur < *prev)) {
+            const auto* a = find_displayed_block(displayed, overlap_pair_first(*cur));
+            const auto* b = find_displayed_block(displayed, overlap_pair_second(*cur));
+            if (a && b) {
+                overlap_logger()->warn(
+                    "overlap_detected pair={}|{} a_rect=({}, {}, {}, {}) b_rect=({}, {}, {}, {})",
+                    a->class_id, b->class_id,
+                    a->rect.x, a->rect.y, a->rect.width, a->rect.height,
+                    b->rect.x, b->rect.y, b->rect.width, b->rect.height);
+            }
+            ++cur;
+        } else if (cur == overlap_scratch_.end() || *prev < *cur) {
+            overlap_logger()->info("overlap_resolved pair={}", overlap_pair_name(*prev));
+            ++prev;
+        } else {
+            ++cur;
+            ++prev;
         }
     }
 
-    active_overlap_pairs_ = std::move(current_pairs);
+    active_overlap_pairs_.swap(overlap_scratch_);
+    report_unsettled_overlaps();
+}
 
+void DiagramCanvas::report_unsettled_overlaps() {
     if (physics_layout_.is_settled()) {
         if (!active_overlap_pairs_.empty() && !settle_error_reported_) {
+            auto logger = overlap_logger();
             logger->error(
                 "settle_failed overlap_count={} pairs_unresolved={}",
                 active_overlap_pairs_.size(),
                 active_overlap_pairs_.size());
-            for (const auto& pair : active_overlap_pairs_) {
-                logger->error("settle_failed_pair pair={}", pair);
+            for (const std::uint64_t pair : active_overlap_pairs_) {
+                logger->error("settle_failed_pair pair={}", overlap_pair_name(pair));
             }
             settle_error_reported_ = true;
         } else if (active_overlap_pairs_.empty()) {
@@ -553,4 +686,9 @@ void DiagramCanvas::log_visual_overlaps(const diagram_placement::PlacedClassDiag
     }
 }
 
+std::string DiagramCanvas::overlap_pair_name(std::uint64_t key) const {
+    const auto& classes = class_diagram_->classes;
+    return classes[overlap_pair_first(key)].id + "|" + classes[overlap_pair_second(key)].id;
+}
+
 } // namespace canvas
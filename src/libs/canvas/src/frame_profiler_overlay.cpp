@@ -0,0 +1,102 @@
+#include <canvas/frame_profiler_overlay.hpp>
+#include <profiling/allocation_counters.hpp>
+#include "imgui.h"
+#include <string>
+
+namespace canvas {
+
+namespace {
+
+constexpr double overlay_percentiles[] = { 0.5, 0.95, 0.99, 1.0 };
+
+void table_header(const char* first) {
+    ImGui::TableSetupColumn(first);
+    ImGui::TableSetupColumn("last");
+    ImGui::TableSetupColumn("p50");
+    ImGui::TableSetupColumn("p95");
+    ImGui::TableSetupColumn("p99");
+    ImGui::TableSetupColumn("max");
+    ImGui::TableHeadersRow();
+}
+
+template <typename Percentile>
+void table_row(const char* name, double last, const char* format, Percentile percentile) {
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+    ImGui::TextUnformatted(name);
+    ImGui::TableNextColumn();
+    ImGui::Text(format, last);
+    for (const double p : overlay_percentiles) {
+        ImGui::TableNextColumn();
+        ImGui::Text(format, percentile(p));
+    }
+}
+
+} // namespace
+
+void draw_frame_profiler_overlay(const profiling::FrameProfiler& profiler, const char* csv_path, bool* open) {
+    if (open && !*open) return;
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Frame profiler", open,
+            ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing)) {
+        ImGui::End();
+        return;
+    }
+
+    const profiling::FrameSample* last = profiler.last();
+    ImGui::Text("%zu frames", profiler.size());
+    if (!last) {
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::BeginTable("phases", 6)) {
+        table_header("ms");
+        for (std::size_t i = 0; i < profiling::frame_phase_count; ++i) {
+            const auto phase = static_cast<profiling::FramePhase>(i);
+            table_row(profiling::frame_phase_name(phase), last->phase_ms[i], "%.3f",
+                [&](double p) { return profiler.phase_percentile(phase, p); });
+        }
+        table_row("frame", last->total_ms, "%.3f", [&](double p) { return profiler.total_percentile(p); });
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+    if (ImGui::BeginTable("counters", 6)) {
+        table_header("count");
+        // Allocations are only counted when the executable replaces operator new.
+        const std::size_t counters = profiling::allocation_counting_active()
+            ? profiling::frame_counter_count
+            : static_cast<std::size_t>(profiling::FrameCounter::Allocations);
+        for (std::size_t i = 0; i < counters; ++i) {
+            const auto counter = static_cast<profiling::FrameCounter>(i);
+            table_row(profiling::frame_counter_name(counter), static_cast<double>(last->counters[i]), "%.0f",
+                [&](double p) { return profiler.counter_percentile(counter, p); });
+        }
+        ImGui::EndTable();
+    }
+
+    if (profiling::allocation_counting_active()) {
+        ImGui::Separator();
+        if (ImGui::BeginTable("phase_allocations", 6)) {
+            table_header("allocs");
+            for (std::size_t i = 0; i < profiling::frame_phase_count; ++i) {
+                const auto phase = static_cast<profiling::FramePhase>(i);
+                table_row(profiling::frame_phase_name(phase), static_cast<double>(last->phase_allocations[i]), "%.0f",
+                    [&](double p) { return profiler.phase_allocation_percentile(phase, p); });
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    static std::string csv_status;
+    if (csv_path && ImGui::Button("Save CSV"))
+        csv_status = profiler.write_csv(csv_path) ? std::string("saved ") + csv_path : std::string("cannot write ") + csv_path;
+    if (!csv_status.empty()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(csv_status.c_str());
+    }
+    ImGui::End();
+}
+
+} // namespace canvas
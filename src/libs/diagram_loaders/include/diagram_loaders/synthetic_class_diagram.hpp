@@ -0,0 +1,14 @@
+#pragma once
+
+#include <diagram_model/class_diagram.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace diagram_loaders {
+
+// Deterministic random class diagram for benchmarks and stress tests: an inheritance forest
+// with some secondary parents and composition links, and a few properties/components per
+// class. Positions are left at zero so placement engines lay out every class.
+diagram_model::ClassDiagram generate_synthetic_class_diagram(std::size_t class_count, std::uint32_t seed = 1);
+
+} // namespace diagram_loaders
@@ -1,5 +1,6 @@
 #include <diagram_loaders/json_loader.hpp>
 #include <nlohmann/json.hpp>
+#include <profiling/trace.hpp>
 #include <fstream>
 
 namespace diagram_loaders {
@@ -78,6 +79,7 @@ std::optional<diagram_model::ClassDiagram> parse_class_diagram_json(const nlohma
 } // namespace
 
 std::optional<diagram_model::ClassDiagram> load_class_diagram_from_json(std::istream& in) {
+    profiling::TraceScope trace("load_class_diagram_json", "load");
     try {
         nlohmann::json j = nlohmann::json::parse(in);
         return parse_class_diagram_json(j);
@@ -1,5 +1,6 @@
 #include <diagram_loaders/json_loader.hpp>
 #include <nlohmann/json.hpp>
+#include <profiling/trace.hpp>
 #include <fstream>
 
 namespace diagram_loaders {
@@ -51,6 +52,7 @@ std::optional<diagram_model::Diagram> parse_json(const nlohmann::json& j) {
 } // namespace
 
 std::optional<diagram_model::Diagram> load_diagram_from_json(std::istream& in) {
+    profiling::TraceScope trace("load_diagram_json", "load");
     try {
         nlohmann::json j = nlohmann::json::parse(in);
         return parse_json(j);
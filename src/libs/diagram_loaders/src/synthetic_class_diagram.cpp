@@ -0,0 +1,63 @@
+#include <diagram_loaders/synthetic_class_diagram.hpp>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+
+namespace diagram_loaders {
+
+namespace {
+
+const char* const kTypes[] = { "int", "float", "bool", "string", "Vector2", "Color" };
+
+} // namespace
+
+diagram_model::ClassDiagram generate_synthetic_class_diagram(std::size_t class_count, std::uint32_t seed) {
+    diagram_model::ClassDiagram out;
+    out.name = "Synthetic (" + std::to_string(class_count) + " classes)";
+    out.classes.reserve(class_count);
+
+    std::mt19937 rng(seed);
+    auto chance = [&](unsigned percent) { return rng() % 100u < percent; };
+    auto below = [&](std::size_t n) { return static_cast<std::size_t>(rng() % n); };
+    auto class_id = [](std::size_t i) { return "Class" + std::to_string(i); };
+
+    for (std::size_t i = 0; i < class_count; ++i) {
+        diagram_model::DiagramClass cl;
+        cl.id = class_id(i);
+        cl.type_name = cl.id;
+
+        // Roots are rare; parents skew towards recent classes so trees get both depth and fan-out.
+        if (i > 0 && !chance(5)) {
+            const std::size_t window = std::min<std::size_t>(i, 64);
+            cl.parent_class_ids.push_back(class_id(i - 1 - below(window)));
+            if (i > 2 && chance(10))
+                cl.parent_class_ids.push_back(class_id(below(i)));
+        }
+
+        const std::size_t property_count = below(6);
+        for (std::size_t p = 0; p < property_count; ++p) {
+            const char* type = kTypes[below(std::size(kTypes))];
+            cl.properties.push_back({ "field" + std::to_string(p), type, chance(50) ? "0" : "" });
+        }
+        const std::size_t component_count = below(3);
+        for (std::size_t c = 0; c < component_count; ++c) {
+            diagram_model::Component comp;
+            comp.name = "component" + std::to_string(c);
+            comp.type = "Component" + std::to_string(below(16));
+            const std::size_t sub = below(3);
+            for (std::size_t p = 0; p < sub; ++p)
+                comp.properties.push_back({ "value" + std::to_string(p), kTypes[below(std::size(kTypes))], "" });
+            cl.components.push_back(std::move(comp));
+        }
+        if (class_count > 1 && chance(20)) {
+            const std::size_t target = below(class_count);
+            if (target != i)
+                cl.child_objects.push_back({ class_id(target), "part" + std::to_string(target) });
+        }
+        out.classes.push_back(std::move(cl));
+    }
+    return out;
+}
+
+} // namespace diagram_loaders
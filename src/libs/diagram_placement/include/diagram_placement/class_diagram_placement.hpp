@@ -2,6 +2,7 @@
 
 #include <diagram_model/class_diagram.hpp>
 #include <diagram_placement/types.hpp>
+#include <cstddef>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -10,6 +11,7 @@ namespace diagram_placement {
 
 struct PlacedClassBlock {
     std::string class_id;
+    std::size_t class_index = 0; // index into ClassDiagram::classes
     Rect rect;
     double margin = 8.0;
     bool expanded = false;
@@ -2,30 +2,63 @@
 
 #include <diagram_model/class_diagram.hpp>
 #include <diagram_placement/class_diagram_placement.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <utility>
 #include <vector>
 
 namespace diagram_placement {
 
-enum class ConnectionKind {
+enum class ConnectionKind : std::uint8_t {
     PrimaryInheritance,     // first parent — always visible
     SecondaryInheritance,   // parents [1..N] — visible on hover only
     Composition             // child_objects — always visible
 };
 
-struct ConnectionLine {
-    std::string from_class_id;  // child / owner
-    std::string to_class_id;    // parent / target
-    ConnectionKind kind;
-    std::string label;          // for Composition: field name (e.g. "inventory")
-    std::vector<std::pair<double, double>> points; // route in world coords
+// All connection lines of a class diagram in one structure-of-arrays buffer.
+// Endpoints are indices into ClassDiagram::classes; routes share one float point
+// array (x0, y0, x1, y1, ...) addressed per line by point_offset/point_count.
+// Buffers keep their capacity across rebuilds, so a steady-state rebuild allocates nothing.
+struct ConnectionGeometry {
+    static constexpr std::uint32_t npos = 0xFFFFFFFFu;
+
+    // Topology (depends on the diagram only).
+    std::vector<ConnectionKind> kind;
+    std::vector<std::uint32_t> from_class;   // child / owner
+    std::vector<std::uint32_t> to_class;     // parent / target
+    std::vector<std::uint32_t> slot;         // parent ordinal (inheritance) or child_objects index (composition)
+
+    // Geometry (depends on the placement).
+    std::vector<std::uint32_t> point_offset; // first route point, counted in points (not floats)
+    std::vector<std::uint32_t> point_count;  // 0 when an endpoint block is not placed
+    std::vector<float> points;               // route in world coords
+
+    // Scratch: class index -> index into PlacedClassDiagram::blocks for the last routing pass.
+    std::vector<std::uint32_t> class_block;
+
+    std::size_t size() const { return kind.size(); }
+    const float* route(std::size_t line) const { return points.data() + 2u * point_offset[line]; }
+    std::size_t memory_bytes() const;
+    void clear();
 };
 
-// Compute all connection lines for the placed diagram.
-// Lines include routing points (currently simple 2-point segments).
-std::vector<ConnectionLine> compute_connection_lines(
-    const diagram_model::ClassDiagram& diagram,
-    const PlacedClassDiagram& placed);
+// Resolve parent/child ids into class indices. Call when the diagram itself changes.
+void build_connection_topology(const diagram_model::ClassDiagram& diagram, ConnectionGeometry& out);
+
+// Fill out.class_block (class index -> index into placed.blocks, npos if not placed).
+void map_class_blocks(const PlacedClassDiagram& placed, ConnectionGeometry& out);
+
+// Recompute routes for the current placement (topology must be built for the same diagram).
+// Routes are simple orthogonal polylines with 2–4 points.
+void route_connection_lines(const PlacedClassDiagram& placed, ConnectionGeometry& out);
+
+// Convenience: topology + routes in one call.
+void compute_connection_lines(const diagram_model::ClassDiagram& diagram,
+    const PlacedClassDiagram& placed,
+    ConnectionGeometry& out);
+
+// Field name of a composition line (empty for inheritance lines).
+const std::string& connection_label(const diagram_model::ClassDiagram& diagram,
+    const ConnectionGeometry& geometry, std::size_t line);
 
 } // namespace diagram_placement
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <diagram_placement/connection_lines.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace diagram_placement {
+
+struct EdgeBundlingOptions {
+    std::size_t min_fan_in = 8;     // lines sharing an anchor before they are bundled
+    double trunk_fraction = 0.5;    // trunk length as a fraction of the nearest member's distance
+    double min_trunk = 20.0;        // shortest trunk, world units
+};
+
+// Shared trunks for lines that end in the same anchor (inheritance and composition hubs).
+// Each bundle is drawn as a trunk (bus point -> anchor, carries the marker) plus a bus segment
+// perpendicular to it; member lines are cut where they first reach the bus.
+struct ConnectionBundles {
+    // Per bundle.
+    std::vector<ConnectionKind> kind;
+    std::vector<std::uint32_t> to_class;
+    std::vector<float> trunk;   // x0, y0, x1, y1 per bundle: bus point, then the shared anchor
+    std::vector<float> bus;     // x0, y0, x1, y1 per bundle
+
+    // Per connection line: bundle index, or ConnectionGeometry::npos when drawn on its own.
+    std::vector<std::uint32_t> line_bundle;
+
+    // Scratch for grouping: (hub key, line index).
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> order;
+
+    std::size_t size() const { return kind.size(); }
+    bool is_bundled(std::size_t line) const {
+        return line < line_bundle.size() && line_bundle[line] != ConnectionGeometry::npos;
+    }
+    std::size_t memory_bytes() const;
+    void clear();
+};
+
+// Bundle routed lines in place. Call after every routing pass: member routes in `geometry`
+// are truncated at the bus, everything else is left untouched.
+// Secondary inheritance lines (hover-only) are never bundled.
+void bundle_connection_lines(ConnectionGeometry& geometry, ConnectionBundles& out,
+    const EdgeBundlingOptions& options = {});
+
+} // namespace diagram_placement
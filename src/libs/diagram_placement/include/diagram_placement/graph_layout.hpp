@@ -0,0 +1,96 @@
+#pragma once
+
+#include <diagram_model/types.hpp>
+#include <diagram_placement/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace diagram_placement {
+
+struct GraphLayoutOptions {
+    double ideal_edge_length = 140.0;  // spring rest length between connected node centres
+    double theta = 0.9;                // Barnes-Hut opening angle (larger = faster, coarser)
+    double initial_temperature = 0.0;  // step length at start; 0 = derive from graph size
+    double cooling = 0.9;              // step factor when the energy stops decreasing
+    double settle_temperature = 0.5;   // layout counts as settled below this step length
+    bool parallel = true;              // compute forces on WorkerPool::shared()
+};
+
+// Cached force-directed layout for diagram_model::Diagram.
+//
+// Spring-electrical forces with adaptive step length (Hu 2005); repulsion is approximated with
+// a Barnes-Hut quadtree so one iteration is O(n log n). Nodes with an explicit (non-zero) position in the model are pinned.
+// sync() keeps positions of nodes seen before (matched by id) and seeds new nodes next to their
+// placed neighbours, so editing a diagram only perturbs the layout locally.
+class GraphLayout {
+public:
+    void set_options(const GraphLayoutOptions& options) { options_ = options; }
+    const GraphLayoutOptions& options() const { return options_; }
+
+    // Re-read the diagram's structure. Cheap to call when nothing changed (counts are compared
+    // first); call with force = true after editing nodes or edges in place.
+    void sync(const diagram_model::Diagram& diagram, bool force = false);
+
+    // Run up to max_iterations force iterations, stopping early when settled or when
+    // time_budget_ms (if > 0) is used up; with a budget a single iteration of a large graph is
+    // spread over several calls. Returns true if positions changed.
+    bool step(int max_iterations = 1, double time_budget_ms = 0.0);
+    void run_to_convergence(int max_iterations = 1000);
+    bool is_settled() const { return temperature_ <= options_.settle_temperature; }
+
+    // Placement for rendering; rebuilt lazily and only when positions changed.
+    const PlacedDiagram& placed();
+
+    // Bumped every time positions change.
+    std::uint64_t generation() const { return generation_; }
+
+    void clear();
+
+private:
+    struct QuadNode {
+        double mx = 0, my = 0;       // centre of mass
+        double mass = 0;
+        double open2 = 0;            // (cell size / theta)^2: approximate when farther than this
+        std::int32_t child = -1;     // first of four consecutive children, -1 for a leaf
+        std::int32_t body = -1;      // leaf body, -1 when empty or aggregated
+    };
+
+    void seed_positions(const std::unordered_map<std::string, std::pair<double, double>>& previous,
+        std::size_t& seeded);
+    void build_quadtree();
+    void repulsion_for(std::size_t i, double k2, double& fx, double& fy) const;
+    void repulse_range(std::size_t begin, std::size_t end);
+    void finish_iteration();
+    void write_placed();
+
+    GraphLayoutOptions options_;
+    const diagram_model::Diagram* diagram_ = nullptr;
+    std::size_t synced_nodes_ = 0;
+    std::size_t synced_edges_ = 0;
+
+    // Per node (index into diagram.nodes).
+    std::vector<double> x_, y_;       // centres
+    std::vector<double> w_, h_;
+    std::vector<double> dx_, dy_;     // displacement scratch
+    std::vector<std::uint8_t> pinned_;
+    std::unordered_map<std::string, std::uint32_t> index_of_;
+
+    // Edges as node index pairs (edges with unknown endpoints are dropped).
+    std::vector<std::uint32_t> edge_from_, edge_to_;
+    std::vector<std::uint32_t> edge_slot_;  // index into diagram.edges
+
+    std::vector<QuadNode> quad_;
+    double temperature_ = 0.0;  // current step length
+    double energy_ = 0.0;       // sum of squared forces of the previous iteration
+    int progress_ = 0;
+    std::size_t cursor_ = 0;    // next node of a partially computed repulsion pass
+    std::uint64_t generation_ = 0;
+    std::uint64_t placed_generation_ = ~std::uint64_t{ 0 };
+    bool placed_structure_valid_ = false;
+    PlacedDiagram placed_;
+};
+
+} // namespace diagram_placement
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <diagram_placement/class_diagram_placement.hpp>
+#include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/types.hpp>
+#include <cstddef>
+
+namespace diagram_placement {
+
+// Quality measures of a finished layout, used by the layout benchmark.
+struct LayoutMetrics {
+    std::size_t block_count = 0;
+    std::size_t edge_count = 0;
+    std::size_t residual_overlaps = 0;  // block pairs whose rects overlap (touching edges do not count)
+    std::size_t edge_crossings = 0;     // proper segment crossings (shared endpoints and corners excluded)
+    double total_edge_length = 0.0;
+    double bbox_width = 0.0;
+    double bbox_height = 0.0;
+    double aspect_ratio = 0.0;          // bbox width / height, 0 for an empty layout
+};
+
+// Class diagram with routed connection lines (geometry routes must match `placed`).
+LayoutMetrics compute_layout_metrics(const PlacedClassDiagram& placed, const ConnectionGeometry& geometry);
+// Generic node/edge diagram.
+LayoutMetrics compute_layout_metrics(const PlacedDiagram& placed);
+
+} // namespace diagram_placement
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <diagram_placement/class_diagram_placement.hpp>
+#include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/spatial_grid.hpp>
+#include <diagram_placement/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace diagram_placement {
+
+struct OrthogonalRouterOptions {
+    double obstacle_margin = 10.0;   // clearance kept around every block
+    double bend_penalty = 60.0;      // cost of one bend, in world units of path length
+    double corridor_margin = 160.0;  // search area around the endpoints' bounding box
+    double channel_spacing = 6.0;    // distance between parallel segments sharing a channel
+    std::size_t max_obstacles = 96;  // corridors with more blocks fall back to the simple route
+    bool parallel = true;            // route dirty lines on WorkerPool::shared()
+};
+
+// Obstacle-avoiding orthogonal edge router.
+//
+// Per line: the blocks inside the line's corridor (found through a SpatialGrid) are inflated
+// by obstacle_margin; their edges plus the two port coordinates span a sparse orthogonal
+// visibility graph, and A* over (node, heading) states finds the path with minimal
+// length + bend_penalty * bends. Parallel segments that share a channel are then spread
+// apart by channel_spacing.
+//
+// Incremental: routes are cached per line. On the next call only lines whose endpoint blocks
+// moved, or whose corridor overlaps the old or new rect of a moved block, are rerouted.
+class OrthogonalRouter {
+public:
+    void set_options(const OrthogonalRouterOptions& options);
+    const OrthogonalRouterOptions& options() const { return options_; }
+
+    // Forget cached routes (call when the diagram or its topology changes).
+    void reset();
+
+    // Route every line of `geometry` (topology already built) against `placed`
+    // and write the routes into geometry's point buffer.
+    void route(const PlacedClassDiagram& placed, ConnectionGeometry& geometry);
+
+    // Lines rerouted by the last route() call.
+    std::size_t last_rerouted_count() const { return last_rerouted_; }
+
+private:
+    struct CachedRoute {
+        std::vector<float> points; // raw route before channel separation
+        Rect corridor;             // area whose changes can affect this route
+    };
+    // Interior segment of a route, for channel separation.
+    struct ChannelSegment {
+        bool horizontal;
+        float coord;   // y for horizontal, x for vertical segments
+        float lo, hi;  // extent along the segment
+        std::uint32_t first_point; // index of the segment's first point in geometry.points (in points)
+        int track;
+    };
+
+    void route_line(const PlacedClassDiagram& placed, const ConnectionGeometry& geometry,
+        std::size_t line);
+    void separate_channels(ConnectionGeometry& geometry);
+
+    OrthogonalRouterOptions options_;
+    std::vector<CachedRoute> routes_;
+    std::vector<std::uint32_t> routed_from_;  // endpoints the cache was built for
+    std::vector<std::uint32_t> routed_to_;
+    std::vector<Rect> previous_rects_;        // by class index
+    std::vector<std::uint8_t> previous_valid_;
+    std::vector<Rect> moved_;                 // old and new rects of blocks that moved
+    std::vector<std::uint8_t> moved_class_;
+    std::vector<std::uint32_t> dirty_;
+    std::vector<Rect> obstacle_rects_;
+    SpatialGrid obstacles_;
+    SpatialGrid moved_index_;
+    std::vector<ChannelSegment> segments_;  // separate_channels scratch
+    std::vector<float> track_end_;
+    std::size_t last_rerouted_ = 0;
+};
+
+} // namespace diagram_placement
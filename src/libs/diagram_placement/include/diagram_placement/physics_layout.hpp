@@ -5,6 +5,7 @@
 #include <diagram_placement/types.hpp>
 #include <box2d/box2d.h>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +31,10 @@ public:
     void end_drag(const std::string& id);
 
     bool is_settled() const;
+    int awake_body_count() const;
+
+    // Bumped whenever block positions or sizes may have changed (build, resize, simulation step).
+    std::uint64_t generation() const { return generation_; }
 
 private:
     struct BodyState {
@@ -65,6 +70,7 @@ private:
     b2WorldId world_id_ = b2_nullWorldId;
     std::string dragged_id_;
     int settle_steps_remaining_ = 0;
+    std::uint64_t generation_ = 0;
 
     static constexpr float kAnimSpeed = 4.0f;
 };
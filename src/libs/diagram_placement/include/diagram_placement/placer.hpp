@@ -5,6 +5,7 @@
 
 namespace diagram_placement {
 
+// Nodes with a zero position are laid out with GraphLayout (force-directed); others stay put.
 PlacedDiagram place_diagram(const diagram_model::Diagram& diagram,
     double view_width = 0, double view_height = 0);
 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace diagram_placement {
+
+enum class RectBatchIsa { Scalar, Sse2, Avx2 };
+
+// Kernel used by RectBatch; the best one supported by the CPU is picked on first use.
+RectBatchIsa rect_batch_isa();
+const char* rect_batch_isa_name(RectBatchIsa isa);
+// Force a kernel (benchmarks). Returns false, leaving the current one, if the CPU or build lacks it.
+bool set_rect_batch_isa(RectBatchIsa isa);
+
+// Axis-aligned rectangles stored as edge arrays (structure of arrays), padded to a multiple
+// of 8 with rects that never overlap anything, so one query is tested against 8 rects per
+// kernel call (two AVX registers, four SSE2 registers, or a scalar loop).
+//
+// Overlap test for a query q and stored rect j, the same expression the placer always used:
+//   q.right + gap > j.left && j.right + gap > q.left && q.bottom + gap > j.top && j.bottom + gap > q.top
+// With inclusive = true the comparisons are >= (closed rects: touching edges count).
+class RectBatch {
+public:
+    static constexpr std::size_t lanes = 8;
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    void clear();
+    void reserve(std::size_t count);
+    std::size_t size() const { return size_; }
+
+    void push_back(double left, double top, double right, double bottom);
+    void set(std::size_t i, double left, double top, double right, double bottom);
+
+    double left(std::size_t i) const { return left_[i]; }
+    double top(std::size_t i) const { return top_[i]; }
+    double right(std::size_t i) const { return right_[i]; }
+    double bottom(std::size_t i) const { return bottom_[i]; }
+
+    // Bit k set if rect first + k overlaps the query; `first` must be a multiple of 8.
+    std::uint32_t overlap_mask8(std::size_t first, double left, double top, double right, double bottom,
+        double gap = 0.0, bool inclusive = false) const;
+
+    // Calls fn(j) for every j in [begin, size()) overlapping the query, in increasing order.
+    template <class Fn>
+    void for_each_overlap(double left, double top, double right, double bottom, std::size_t begin,
+        double gap, bool inclusive, Fn&& fn) const
+    {
+        for (std::size_t base = begin & ~(lanes - 1); base < size_; base += lanes) {
+            std::uint32_t mask = overlap_mask8(base, left, top, right, bottom, gap, inclusive);
+            if (base < begin) mask &= ~0u << (begin - base);
+            while (mask) {
+                fn(base + static_cast<std::size_t>(std::countr_zero(mask)));
+                mask &= mask - 1;
+            }
+        }
+    }
+
+    // First j in [begin, size()) overlapping the query, or npos.
+    std::size_t find_first_overlap(double left, double top, double right, double bottom, std::size_t begin,
+        double gap = 0.0, bool inclusive = false) const;
+
+private:
+    std::vector<double> left_;
+    std::vector<double> top_;
+    std::vector<double> right_;
+    std::vector<double> bottom_;
+    std::size_t size_ = 0;
+};
+
+} // namespace diagram_placement
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <diagram_placement/types.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace diagram_placement {
+
+// Uniform grid over axis-aligned rectangles (broad phase for area and point queries).
+// Items are stored per cell in one flat CSR array; queries are read-only and thread-safe.
+class SpatialGrid {
+public:
+    // Index `rects` (item id = position in the vector). cell_size <= 0 picks a size from
+    // the average rect extent, capped so the grid has at most ~4 cells per item.
+    void build(const std::vector<Rect>& rects, double cell_size = 0.0);
+    void clear();
+
+    std::size_t size() const { return rects_.size(); }
+    bool empty() const { return rects_.empty(); }
+    const Rect& rect(std::uint32_t item) const { return rects_[item]; }
+    double cell_size() const { return cell_; }
+
+    // Calls fn(item) once for every item whose rect intersects `area` (edges inclusive).
+    template <typename Fn>
+    void query(const Rect& area, Fn&& fn) const;
+
+    // Calls fn(item) for every item whose rect contains (x, y).
+    template <typename Fn>
+    void query_point(double x, double y, Fn&& fn) const;
+
+private:
+    int col_of(double x) const;
+    int row_of(double y) const;
+
+    std::vector<Rect> rects_;
+    std::vector<std::uint32_t> cell_start_; // cols_ * rows_ + 1 offsets into items_
+    std::vector<std::uint32_t> items_;
+    double origin_x_ = 0.0;
+    double origin_y_ = 0.0;
+    double cell_ = 1.0;
+    int cols_ = 0;
+    int rows_ = 0;
+};
+
+inline bool rects_intersect(const Rect& a, const Rect& b) {
+    return a.x <= b.x + b.width && b.x <= a.x + a.width
+        && a.y <= b.y + b.height && b.y <= a.y + a.height;
+}
+
+inline int SpatialGrid::col_of(double x) const {
+    const int c = static_cast<int>(std::floor((x - origin_x_) / cell_));
+    return std::clamp(c, 0, cols_ - 1);
+}
+
+inline int SpatialGrid::row_of(double y) const {
+    const int r = static_cast<int>(std::floor((y - origin_y_) / cell_));
+    return std::clamp(r, 0, rows_ - 1);
+}
+
+template <typename Fn>
+void SpatialGrid::query(const Rect& area, Fn&& fn) const {
+    if (rects_.empty()) return;
+    const int c0 = col_of(area.x);
+    const int c1 = col_of(area.x + area.width);
+    const int r0 = row_of(area.y);
+    const int r1 = row_of(area.y + area.height);
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const std::size_t cell = static_cast<std::size_t>(r) * cols_ + c;
+            for (std::uint32_t k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+                const std::uint32_t item = items_[k];
+                const Rect& ir = rects_[item];
+                if (!rects_intersect(ir, area)) continue;
+                // Report each item only from the cell holding the top-left corner of the
+                // overlap, so multi-cell items are not visited twice (no per-query state).
+                if (col_of(std::max(ir.x, area.x)) != c || row_of(std::max(ir.y, area.y)) != r)
+                    continue;
+                fn(item);
+            }
+        }
+    }
+}
+
+template <typename Fn>
+void SpatialGrid::query_point(double x, double y, Fn&& fn) const {
+    if (rects_.empty()) return;
+    const std::size_t cell = static_cast<std::size_t>(row_of(y)) * cols_ + col_of(x);
+    for (std::uint32_t k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+        const std::uint32_t item = items_[k];
+        const Rect& ir = rects_[item];
+        if (x >= ir.x && x <= ir.x + ir.width && y >= ir.y && y <= ir.y + ir.height)
+            fn(item);
+    }
+}
+
+} // namespace diagram_placement
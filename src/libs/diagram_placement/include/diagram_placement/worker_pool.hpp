@@ -0,0 +1,62 @@
+#pragma once
+
+#include <profiling/allocation_counters.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace diagram_placement {
+
+// Small persistent thread pool for data-parallel loops (edge routing, draw-list building).
+// The calling thread takes part in the work; parallel_for blocks until all chunks are done.
+// Calls from several threads take turns, and a call made from inside a chunk (on a worker or
+// on the caller) runs serially on that thread, so `worker` ids never collide.
+class WorkerPool {
+public:
+    // thread_count = 0: hardware_concurrency - 1 background workers.
+    explicit WorkerPool(unsigned thread_count = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Number of threads that execute chunks, including the caller.
+    unsigned concurrency() const { return static_cast<unsigned>(threads_.size()) + 1u; }
+
+    // Runs fn(begin, end, worker) over [0, count) in chunks of at least min_chunk items.
+    // `worker` is in [0, concurrency()) and identifies the executing thread (for per-thread scratch);
+    // a nested call passes the id of the chunk it was made from.
+    void parallel_for(std::size_t count, std::size_t min_chunk,
+        const std::function<void(std::size_t, std::size_t, unsigned)>& fn);
+
+    // Process-wide pool shared by the diagram libraries.
+    static WorkerPool& shared();
+
+private:
+    struct Job {
+        const std::function<void(std::size_t, std::size_t, unsigned)>* fn = nullptr;
+        std::size_t count = 0;
+        std::size_t chunk = 1;
+        profiling::FramePhase phase = profiling::FramePhase::Count;  // caller's allocation phase
+    };
+
+    void worker_main(unsigned worker);
+    void run_chunks(const Job& job, unsigned worker);
+
+    std::vector<std::thread> threads_;
+    std::mutex call_mutex_;  // one parallel_for at a time
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job job_;
+    std::atomic<std::size_t> next_{0};
+    std::size_t generation_ = 0;
+    unsigned busy_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace diagram_placement
@@ -1,5 +1,6 @@
 #include <diagram_placement/class_diagram_placement.hpp>
 #include <diagram_placement/class_diagram_layout_constants.hpp>
+#include <diagram_placement/rect_batch.hpp>
 #include <algorithm>
 #include <cmath>
 #include <unordered_map>
@@ -43,13 +44,23 @@ void inflated_rect(double x, double y, double w, double h, double m,
     bottom = y + h + m;
 }
 
-bool rects_overlap(double x1, double y1, double w1, double h1, double m1,
-    double x2, double y2, double w2, double h2, double m2)
-{
-    double l1, t1, r1, b1, l2, t2, r2, b2;
-    inflated_rect(x1, y1, w1, h1, m1, l1, t1, r1, b1);
-    inflated_rect(x2, y2, w2, h2, m2, l2, t2, r2, b2);
-    return !(r1 + gap <= l2 || r2 + gap <= l1 || b1 + gap <= t2 || b2 + gap <= t1);
+void push_inflated(RectBatch& batch, const PlacedClassBlock& b) {
+    double l, t, r, bo;
+    inflated_rect(b.rect.x, b.rect.y, b.rect.width, b.rect.height, b.margin, l, t, r, bo);
+    batch.push_back(l, t, r, bo);
+}
+
+void update_inflated(RectBatch& batch, std::size_t i, const PlacedClassBlock& b) {
+    double l, t, r, bo;
+    inflated_rect(b.rect.x, b.rect.y, b.rect.width, b.rect.height, b.margin, l, t, r, bo);
+    batch.set(i, l, t, r, bo);
+}
+
+// True if the inflated candidate rect is within `gap` of any block already in the batch.
+bool overlaps_any(const RectBatch& batch, double x, double y, double w, double h, double m) {
+    double l, t, r, b;
+    inflated_rect(x, y, w, h, m, l, t, r, b);
+    return batch.find_first_overlap(l, t, r, b, 0, gap) != RectBatch::npos;
 }
 
 // Resolve overlap using minimum translation distance (MTD): push along a single axis
@@ -116,9 +127,15 @@ PlacedClassDiagram place_class_diagram(const diagram_model::ClassDiagram& diagra
     double row_top = padding;
     double row_bottom = padding;
 
-    for (const auto& c : diagram.classes) {
+    // Inflated rects of out.blocks, kept in step with them for batched overlap tests.
+    RectBatch inflated;
+    inflated.reserve(diagram.classes.size());
+
+    for (std::size_t ci = 0; ci < diagram.classes.size(); ++ci) {
+        const auto& c = diagram.classes[ci];
         PlacedClassBlock block;
         block.class_id = c.id;
+        block.class_index = ci;
         block.expanded = false;
         auto it = expanded.find(c.id);
         if (it != expanded.end()) block.expanded = it->second;
@@ -234,14 +251,10 @@ PlacedClassDiagram place_class_diagram(const diagram_model::ClassDiagram& diagra
             } else {
                 double place_x = next_x;
                 double place_y = row_top;
-            for (const auto& existing : out.blocks) {
-                if (rects_overlap(place_x, place_y, w, h, block.margin,
-                        existing.rect.x, existing.rect.y, existing.rect.width, existing.rect.height, existing.margin)) {
-                    row_top = row_bottom + gap;
-                    place_x = padding;
-                    place_y = row_top;
-                    break;
-                }
+            if (overlaps_any(inflated, place_x, place_y, w, h, block.margin)) {
+                row_top = row_bottom + gap;
+                place_x = padding;
+                place_y = row_top;
             }
             block.rect.x = place_x;
             block.rect.y = place_y;
@@ -251,14 +264,10 @@ PlacedClassDiagram place_class_diagram(const diagram_model::ClassDiagram& diagra
         } else {
             double place_x = next_x;
             double place_y = row_top;
-            for (const auto& existing : out.blocks) {
-                if (rects_overlap(place_x, place_y, w, h, block.margin,
-                        existing.rect.x, existing.rect.y, existing.rect.width, existing.rect.height, existing.margin)) {
-                    row_top = row_bottom + gap;
-                    place_x = padding;
-                    place_y = row_top;
-                    break;
-                }
+            if (overlaps_any(inflated, place_x, place_y, w, h, block.margin)) {
+                row_top = row_bottom + gap;
+                place_x = padding;
+                place_y = row_top;
             }
             block.rect.x = place_x;
             block.rect.y = place_y;
@@ -266,6 +275,7 @@ PlacedClassDiagram place_class_diagram(const diagram_model::ClassDiagram& diagra
             row_bottom = std::max(row_bottom, place_y + h);
         }
 
+        push_inflated(inflated, block);
         out.blocks.push_back(std::move(block));
     }
 
@@ -277,18 +287,16 @@ PlacedClassDiagram place_class_diagram(const diagram_model::ClassDiagram& diagra
     for (int iter = 0; iter < max_iter; ++iter) {
         bool any_overlap = false;
         for (size_t i = 0; i < out.blocks.size(); ++i) {
-            for (size_t j = i + 1; j < out.blocks.size(); ++j) {
-                double l1, t1, r1, b1, l2, t2, r2, b2;
-                inflated_rect(out.blocks[i].rect.x, out.blocks[i].rect.y,
-                    out.blocks[i].rect.width, out.blocks[i].rect.height, out.blocks[i].margin,
-                    l1, t1, r1, b1);
-                inflated_rect(out.blocks[j].rect.x, out.blocks[j].rect.y,
-                    out.blocks[j].rect.width, out.blocks[j].rect.height, out.blocks[j].margin,
-                    l2, t2, r2, b2);
-                if (r1 + gap <= l2 || r2 + gap <= l1 || b1 + gap <= t2 || b2 + gap <= t1)
-                    continue;
+            // Same pair order as the plain i < j loop: block i moves on every resolve, so the
+            // scan restarts after j against its updated rect.
+            size_t j = i + 1;
+            while ((j = inflated.find_first_overlap(inflated.left(i), inflated.top(i),
+                        inflated.right(i), inflated.bottom(i), j, gap)) != RectBatch::npos) {
                 any_overlap = true;
                 resolve_overlap(out.blocks[i], out.blocks[j], relax);
+                update_inflated(inflated, i, out.blocks[i]);
+                update_inflated(inflated, j, out.blocks[j]);
+                ++j;
             }
         }
         if (!any_overlap) break;
@@ -1,4 +1,5 @@
 #include <diagram_placement/connection_lines.hpp>
+#include <algorithm>
 #include <cmath>
 #include <unordered_map>
 
@@ -16,17 +17,6 @@ struct BlockRect {
     double right() const { return x + w; }
 };
 
-// Find the placed rect for a given class_id.  Returns false if not found.
-bool find_block_rect(const PlacedClassDiagram& placed, const std::string& id, BlockRect& out) {
-    for (const auto& b : placed.blocks) {
-        if (b.class_id == id) {
-            out = { b.rect.x, b.rect.y, b.rect.width, b.rect.height };
-            return true;
-        }
-    }
-    return false;
-}
-
 // Choose best anchor pair between two blocks.
 // For inheritance (parent above child): bottom-center of parent -> top-center of child.
 // For composition: choose closest edge pair (left/right/top/bottom centers).
@@ -66,75 +56,161 @@ AnchorPair closest_anchors(const BlockRect& from, const BlockRect& to) {
     return { best->x1, best->y1, best->x2, best->y2 };
 }
 
-} // namespace
+void push_point(ConnectionGeometry& out, double x, double y) {
+    out.points.push_back(static_cast<float>(x));
+    out.points.push_back(static_cast<float>(y));
+}
 
-std::vector<ConnectionLine> compute_connection_lines(
-    const diagram_model::ClassDiagram& diagram,
-    const PlacedClassDiagram& placed)
+void push_line(ConnectionGeometry& out, ConnectionKind kind,
+    std::uint32_t from, std::uint32_t to, std::uint32_t slot)
 {
-    std::vector<ConnectionLine> lines;
+    out.kind.push_back(kind);
+    out.from_class.push_back(from);
+    out.to_class.push_back(to);
+    out.slot.push_back(slot);
+}
 
-    for (const auto& cls : diagram.classes) {
-        BlockRect child_rect;
-        if (!find_block_rect(placed, cls.id, child_rect)) continue;
+template <typename T>
+std::size_t vector_bytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+} // namespace
+
+std::size_t ConnectionGeometry::memory_bytes() const {
+    return vector_bytes(kind) + vector_bytes(from_class) + vector_bytes(to_class)
+        + vector_bytes(slot) + vector_bytes(point_offset) + vector_bytes(point_count)
+        + vector_bytes(points) + vector_bytes(class_block);
+}
+
+void ConnectionGeometry::clear() {
+    kind.clear();
+    from_class.clear();
+    to_class.clear();
+    slot.clear();
+    point_offset.clear();
+    point_count.clear();
+    points.clear();
+    class_block.clear();
+}
+
+void build_connection_topology(const diagram_model::ClassDiagram& diagram, ConnectionGeometry& out) {
+    out.clear();
+
+    std::unordered_map<std::string, std::uint32_t> index_of;
+    index_of.reserve(diagram.classes.size());
+    for (std::size_t i = 0; i < diagram.classes.size(); ++i)
+        index_of.emplace(diagram.classes[i].id, static_cast<std::uint32_t>(i));
+
+    for (std::size_t ci = 0; ci < diagram.classes.size(); ++ci) {
+        const auto& cls = diagram.classes[ci];
+        const auto from = static_cast<std::uint32_t>(ci);
 
         // Inheritance lines.
         for (std::size_t pi = 0; pi < cls.parent_class_ids.size(); ++pi) {
-            BlockRect parent_rect;
-            if (!find_block_rect(placed, cls.parent_class_ids[pi], parent_rect)) continue;
+            const auto it = index_of.find(cls.parent_class_ids[pi]);
+            if (it == index_of.end()) continue;
+            push_line(out, (pi == 0) ? ConnectionKind::PrimaryInheritance
+                                     : ConnectionKind::SecondaryInheritance,
+                from, it->second, static_cast<std::uint32_t>(pi));
+        }
 
-            ConnectionLine line;
-            line.from_class_id = cls.id;
-            line.to_class_id = cls.parent_class_ids[pi];
-            line.kind = (pi == 0) ? ConnectionKind::PrimaryInheritance
-                                  : ConnectionKind::SecondaryInheritance;
+        // Composition lines (child_objects).
+        for (std::size_t oi = 0; oi < cls.child_objects.size(); ++oi) {
+            const auto it = index_of.find(cls.child_objects[oi].class_id);
+            if (it == index_of.end()) continue;
+            push_line(out, ConnectionKind::Composition, from, it->second, static_cast<std::uint32_t>(oi));
+        }
+    }
 
-            AnchorPair a = inheritance_anchors(child_rect, parent_rect);
-            line.points.push_back({a.x1, a.y1});
+    // Every route has at most 4 points.
+    out.point_offset.resize(out.size(), 0);
+    out.point_count.resize(out.size(), 0);
+    out.points.reserve(out.size() * 8u);
+}
+
+void map_class_blocks(const PlacedClassDiagram& placed, ConnectionGeometry& out) {
+    std::uint32_t max_class = 0;
+    for (const auto& b : placed.blocks)
+        max_class = std::max(max_class, static_cast<std::uint32_t>(b.class_index + 1));
+    for (std::size_t i = 0; i < out.size(); ++i)
+        max_class = std::max({ max_class, out.from_class[i] + 1, out.to_class[i] + 1 });
+
+    out.class_block.assign(max_class, ConnectionGeometry::npos);
+    for (std::size_t bi = 0; bi < placed.blocks.size(); ++bi)
+        out.class_block[placed.blocks[bi].class_index] = static_cast<std::uint32_t>(bi);
+}
+
+void route_connection_lines(const PlacedClassDiagram& placed, ConnectionGeometry& out) {
+    map_class_blocks(placed, out);
+
+    auto block_rect = [&](std::uint32_t class_index, BlockRect& r) {
+        const std::uint32_t bi = out.class_block[class_index];
+        if (bi == ConnectionGeometry::npos) return false;
+        const Rect& rect = placed.blocks[bi].rect;
+        r = { rect.x, rect.y, rect.width, rect.height };
+        return true;
+    };
+
+    out.points.clear();
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        out.point_offset[i] = static_cast<std::uint32_t>(out.points.size() / 2u);
+        out.point_count[i] = 0;
+
+        BlockRect from_rect, to_rect;
+        if (!block_rect(out.from_class[i], from_rect) || !block_rect(out.to_class[i], to_rect))
+            continue;
+
+        if (out.kind[i] != ConnectionKind::Composition) {
+            AnchorPair a = inheritance_anchors(from_rect, to_rect);
+            push_point(out, a.x1, a.y1);
 
             // If not roughly vertical, add a midpoint for an orthogonal bend.
             double mid_y = (a.y1 + a.y2) * 0.5;
             if (std::abs(a.x2 - a.x1) > 5.0) {
-                line.points.push_back({a.x1, mid_y});
-                line.points.push_back({a.x2, mid_y});
+                push_point(out, a.x1, mid_y);
+                push_point(out, a.x2, mid_y);
             }
 
-            line.points.push_back({a.x2, a.y2});
-            lines.push_back(std::move(line));
-        }
-
-        // Composition lines (child_objects).
-        for (const auto& co : cls.child_objects) {
-            BlockRect target_rect;
-            if (!find_block_rect(placed, co.class_id, target_rect)) continue;
-
-            ConnectionLine line;
-            line.from_class_id = cls.id;
-            line.to_class_id = co.class_id;
-            line.kind = ConnectionKind::Composition;
-            line.label = co.label;
-
-            AnchorPair a = closest_anchors(child_rect, target_rect);
-            line.points.push_back({a.x1, a.y1});
+            push_point(out, a.x2, a.y2);
+        } else {
+            AnchorPair a = closest_anchors(from_rect, to_rect);
+            push_point(out, a.x1, a.y1);
 
             // Orthogonal routing: add midpoint bend.
             double mid_x = (a.x1 + a.x2) * 0.5;
             double mid_y = (a.y1 + a.y2) * 0.5;
             bool horizontal = std::abs(a.x2 - a.x1) > std::abs(a.y2 - a.y1);
             if (horizontal) {
-                line.points.push_back({mid_x, a.y1});
-                line.points.push_back({mid_x, a.y2});
+                push_point(out, mid_x, a.y1);
+                push_point(out, mid_x, a.y2);
             } else {
-                line.points.push_back({a.x1, mid_y});
-                line.points.push_back({a.x2, mid_y});
+                push_point(out, a.x1, mid_y);
+                push_point(out, a.x2, mid_y);
             }
 
-            line.points.push_back({a.x2, a.y2});
-            lines.push_back(std::move(line));
+            push_point(out, a.x2, a.y2);
         }
+        out.point_count[i] = static_cast<std::uint32_t>(out.points.size() / 2u) - out.point_offset[i];
     }
+}
 
-    return lines;
+void compute_connection_lines(const diagram_model::ClassDiagram& diagram,
+    const PlacedClassDiagram& placed,
+    ConnectionGeometry& out)
+{
+    build_connection_topology(diagram, out);
+    route_connection_lines(placed, out);
+}
+
+const std::string& connection_label(const diagram_model::ClassDiagram& diagram,
+    const ConnectionGeometry& geometry, std::size_t line)
+{
+    static const std::string empty;
+    if (geometry.kind[line] != ConnectionKind::Composition) return empty;
+    const auto& owner = diagram.classes[geometry.from_class[line]];
+    const std::uint32_t slot = geometry.slot[line];
+    return slot < owner.child_objects.size() ? owner.child_objects[slot].label : empty;
 }
 
 } // namespace diagram_placement
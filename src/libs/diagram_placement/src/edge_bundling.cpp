@@ -0,0 +1,154 @@
+#include <diagram_placement/edge_bundling.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace diagram_placement {
+
+namespace {
+
+constexpr float kAnchorEps = 0.5f;
+
+// Axis direction of a segment: 0 = +x, 1 = -x, 2 = +y, 3 = -y; -1 for a degenerate or diagonal one.
+int segment_heading(const float* a, const float* b) {
+    const float dx = b[0] - a[0];
+    const float dy = b[1] - a[1];
+    if (std::abs(dy) < 1e-4f && std::abs(dx) > 1e-4f) return dx > 0.0f ? 0 : 1;
+    if (std::abs(dx) < 1e-4f && std::abs(dy) > 1e-4f) return dy > 0.0f ? 2 : 3;
+    return -1;
+}
+
+constexpr float kDirX[4] = { 1.0f, -1.0f, 0.0f, 0.0f };
+constexpr float kDirY[4] = { 0.0f, 0.0f, 1.0f, -1.0f };
+
+} // namespace
+
+std::size_t ConnectionBundles::memory_bytes() const {
+    return kind.capacity() * sizeof(ConnectionKind)
+        + to_class.capacity() * sizeof(std::uint32_t)
+        + (trunk.capacity() + bus.capacity()) * sizeof(float)
+        + line_bundle.capacity() * sizeof(std::uint32_t)
+        + order.capacity() * sizeof(order[0]);
+}
+
+void ConnectionBundles::clear() {
+    kind.clear();
+    to_class.clear();
+    trunk.clear();
+    bus.clear();
+    line_bundle.clear();
+    order.clear();
+}
+
+void bundle_connection_lines(ConnectionGeometry& geometry, ConnectionBundles& out,
+    const EdgeBundlingOptions& options)
+{
+    out.kind.clear();
+    out.to_class.clear();
+    out.trunk.clear();
+    out.bus.clear();
+    out.order.clear();
+    out.line_bundle.assign(geometry.size(), ConnectionGeometry::npos);
+
+    // Candidates: routed lines that leave and arrive travelling the same way, keyed by hub.
+    for (std::size_t li = 0; li < geometry.size(); ++li) {
+        if (geometry.kind[li] == ConnectionKind::SecondaryInheritance) continue;
+        const std::uint32_t count = geometry.point_count[li];
+        if (count < 2) continue;
+        const float* pts = geometry.route(li);
+        const int arrive = segment_heading(pts + 2u * (count - 2u), pts + 2u * (count - 1u));
+        if (arrive < 0 || segment_heading(pts, pts + 2) != arrive) continue;
+        const std::uint64_t key = (static_cast<std::uint64_t>(geometry.to_class[li]) << 8)
+            | (static_cast<std::uint64_t>(geometry.kind[li]) << 2)
+            | static_cast<std::uint64_t>(arrive);
+        out.order.emplace_back(key, static_cast<std::uint32_t>(li));
+    }
+    std::sort(out.order.begin(), out.order.end());
+
+    const std::size_t min_fan_in = std::max<std::size_t>(options.min_fan_in, 2);
+    std::size_t run_begin = 0;
+    while (run_begin < out.order.size()) {
+        std::size_t run_end = run_begin + 1;
+        while (run_end < out.order.size() && out.order[run_end].first == out.order[run_begin].first) ++run_end;
+        if (run_end - run_begin < min_fan_in) {
+            run_begin = run_end;
+            continue;
+        }
+
+        const int heading = static_cast<int>(out.order[run_begin].first & 3u);
+        const float dx = kDirX[heading], dy = kDirY[heading];
+        const std::uint32_t first_line = out.order[run_begin].second;
+        const float* first_pts = geometry.route(first_line);
+        const std::uint32_t first_count = geometry.point_count[first_line];
+        const float ex = first_pts[2u * first_count - 2u];
+        const float ey = first_pts[2u * first_count - 1u];
+
+        // Members must share the anchor exactly and start far enough behind it for a trunk.
+        auto member_distance = [&](std::uint32_t line) {
+            const float* pts = geometry.route(line);
+            const std::uint32_t count = geometry.point_count[line];
+            if (std::abs(pts[2u * count - 2u] - ex) > kAnchorEps || std::abs(pts[2u * count - 1u] - ey) > kAnchorEps)
+                return -1.0f;
+            const float dist = (ex - pts[0]) * dx + (ey - pts[1]) * dy;
+            return dist >= 2.0f * static_cast<float>(options.min_trunk) ? dist : -1.0f;
+        };
+        std::size_t members = 0;
+        float nearest = std::numeric_limits<float>::max();
+        for (std::size_t k = run_begin; k < run_end; ++k) {
+            const float dist = member_distance(out.order[k].second);
+            if (dist < 0.0f) continue;
+            ++members;
+            nearest = std::min(nearest, dist);
+        }
+        if (members < min_fan_in) {
+            run_begin = run_end;
+            continue;
+        }
+
+        const float trunk_len = std::min(nearest,
+            std::max(static_cast<float>(options.min_trunk), nearest * static_cast<float>(options.trunk_fraction)));
+        const float tx = ex - dx * trunk_len;
+        const float ty = ey - dy * trunk_len;
+        const auto bundle = static_cast<std::uint32_t>(out.kind.size());
+
+        // Perpendicular extent of the bus, including the trunk itself.
+        const bool vertical_trunk = heading >= 2;
+        const float bus_axis = tx * dx + ty * dy;
+        float lo = vertical_trunk ? ex : ey;
+        float hi = lo;
+        for (std::size_t k = run_begin; k < run_end; ++k) {
+            const std::uint32_t line = out.order[k].second;
+            const float dist = member_distance(line);
+            if (dist < 0.0f) continue;
+            // Keep the member's own route up to where it first reaches the bus, so routed
+            // detours around blocks survive; the rest is shared through the trunk.
+            float* pts = geometry.points.data() + 2u * geometry.point_offset[line];
+            const std::uint32_t count = geometry.point_count[line];
+            std::uint32_t cut = count - 1u;
+            for (std::uint32_t p = 1; p < count; ++p) {
+                if (pts[2u * p] * dx + pts[2u * p + 1u] * dy >= bus_axis) {
+                    cut = p;
+                    break;
+                }
+            }
+            if (vertical_trunk) pts[2u * cut + 1u] = ty;
+            else pts[2u * cut] = tx;
+            const float sx = pts[2u * cut], sy = pts[2u * cut + 1u];
+            geometry.point_count[line] = cut + 1u;
+            out.line_bundle[line] = bundle;
+            lo = std::min(lo, vertical_trunk ? sx : sy);
+            hi = std::max(hi, vertical_trunk ? sx : sy);
+        }
+
+        out.kind.push_back(geometry.kind[first_line]);
+        out.to_class.push_back(geometry.to_class[first_line]);
+        out.trunk.insert(out.trunk.end(), { tx, ty, ex, ey });
+        if (vertical_trunk)
+            out.bus.insert(out.bus.end(), { lo, ty, hi, ty });
+        else
+            out.bus.insert(out.bus.end(), { tx, lo, tx, hi });
+        run_begin = run_end;
+    }
+}
+
+} // namespace diagram_placement
@@ -0,0 +1,456 @@
+#include <diagram_placement/graph_layout.hpp>
+#include <diagram_placement/worker_pool.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace diagram_placement {
+
+namespace {
+
+constexpr int kMaxQuadDepth = 40;
+constexpr double kMinDistance = 1.0;
+constexpr double kRepulsionStrength = 0.05;
+constexpr std::size_t kParallelThreshold = 2048;
+constexpr std::size_t kRepulsionChunk = 8192;
+const double golden_angle = 2.39996322972865332;
+
+// Small deterministic offset so nodes seeded at the same spot do not coincide.
+void jitter(std::uint32_t i, double scale, double& x, double& y) {
+    std::uint32_t h = i * 2654435761u;
+    h ^= h >> 16;
+    x += (static_cast<double>(h & 0xFFFFu) / 65535.0 - 0.5) * scale;
+    y += (static_cast<double>(h >> 16) / 65535.0 - 0.5) * scale;
+}
+
+// Point where the segment from the rect centre towards (tx, ty) leaves the rect.
+std::pair<double, double> clip_to_rect(double cx, double cy, double half_w, double half_h, double tx, double ty) {
+    const double dx = tx - cx;
+    const double dy = ty - cy;
+    double s = 1.0;
+    if (std::abs(dx) > 1e-9) s = std::min(s, half_w / std::abs(dx));
+    if (std::abs(dy) > 1e-9) s = std::min(s, half_h / std::abs(dy));
+    return { cx + dx * s, cy + dy * s };
+}
+
+} // namespace
+
+void GraphLayout::clear() {
+    diagram_ = nullptr;
+    synced_nodes_ = synced_edges_ = 0;
+    x_.clear(); y_.clear(); w_.clear(); h_.clear(); dx_.clear(); dy_.clear();
+    pinned_.clear();
+    index_of_.clear();
+    edge_from_.clear(); edge_to_.clear(); edge_slot_.clear();
+    quad_.clear();
+    temperature_ = 0.0;
+    cursor_ = 0;
+    ++generation_;
+    placed_structure_valid_ = false;
+    placed_ = PlacedDiagram{};
+}
+
+void GraphLayout::sync(const diagram_model::Diagram& diagram, bool force) {
+    if (!force && &diagram == diagram_ && diagram.nodes.size() == synced_nodes_
+        && diagram.edges.size() == synced_edges_)
+        return;
+
+    // Remember where known nodes were so an edit does not reshuffle the whole layout.
+    std::unordered_map<std::string, std::pair<double, double>> previous;
+    previous.reserve(index_of_.size());
+    for (const auto& [id, i] : index_of_)
+        if (!pinned_[i]) previous.emplace(id, std::make_pair(x_[i], y_[i]));
+
+    diagram_ = &diagram;
+    synced_nodes_ = diagram.nodes.size();
+    synced_edges_ = diagram.edges.size();
+    const std::size_t n = diagram.nodes.size();
+
+    index_of_.clear();
+    index_of_.reserve(n);
+    x_.assign(n, 0.0); y_.assign(n, 0.0);
+    w_.resize(n); h_.resize(n);
+    dx_.assign(n, 0.0); dy_.assign(n, 0.0);
+    pinned_.assign(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& node = diagram.nodes[i];
+        index_of_.emplace(node.id, static_cast<std::uint32_t>(i));
+        w_[i] = node.width > 0 ? node.width : 80.0;
+        h_[i] = node.height > 0 ? node.height : 40.0;
+        // Same rule as the old stacking placer: a zero position means "place me".
+        if (node.x != 0 || node.y != 0) {
+            pinned_[i] = 1;
+            x_[i] = node.x + w_[i] * 0.5;
+            y_[i] = node.y + h_[i] * 0.5;
+        }
+    }
+
+    edge_from_.clear(); edge_to_.clear(); edge_slot_.clear();
+    for (std::size_t e = 0; e < diagram.edges.size(); ++e) {
+        const auto s = index_of_.find(diagram.edges[e].source_node_id);
+        const auto t = index_of_.find(diagram.edges[e].target_node_id);
+        if (s == index_of_.end() || t == index_of_.end() || s->second == t->second) continue;
+        edge_from_.push_back(s->second);
+        edge_to_.push_back(t->second);
+        edge_slot_.push_back(static_cast<std::uint32_t>(e));
+    }
+
+    std::size_t seeded = 0;
+    seed_positions(previous, seeded);
+
+    // Reheat in proportion to how much of the graph is new.
+    const double t0 = options_.initial_temperature > 0.0
+        ? options_.initial_temperature
+        : options_.ideal_edge_length;
+    std::size_t movable = 0;
+    for (std::size_t i = 0; i < n; ++i) movable += pinned_[i] ? 0u : 1u;
+    if (movable == 0) {
+        temperature_ = 0.0;
+    } else {
+        const double fresh = static_cast<double>(seeded) / static_cast<double>(movable);
+        temperature_ = std::max(options_.settle_temperature * 4.0, t0 * std::min(1.0, fresh * 2.0));
+        if (seeded == 0 && !force) temperature_ = options_.settle_temperature; // only removals
+    }
+
+    energy_ = std::numeric_limits<double>::max();
+    progress_ = 0;
+    cursor_ = 0;
+    placed_structure_valid_ = false;
+    ++generation_;
+}
+
+void GraphLayout::seed_positions(const std::unordered_map<std::string, std::pair<double, double>>& previous,
+    std::size_t& seeded)
+{
+    const std::size_t n = x_.size();
+    const auto& nodes = diagram_->nodes;
+    std::vector<std::uint8_t> placed(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (pinned_[i]) {
+            placed[i] = 1;
+            continue;
+        }
+        const auto it = previous.find(nodes[i].id);
+        if (it == previous.end()) continue;
+        x_[i] = it->second.first;
+        y_[i] = it->second.second;
+        placed[i] = 1;
+    }
+
+    // CSR adjacency for the breadth-first seeding below.
+    std::vector<std::uint32_t> adj_start(n + 1, 0), adj;
+    for (std::size_t e = 0; e < edge_from_.size(); ++e) {
+        ++adj_start[edge_from_[e] + 1];
+        ++adj_start[edge_to_[e] + 1];
+    }
+    for (std::size_t i = 0; i < n; ++i) adj_start[i + 1] += adj_start[i];
+    adj.resize(adj_start[n]);
+    {
+        std::vector<std::uint32_t> fill(adj_start.begin(), adj_start.end() - 1);
+        for (std::size_t e = 0; e < edge_from_.size(); ++e) {
+            adj[fill[edge_from_[e]]++] = edge_to_[e];
+            adj[fill[edge_to_[e]]++] = edge_from_[e];
+        }
+    }
+
+    // New nodes next to already placed neighbours, spreading outwards breadth-first.
+    const double k = options_.ideal_edge_length;
+    std::vector<std::uint32_t> queue;
+    queue.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        if (placed[i]) queue.push_back(static_cast<std::uint32_t>(i));
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t u = queue[head];
+        for (std::uint32_t a = adj_start[u]; a < adj_start[u + 1]; ++a) {
+            const std::uint32_t v = adj[a];
+            if (placed[v]) continue;
+            placed[v] = 1;
+            x_[v] = x_[u];
+            y_[v] = y_[u];
+            jitter(v, k, x_[v], y_[v]);
+            queue.push_back(v);
+            ++seeded;
+        }
+    }
+
+    // Components without any placed node: breadth-first order along a sunflower spiral,
+    // so neighbours start close together.
+    double cx = 0.0, cy = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!placed[i]) continue;
+        cx = std::max(cx, x_[i] + k);
+    }
+    std::size_t spiral = 0;
+    for (std::size_t root = 0; root < n; ++root) {
+        if (placed[root]) continue;
+        queue.clear();
+        queue.push_back(static_cast<std::uint32_t>(root));
+        placed[root] = 1;
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            const std::uint32_t u = queue[head];
+            const double r = k * 0.5 * std::sqrt(static_cast<double>(spiral));
+            const double a = static_cast<double>(spiral) * golden_angle;
+            x_[u] = cx + r * std::cos(a);
+            y_[u] = cy + r * std::sin(a);
+            ++spiral;
+            ++seeded;
+            for (std::uint32_t e = adj_start[u]; e < adj_start[u + 1]; ++e) {
+                const std::uint32_t v = adj[e];
+                if (placed[v]) continue;
+                placed[v] = 1;
+                queue.push_back(v);
+            }
+        }
+    }
+}
+
+void GraphLayout::build_quadtree() {
+    const std::size_t n = x_.size();
+    quad_.clear();
+    double min_x = std::numeric_limits<double>::max(), min_y = min_x;
+    double max_x = std::numeric_limits<double>::lowest(), max_y = max_x;
+    for (std::size_t i = 0; i < n; ++i) {
+        min_x = std::min(min_x, x_[i]); max_x = std::max(max_x, x_[i]);
+        min_y = std::min(min_y, y_[i]); max_y = std::max(max_y, y_[i]);
+    }
+    const double root_cx = (min_x + max_x) * 0.5;
+    const double root_cy = (min_y + max_y) * 0.5;
+    const double root_half = std::max({ max_x - min_x, max_y - min_y, 1.0 }) * 0.5 + 1.0;
+    quad_.push_back(QuadNode{});
+
+    // Insert bodies; a cell's square bounds are recomputed while descending instead of stored.
+    // The four children of a cell are allocated together, so a cell only needs its first child.
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto body = static_cast<std::int32_t>(i);
+        std::size_t q = 0;
+        double cx = root_cx, cy = root_cy, half = root_half;
+        for (int depth = 0;; ++depth) {
+            if (quad_[q].child < 0) {
+                if (quad_[q].mass == 0.0) {
+                    quad_[q].body = body;
+                    quad_[q].mass = 1.0;
+                    quad_[q].mx = x_[i];
+                    quad_[q].my = y_[i];
+                    break;
+                }
+                if (depth >= kMaxQuadDepth) {
+                    // Coincident points: aggregate into this leaf, centre of mass as a running mean.
+                    QuadNode& leaf = quad_[q];
+                    leaf.body = -1;
+                    leaf.mass += 1.0;
+                    leaf.mx += (x_[i] - leaf.mx) / leaf.mass;
+                    leaf.my += (y_[i] - leaf.my) / leaf.mass;
+                    break;
+                }
+                // Split: move the resident body into its quadrant, then keep descending.
+                const auto base = static_cast<std::int32_t>(quad_.size());
+                quad_.resize(quad_.size() + 4);
+                const std::int32_t resident = quad_[q].body;
+                const int rq = (x_[static_cast<std::size_t>(resident)] >= cx ? 1 : 0)
+                    | (y_[static_cast<std::size_t>(resident)] >= cy ? 2 : 0);
+                QuadNode& moved = quad_[static_cast<std::size_t>(base + rq)];
+                moved.body = resident;
+                moved.mass = 1.0;
+                moved.mx = x_[static_cast<std::size_t>(resident)];
+                moved.my = y_[static_cast<std::size_t>(resident)];
+                quad_[q].child = base;
+                quad_[q].body = -1;
+            }
+            const int quadrant = (x_[i] >= cx ? 1 : 0) | (y_[i] >= cy ? 2 : 0);
+            half *= 0.5;
+            cx += (quadrant & 1) ? half : -half;
+            cy += (quadrant & 2) ? half : -half;
+            q = static_cast<std::size_t>(quad_[q].child + quadrant);
+            quad_[q].open2 = half * half * 4.0;
+        }
+    }
+
+    // Children always follow their parent, so a reverse sweep aggregates bottom-up.
+    const double inv_theta2 = 1.0 / (options_.theta * options_.theta);
+    quad_[0].open2 = root_half * root_half * 4.0;
+    for (std::size_t qi = quad_.size(); qi-- > 0;) {
+        QuadNode& q = quad_[qi];
+        q.open2 *= inv_theta2; // open the cell while size^2 >= theta^2 * d^2
+        if (q.child < 0) continue;  // leaves got their centre of mass on insertion
+        double mass = 0.0, mx = 0.0, my = 0.0;
+        for (std::int32_t c = q.child; c < q.child + 4; ++c) {
+            const QuadNode& cn = quad_[static_cast<std::size_t>(c)];
+            mass += cn.mass;
+            mx += cn.mx * cn.mass;
+            my += cn.my * cn.mass;
+        }
+        q.mass = mass;
+        q.mx = mass > 0.0 ? mx / mass : 0.0;
+        q.my = mass > 0.0 ? my / mass : 0.0;
+    }
+}
+
+void GraphLayout::repulsion_for(std::size_t i, double k2, double& fx, double& fy) const {
+    std::int32_t stack[4 * (kMaxQuadDepth + 2)];
+    int top = 0;
+    stack[top++] = 0;
+    const double xi = x_[i], yi = y_[i];
+    const auto self = static_cast<std::int32_t>(i);
+    while (top > 0) {
+        const QuadNode& q = quad_[static_cast<std::size_t>(stack[--top])];
+        if (q.mass == 0.0 || q.body == self) continue;
+        const double dx = xi - q.mx;
+        const double dy = yi - q.my;
+        const double d2 = dx * dx + dy * dy;
+        if (q.child < 0 || q.open2 < d2) {
+            const double d2c = std::max(d2, kMinDistance * kMinDistance);
+            const double f = k2 * q.mass / d2c; // (k2 * mass / d) / d for the unit vector
+            fx += dx * f;
+            fy += dy * f;
+            continue;
+        }
+        stack[top++] = q.child;
+        stack[top++] = q.child + 1;
+        stack[top++] = q.child + 2;
+        stack[top++] = q.child + 3;
+    }
+}
+
+void GraphLayout::repulse_range(std::size_t begin, std::size_t end) {
+    // Spring-electrical model (Hu 2005): repulsion C*K^2/d, attraction d^2/K.
+    const double k = options_.ideal_edge_length;
+    const double k2 = kRepulsionStrength * k * k;
+    auto repulse = [&](std::size_t b, std::size_t e, unsigned) {
+        for (std::size_t i = b; i < e; ++i) {
+            dx_[i] = 0.0;
+            dy_[i] = 0.0;
+            if (!pinned_[i]) repulsion_for(i, k2, dx_[i], dy_[i]);
+        }
+    };
+    if (options_.parallel && end - begin >= kParallelThreshold) {
+        WorkerPool::shared().parallel_for(end - begin, 256, [&](std::size_t b, std::size_t e, unsigned w) {
+            repulse(begin + b, begin + e, w);
+        });
+    } else {
+        repulse(begin, end, 0);
+    }
+}
+
+void GraphLayout::finish_iteration() {
+    const std::size_t n = x_.size();
+    const double k = options_.ideal_edge_length;
+    for (std::size_t e = 0; e < edge_from_.size(); ++e) {
+        const std::uint32_t a = edge_from_[e], b = edge_to_[e];
+        const double dx = x_[a] - x_[b];
+        const double dy = y_[a] - y_[b];
+        const double d = std::sqrt(dx * dx + dy * dy);
+        const double f = d / k; // d^2 / K, already divided by d for the unit vector
+        dx_[a] -= dx * f; dy_[a] -= dy * f;
+        dx_[b] += dx * f; dy_[b] += dy * f;
+    }
+
+    // Every free node moves `temperature_` along its force; the step adapts to the energy trend.
+    double energy = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (pinned_[i]) continue;
+        const double len2 = dx_[i] * dx_[i] + dy_[i] * dy_[i];
+        energy += len2;
+        if (len2 < 1e-18) continue;
+        const double len = std::sqrt(len2);
+        x_[i] += dx_[i] / len * temperature_;
+        y_[i] += dy_[i] / len * temperature_;
+    }
+    if (energy < energy_) {
+        if (++progress_ >= 5) {
+            progress_ = 0;
+            temperature_ /= options_.cooling;
+        }
+    } else {
+        progress_ = 0;
+        temperature_ *= options_.cooling;
+    }
+    energy_ = energy;
+}
+
+bool GraphLayout::step(int max_iterations, double time_budget_ms) {
+    if (!diagram_ || is_settled()) return false;
+    const std::size_t n = x_.size();
+    const auto start = std::chrono::steady_clock::now();
+    auto out_of_time = [&] {
+        return time_budget_ms > 0.0 && std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() >= time_budget_ms;
+    };
+
+    // With a time budget an iteration may span several calls: the repulsion pass is resumable
+    // (positions only change in finish_iteration), so large graphs keep the frame time bounded.
+    bool moved = false;
+    int iterations = 0;
+    while (iterations < max_iterations && !is_settled()) {
+        if (cursor_ == 0) build_quadtree();
+        const std::size_t end = time_budget_ms > 0.0 ? std::min(n, cursor_ + kRepulsionChunk) : n;
+        repulse_range(cursor_, end);
+        cursor_ = end;
+        if (cursor_ == n) {
+            finish_iteration();
+            cursor_ = 0;
+            moved = true;
+            ++iterations;
+        }
+        if (out_of_time()) break;
+    }
+    if (moved) ++generation_;
+    return moved;
+}
+
+void GraphLayout::run_to_convergence(int max_iterations) {
+    step(max_iterations);
+}
+
+void GraphLayout::write_placed() {
+    const auto& diagram = *diagram_;
+    const std::size_t n = x_.size();
+    if (!placed_structure_valid_) {
+        placed_.placed_nodes.clear();
+        placed_.placed_edges.clear();
+        placed_.placed_nodes.reserve(n);
+        for (const auto& node : diagram.nodes) {
+            PlacedNode pn;
+            pn.node_id = node.id;
+            pn.label = node.label;
+            pn.shape = node.shape;
+            placed_.placed_nodes.push_back(std::move(pn));
+        }
+        placed_.placed_edges.reserve(diagram.edges.size());
+        for (const auto& e : diagram.edges) {
+            PlacedEdge pe;
+            pe.edge_id = e.id;
+            pe.source_node_id = e.source_node_id;
+            pe.target_node_id = e.target_node_id;
+            pe.label = e.label;
+            placed_.placed_edges.push_back(std::move(pe));
+        }
+        placed_structure_valid_ = true;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        Rect& r = placed_.placed_nodes[i].rect;
+        r.x = x_[i] - w_[i] * 0.5;
+        r.y = y_[i] - h_[i] * 0.5;
+        r.width = w_[i];
+        r.height = h_[i];
+    }
+    // Straight edges between the node borders.
+    for (std::size_t e = 0; e < edge_from_.size(); ++e) {
+        const std::uint32_t a = edge_from_[e], b = edge_to_[e];
+        auto& points = placed_.placed_edges[edge_slot_[e]].points;
+        points.resize(2);
+        points[0] = clip_to_rect(x_[a], y_[a], w_[a] * 0.5, h_[a] * 0.5, x_[b], y_[b]);
+        points[1] = clip_to_rect(x_[b], y_[b], w_[b] * 0.5, h_[b] * 0.5, x_[a], y_[a]);
+    }
+}
+
+const PlacedDiagram& GraphLayout::placed() {
+    if (diagram_ && placed_generation_ != generation_) {
+        write_placed();
+        placed_generation_ = generation_;
+    }
+    return placed_;
+}
+
+} // namespace diagram_placement
@@ -0,0 +1,198 @@
+#include <diagram_placement/layout_metrics.hpp>
+#include <diagram_placement/rect_batch.hpp>
+#include <diagram_placement/spatial_grid.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace diagram_placement {
+
+namespace {
+
+struct Segment {
+    double x0, y0, x1, y1;
+};
+
+double cross(double ax, double ay, double bx, double by, double cx, double cy) {
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+// Segments cross at a single point interior to both.
+bool segments_cross(const Segment& a, const Segment& b) {
+    const double d1 = cross(a.x0, a.y0, a.x1, a.y1, b.x0, b.y0);
+    const double d2 = cross(a.x0, a.y0, a.x1, a.y1, b.x1, b.y1);
+    const double d3 = cross(b.x0, b.y0, b.x1, b.y1, a.x0, a.y0);
+    const double d4 = cross(b.x0, b.y0, b.x1, b.y1, a.x1, a.y1);
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+bool is_oblique(const Segment& s) {
+    return s.x0 != s.x1 && s.y0 != s.y1;
+}
+
+class MetricsBuilder {
+public:
+    void add_rect(const Rect& r) {
+        rects_.push_back(r.x, r.y, r.x + r.width, r.y + r.height);
+        min_x_ = std::min(min_x_, r.x);
+        min_y_ = std::min(min_y_, r.y);
+        max_x_ = std::max(max_x_, r.x + r.width);
+        max_y_ = std::max(max_y_, r.y + r.height);
+    }
+
+    void add_segment(double x0, double y0, double x1, double y1) {
+        if (x0 == x1 && y0 == y1) return;
+        metrics_.total_edge_length += std::hypot(x1 - x0, y1 - y0);
+        segments_.push_back({ x0, y0, x1, y1 });
+    }
+
+    void add_edge() { ++metrics_.edge_count; }
+
+    LayoutMetrics finish() {
+        metrics_.block_count = rects_.size();
+        for (std::size_t i = 0; i < rects_.size(); ++i) {
+            rects_.for_each_overlap(rects_.left(i), rects_.top(i), rects_.right(i), rects_.bottom(i), i + 1,
+                0.0, false, [&](std::size_t) { ++metrics_.residual_overlaps; });
+        }
+        if (rects_.size() > 0) {
+            metrics_.bbox_width = max_x_ - min_x_;
+            metrics_.bbox_height = max_y_ - min_y_;
+            if (metrics_.bbox_height > 0.0)
+                metrics_.aspect_ratio = metrics_.bbox_width / metrics_.bbox_height;
+        }
+        count_axis_crossings();
+        count_oblique_crossings();
+        return metrics_;
+    }
+
+private:
+    // Sweep a vertical line left to right over horizontal segments kept in a Fenwick tree by y;
+    // each vertical segment counts the active horizontals strictly inside its y range. Events
+    // at the same x: removals, then queries, then insertions, so only proper crossings count
+    // (polyline corners and shared endpoints do not).
+    void count_axis_crossings() {
+        struct Event {
+            double x;
+            int order;      // 0 remove, 1 query, 2 insert
+            std::size_t segment;
+        };
+        std::vector<Event> events;
+        std::vector<double> ys;
+        events.reserve(segments_.size() * 2);
+        for (std::size_t s = 0; s < segments_.size(); ++s) {
+            const Segment& g = segments_[s];
+            if (g.y0 == g.y1) {
+                events.push_back({ std::min(g.x0, g.x1), 2, s });
+                events.push_back({ std::max(g.x0, g.x1), 0, s });
+                ys.push_back(g.y0);
+            } else if (g.x0 == g.x1) {
+                events.push_back({ g.x0, 1, s });
+            }
+        }
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+        std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+            return a.x != b.x ? a.x < b.x : a.order < b.order;
+        });
+
+        std::vector<std::size_t> tree(ys.size() + 1, 0);
+        auto add = [&](std::size_t pos, std::ptrdiff_t delta) {
+            for (++pos; pos < tree.size(); pos += pos & (~pos + 1))
+                tree[pos] = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(tree[pos]) + delta);
+        };
+        auto prefix = [&](std::size_t count) { // active horizontals among the first `count` ys
+            std::size_t sum = 0;
+            for (; count > 0; count -= count & (~count + 1))
+                sum += tree[count];
+            return sum;
+        };
+        auto y_index = [&](double y) {
+            return static_cast<std::size_t>(std::lower_bound(ys.begin(), ys.end(), y) - ys.begin());
+        };
+
+        for (const Event& e : events) {
+            const Segment& g = segments_[e.segment];
+            if (e.order == 1) {
+                const double lo = std::min(g.y0, g.y1);
+                const double hi = std::max(g.y0, g.y1);
+                const std::size_t first = std::upper_bound(ys.begin(), ys.end(), lo) - ys.begin();
+                const std::size_t last = y_index(hi); // exclusive
+                if (last > first)
+                    metrics_.edge_crossings += prefix(last) - prefix(first);
+            } else {
+                add(y_index(g.y0), e.order == 2 ? 1 : -1);
+            }
+        }
+    }
+
+    // Straight-line layouts: test oblique segments against grid neighbours exactly. Each
+    // oblique/oblique pair is counted once (from the lower index).
+    void count_oblique_crossings() {
+        std::vector<std::uint32_t> oblique;
+        for (std::size_t s = 0; s < segments_.size(); ++s)
+            if (is_oblique(segments_[s])) oblique.push_back(static_cast<std::uint32_t>(s));
+        if (oblique.empty()) return;
+
+        std::vector<Rect> boxes;
+        boxes.reserve(segments_.size());
+        for (const Segment& g : segments_)
+            boxes.push_back(bounds(g));
+        SpatialGrid grid;
+        grid.build(boxes);
+        for (std::uint32_t s : oblique) {
+            const Segment& a = segments_[s];
+            grid.query(boxes[s], [&](std::uint32_t t) {
+                if (t == s || (is_oblique(segments_[t]) && t < s)) return;
+                if (segments_cross(a, segments_[t])) ++metrics_.edge_crossings;
+            });
+        }
+    }
+
+    static Rect bounds(const Segment& g) {
+        const double x = std::min(g.x0, g.x1);
+        const double y = std::min(g.y0, g.y1);
+        return { x, y, std::max(g.x0, g.x1) - x, std::max(g.y0, g.y1) - y };
+    }
+
+    LayoutMetrics metrics_;
+    RectBatch rects_;
+    std::vector<Segment> segments_;
+    double min_x_ = std::numeric_limits<double>::max();
+    double min_y_ = std::numeric_limits<double>::max();
+    double max_x_ = std::numeric_limits<double>::lowest();
+    double max_y_ = std::numeric_limits<double>::lowest();
+};
+
+} // namespace
+
+LayoutMetrics compute_layout_metrics(const PlacedClassDiagram& placed, const ConnectionGeometry& geometry) {
+    MetricsBuilder builder;
+    for (const auto& block : placed.blocks)
+        builder.add_rect(block.rect);
+    for (std::size_t line = 0; line < geometry.size(); ++line) {
+        const std::uint32_t count = geometry.point_count[line];
+        if (count < 2) continue;
+        builder.add_edge();
+        const float* pt = geometry.route(line);
+        for (std::uint32_t k = 0; k + 1 < count; ++k)
+            builder.add_segment(pt[2 * k], pt[2 * k + 1], pt[2 * k + 2], pt[2 * k + 3]);
+    }
+    return builder.finish();
+}
+
+LayoutMetrics compute_layout_metrics(const PlacedDiagram& placed) {
+    MetricsBuilder builder;
+    for (const auto& node : placed.placed_nodes)
+        builder.add_rect(node.rect);
+    for (const auto& edge : placed.placed_edges) {
+        if (edge.points.size() < 2) continue;
+        builder.add_edge();
+        for (std::size_t k = 0; k + 1 < edge.points.size(); ++k)
+            builder.add_segment(edge.points[k].first, edge.points[k].second,
+                edge.points[k + 1].first, edge.points[k + 1].second);
+    }
+    return builder.finish();
+}
+
+} // namespace diagram_placement
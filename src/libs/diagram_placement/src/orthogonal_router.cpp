@@ -0,0 +1,476 @@
+#include <diagram_placement/orthogonal_router.hpp>
+#include <diagram_placement/worker_pool.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace diagram_placement {
+
+namespace {
+
+constexpr double kEps = 1e-3;
+constexpr std::size_t kMaxExpansions = 200000;
+constexpr std::size_t kMaxStates = std::size_t{ 1 } << 22; // ~100 MB of scratch per thread at most
+
+// Headings: 0 = +x, 1 = -x, 2 = +y, 3 = -y.
+constexpr int kDx[4] = { 1, -1, 0, 0 };
+constexpr int kDy[4] = { 0, 0, 1, -1 };
+
+bool is_horizontal(int heading) { return heading < 2; }
+
+struct Port {
+    double x, y;
+    int heading; // start: direction leaving the block; end: direction of travel into the block
+};
+
+struct PortPair {
+    Port start;
+    Port end;
+};
+
+// Same anchors as route_connection_lines, plus the side each anchor sits on.
+PortPair line_ports(ConnectionKind kind, const Rect& from, const Rect& to) {
+    const double fcx = from.x + from.width * 0.5, fcy = from.y + from.height * 0.5;
+    const double tcx = to.x + to.width * 0.5, tcy = to.y + to.height * 0.5;
+    if (kind != ConnectionKind::Composition) {
+        // Child top-center up to parent bottom-center (entered travelling upwards).
+        return { { fcx, from.y, 3 }, { tcx, to.y + to.height, 3 } };
+    }
+    const PortPair candidates[4] = {
+        { { from.x + from.width, fcy, 0 }, { to.x, tcy, 0 } },
+        { { from.x, fcy, 1 }, { to.x + to.width, tcy, 1 } },
+        { { fcx, from.y + from.height, 2 }, { tcx, to.y, 2 } },
+        { { fcx, from.y, 3 }, { tcx, to.y + to.height, 3 } },
+    };
+    const PortPair* best = &candidates[0];
+    double best_d = std::numeric_limits<double>::max();
+    for (const auto& c : candidates) {
+        const double dx = c.end.x - c.start.x;
+        const double dy = c.end.y - c.start.y;
+        const double d = dx * dx + dy * dy;
+        if (d < best_d) {
+            best_d = d;
+            best = &c;
+        }
+    }
+    return *best;
+}
+
+Rect inflate(const Rect& r, double m) {
+    return Rect{ r.x - m, r.y - m, r.width + 2.0 * m, r.height + 2.0 * m };
+}
+
+Rect bounds_of(double x0, double y0, double x1, double y1) {
+    return Rect{ std::min(x0, x1), std::min(y0, y1), std::abs(x1 - x0), std::abs(y1 - y0) };
+}
+
+Rect unite(const Rect& a, const Rect& b) {
+    const double x0 = std::min(a.x, b.x), y0 = std::min(a.y, b.y);
+    const double x1 = std::max(a.x + a.width, b.x + b.width);
+    const double y1 = std::max(a.y + a.height, b.y + b.height);
+    return Rect{ x0, y0, x1 - x0, y1 - y0 };
+}
+
+bool same_rect(const Rect& a, const Rect& b) {
+    return std::abs(a.x - b.x) < kEps && std::abs(a.y - b.y) < kEps
+        && std::abs(a.width - b.width) < kEps && std::abs(a.height - b.height) < kEps;
+}
+
+// Per-thread search buffers, reused across lines and frames. Per-state entries are valid only
+// when their stamp equals the current search, so nothing is cleared between searches.
+struct SearchState {
+    double g;
+    std::uint32_t parent;
+    std::uint32_t stamp;
+    bool closed;
+};
+
+struct Scratch {
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<SearchState> states;
+    std::vector<std::uint32_t> node_stamp;  // node_blocked valid for this search
+    std::vector<std::uint8_t> node_blocked;
+    std::vector<std::pair<double, std::uint32_t>> heap;
+    std::vector<std::uint32_t> path;
+    std::uint32_t stamp = 0;
+};
+
+thread_local Scratch t_scratch;
+
+void sort_unique(std::vector<double>& v) {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end(), [](double a, double b) { return std::abs(a - b) < kEps; }), v.end());
+}
+
+int index_of(const std::vector<double>& v, double value) {
+    const auto it = std::lower_bound(v.begin(), v.end(), value - kEps);
+    return static_cast<int>(it - v.begin());
+}
+
+void push_point(std::vector<float>& pts, double x, double y) {
+    // Drop duplicates and merge collinear runs as points are appended.
+    const std::size_t n = pts.size() / 2u;
+    const float fx = static_cast<float>(x), fy = static_cast<float>(y);
+    if (n >= 1 && pts[2 * n - 2] == fx && pts[2 * n - 1] == fy) return;
+    if (n >= 2) {
+        const float ax = pts[2 * n - 4], ay = pts[2 * n - 3];
+        const float bx = pts[2 * n - 2], by = pts[2 * n - 1];
+        if ((ax == bx && bx == fx) || (ay == by && by == fy)) {
+            pts[2 * n - 2] = fx;
+            pts[2 * n - 1] = fy;
+            return;
+        }
+    }
+    pts.push_back(fx);
+    pts.push_back(fy);
+}
+
+// Fallback: the simple single-bend route of route_connection_lines.
+void simple_route(ConnectionKind kind, const PortPair& p, std::vector<float>& out) {
+    out.clear();
+    push_point(out, p.start.x, p.start.y);
+    if (kind != ConnectionKind::Composition) {
+        const double mid_y = (p.start.y + p.end.y) * 0.5;
+        if (std::abs(p.end.x - p.start.x) > 5.0) {
+            push_point(out, p.start.x, mid_y);
+            push_point(out, p.end.x, mid_y);
+        }
+    } else if (std::abs(p.end.x - p.start.x) > std::abs(p.end.y - p.start.y)) {
+        const double mid_x = (p.start.x + p.end.x) * 0.5;
+        push_point(out, mid_x, p.start.y);
+        push_point(out, mid_x, p.end.y);
+    } else {
+        const double mid_y = (p.start.y + p.end.y) * 0.5;
+        push_point(out, p.start.x, mid_y);
+        push_point(out, p.end.x, mid_y);
+    }
+    push_point(out, p.end.x, p.end.y);
+}
+
+// A* over the orthogonal visibility graph spanned by the obstacle edges inside `area`.
+// Nodes and edges are tested lazily against the obstacle grid, so only the explored part of the
+// graph is ever touched. Returns false when no path exists or a budget is exhausted.
+bool astar_route(const SpatialGrid& obstacles, const Rect& area, const PortPair& ports,
+    double margin, double bend_penalty, std::size_t max_obstacles, std::vector<float>& out)
+{
+    Scratch& s = t_scratch;
+    const double sx = ports.start.x + kDx[ports.start.heading] * margin;
+    const double sy = ports.start.y + kDy[ports.start.heading] * margin;
+    const double ex = ports.end.x - kDx[ports.end.heading] * margin;
+    const double ey = ports.end.y - kDy[ports.end.heading] * margin;
+
+    // Interesting coordinates: ports, area bounds and obstacle edges clipped to the area.
+    const double ax1 = area.x + area.width, ay1 = area.y + area.height;
+    s.xs.assign({ sx, ex, area.x, ax1 });
+    s.ys.assign({ sy, ey, area.y, ay1 });
+    std::size_t obstacle_count = 0;
+    obstacles.query(area, [&](std::uint32_t item) {
+        const Rect& r = obstacles.rect(item);
+        s.xs.push_back(std::clamp(r.x, area.x, ax1));
+        s.xs.push_back(std::clamp(r.x + r.width, area.x, ax1));
+        s.ys.push_back(std::clamp(r.y, area.y, ay1));
+        s.ys.push_back(std::clamp(r.y + r.height, area.y, ay1));
+        ++obstacle_count;
+    });
+    if (obstacle_count > max_obstacles) return false;
+    sort_unique(s.xs);
+    sort_unique(s.ys);
+    const int nx = static_cast<int>(s.xs.size());
+    const int ny = static_cast<int>(s.ys.size());
+
+    // A point is blocked when it lies strictly inside an inflated block; the boundary stays
+    // walkable. Since every obstacle edge is a grid coordinate, an edge between neighbouring
+    // nodes is blocked exactly when its midpoint is.
+    auto blocked = [&](double x, double y) {
+        bool inside = false;
+        obstacles.query_point(x, y, [&](std::uint32_t item) {
+            const Rect& r = obstacles.rect(item);
+            if (x > r.x + kEps && x < r.x + r.width - kEps && y > r.y + kEps && y < r.y + r.height - kEps)
+                inside = true;
+        });
+        return inside;
+    };
+
+    const std::size_t nodes = static_cast<std::size_t>(nx) * static_cast<std::size_t>(ny);
+    if (nodes * 4u > kMaxStates) return false;
+    if (s.states.size() < nodes * 4u) s.states.resize(nodes * 4u, SearchState{ 0.0, 0, 0, false });
+    if (s.node_stamp.size() < nodes) {
+        s.node_stamp.resize(nodes, 0);
+        s.node_blocked.resize(nodes, 0);
+    }
+    if (++s.stamp == 0) {
+        // Stamp wrapped: invalidate everything once.
+        std::fill(s.node_stamp.begin(), s.node_stamp.end(), 0u);
+        for (auto& st : s.states) st.stamp = 0;
+        s.stamp = 1;
+    }
+    const std::uint32_t stamp = s.stamp;
+    auto node_blocked = [&](int i, int j) {
+        const std::size_t n = static_cast<std::size_t>(j) * nx + i;
+        if (s.node_stamp[n] != stamp) {
+            s.node_stamp[n] = stamp;
+            s.node_blocked[n] = blocked(s.xs[i], s.ys[j]) ? 1 : 0;
+        }
+        return s.node_blocked[n] != 0;
+    };
+
+    const int si = index_of(s.xs, sx), sj = index_of(s.ys, sy);
+    const int ei = index_of(s.xs, ex), ej = index_of(s.ys, ey);
+    auto state_of = [nx](int i, int j, int heading) {
+        return static_cast<std::uint32_t>((j * nx + i) * 4 + heading);
+    };
+    auto heuristic = [&](int i, int j, int heading) {
+        return std::abs(s.xs[i] - ex) + std::abs(s.ys[j] - ey) + (heading != ports.end.heading ? bend_penalty : 0.0);
+    };
+
+    s.heap.clear();
+    auto push = [&](int i, int j, int heading, double g, std::uint32_t from) {
+        SearchState& st = s.states[state_of(i, j, heading)];
+        if (st.stamp == stamp) {
+            if (st.closed || g >= st.g) return;
+        } else {
+            st.stamp = stamp;
+            st.closed = false;
+        }
+        st.g = g;
+        st.parent = from;
+        // Max-heap on -f; ties prefer the deeper state (larger g) to cut plateau expansions.
+        s.heap.emplace_back(-(g + heuristic(i, j, heading)) + g * 1e-9, state_of(i, j, heading));
+        std::push_heap(s.heap.begin(), s.heap.end());
+    };
+
+    constexpr std::uint32_t kNoParent = ~std::uint32_t{ 0 };
+    const std::uint32_t goal = state_of(ei, ej, ports.end.heading);
+    push(si, sj, ports.start.heading, 0.0, kNoParent);
+    std::size_t expansions = 0;
+    bool found = false;
+    while (!s.heap.empty()) {
+        std::pop_heap(s.heap.begin(), s.heap.end());
+        const std::uint32_t state = s.heap.back().second;
+        s.heap.pop_back();
+        SearchState& st = s.states[state];
+        if (st.closed) continue; // stale entry
+        st.closed = true;
+        if (state == goal) {
+            found = true;
+            break;
+        }
+        if (++expansions > kMaxExpansions) return false;
+
+        const double g = st.g;
+        const int heading = static_cast<int>(state % 4u);
+        const int i = static_cast<int>((state / 4u) % static_cast<std::uint32_t>(nx));
+        const int j = static_cast<int>((state / 4u) / static_cast<std::uint32_t>(nx));
+
+        // Turn in place (a bend); never reverse.
+        for (int h = 0; h < 4; ++h) {
+            if (is_horizontal(h) == is_horizontal(heading)) continue;
+            push(i, j, h, g + bend_penalty, state);
+        }
+
+        // Move to the neighbouring node along the heading. Ports may sit inside an
+        // overlapping block, so the end node is allowed even when buried.
+        const int ni = i + kDx[heading], nj = j + kDy[heading];
+        if (ni < 0 || nj < 0 || ni >= nx || nj >= ny) continue;
+        const bool is_end = ni == ei && nj == ej;
+        if (!is_end && node_blocked(ni, nj)) continue;
+        if (blocked((s.xs[i] + s.xs[ni]) * 0.5, (s.ys[j] + s.ys[nj]) * 0.5)) continue;
+        const double len = std::abs(s.xs[ni] - s.xs[i]) + std::abs(s.ys[nj] - s.ys[j]);
+        push(ni, nj, heading, g + len, state);
+    }
+    if (!found) return false;
+
+    s.path.clear();
+    for (std::uint32_t state = goal; state != kNoParent; state = s.states[state].parent)
+        s.path.push_back(state / 4u);
+
+    out.clear();
+    push_point(out, ports.start.x, ports.start.y);
+    for (auto it = s.path.rbegin(); it != s.path.rend(); ++it) {
+        const auto node = static_cast<std::size_t>(*it);
+        push_point(out, s.xs[node % static_cast<std::size_t>(nx)], s.ys[node / static_cast<std::size_t>(nx)]);
+    }
+    push_point(out, ports.end.x, ports.end.y);
+    return true;
+}
+
+} // namespace
+
+void OrthogonalRouter::set_options(const OrthogonalRouterOptions& options) {
+    options_ = options;
+    reset();
+}
+
+void OrthogonalRouter::reset() {
+    routes_.clear();
+    routed_from_.clear();
+    routed_to_.clear();
+    previous_rects_.clear();
+    previous_valid_.clear();
+}
+
+void OrthogonalRouter::route_line(const PlacedClassDiagram& placed, const ConnectionGeometry& geometry,
+    std::size_t line)
+{
+    CachedRoute& cached = routes_[line];
+    cached.points.clear();
+    cached.corridor = Rect{ 0.0, 0.0, -1.0, -1.0 };
+
+    const std::uint32_t fb = geometry.class_block[geometry.from_class[line]];
+    const std::uint32_t tb = geometry.class_block[geometry.to_class[line]];
+    if (fb == ConnectionGeometry::npos || tb == ConnectionGeometry::npos) return;
+
+    const Rect& from = placed.blocks[fb].rect;
+    const Rect& to = placed.blocks[tb].rect;
+    const PortPair ports = line_ports(geometry.kind[line], from, to);
+    const double m = options_.obstacle_margin;
+
+    const Rect area = inflate(bounds_of(ports.start.x, ports.start.y, ports.end.x, ports.end.y),
+        options_.corridor_margin);
+    if (!astar_route(obstacles_, area, ports, m, options_.bend_penalty, options_.max_obstacles, cached.points))
+        simple_route(geometry.kind[line], ports, cached.points);
+
+    Rect corridor = unite(area, unite(from, to));
+    for (std::size_t i = 0; i + 1 < cached.points.size(); i += 2) {
+        const Rect p{ cached.points[i], cached.points[i + 1], 0.0, 0.0 };
+        corridor = unite(corridor, inflate(p, m));
+    }
+    cached.corridor = corridor;
+}
+
+void OrthogonalRouter::route(const PlacedClassDiagram& placed, ConnectionGeometry& geometry) {
+    map_class_blocks(placed, geometry);
+    const std::size_t lines = geometry.size();
+    const std::size_t classes = geometry.class_block.size();
+
+    // Topology changed: drop the cache.
+    bool full = routes_.size() != lines;
+    for (std::size_t i = 0; !full && i < lines; ++i)
+        full = routed_from_[i] != geometry.from_class[i] || routed_to_[i] != geometry.to_class[i];
+    if (full) {
+        reset();
+        routes_.resize(lines);
+        routed_from_ = geometry.from_class;
+        routed_to_ = geometry.to_class;
+    }
+
+    // Diff block rects against the previous call.
+    previous_rects_.resize(classes);
+    previous_valid_.resize(classes, 0);
+    moved_class_.assign(classes, 0);
+    moved_.clear();
+    for (std::size_t ci = 0; ci < classes; ++ci) {
+        const std::uint32_t bi = geometry.class_block[ci];
+        const bool valid = bi != ConnectionGeometry::npos;
+        if (!valid && !previous_valid_[ci]) continue;
+        if (valid && previous_valid_[ci] && same_rect(previous_rects_[ci], placed.blocks[bi].rect)) continue;
+        moved_class_[ci] = 1;
+        if (previous_valid_[ci]) moved_.push_back(previous_rects_[ci]);
+        if (valid) {
+            moved_.push_back(placed.blocks[bi].rect);
+            previous_rects_[ci] = placed.blocks[bi].rect;
+        }
+        previous_valid_[ci] = valid ? 1 : 0;
+    }
+
+    if (full || !moved_.empty()) {
+        obstacle_rects_.clear();
+        for (const auto& b : placed.blocks)
+            obstacle_rects_.push_back(inflate(b.rect, options_.obstacle_margin));
+        obstacles_.build(obstacle_rects_);
+    }
+
+    dirty_.clear();
+    if (full) {
+        for (std::size_t i = 0; i < lines; ++i)
+            dirty_.push_back(static_cast<std::uint32_t>(i));
+    } else if (!moved_.empty()) {
+        moved_index_.build(moved_);
+        for (std::size_t i = 0; i < lines; ++i) {
+            bool dirty = moved_class_[geometry.from_class[i]] || moved_class_[geometry.to_class[i]];
+            if (!dirty && routes_[i].corridor.width >= 0.0)
+                moved_index_.query(routes_[i].corridor, [&](std::uint32_t) { dirty = true; });
+            if (dirty) dirty_.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    last_rerouted_ = dirty_.size();
+
+    if (!dirty_.empty()) {
+        auto work = [&](std::size_t begin, std::size_t end, unsigned) {
+            for (std::size_t k = begin; k < end; ++k)
+                route_line(placed, geometry, dirty_[k]);
+        };
+        if (options_.parallel)
+            WorkerPool::shared().parallel_for(dirty_.size(), 16, work);
+        else
+            work(0, dirty_.size(), 0);
+    }
+
+    geometry.points.clear();
+    for (std::size_t i = 0; i < lines; ++i) {
+        geometry.point_offset[i] = static_cast<std::uint32_t>(geometry.points.size() / 2u);
+        geometry.points.insert(geometry.points.end(), routes_[i].points.begin(), routes_[i].points.end());
+        geometry.point_count[i] = static_cast<std::uint32_t>(routes_[i].points.size() / 2u);
+    }
+    separate_channels(geometry);
+}
+
+void OrthogonalRouter::separate_channels(ConnectionGeometry& geometry) {
+    // Interior segments only: the first and last segment are pinned to the block anchors.
+    segments_.clear();
+    for (std::size_t li = 0; li < geometry.size(); ++li) {
+        const std::uint32_t count = geometry.point_count[li];
+        const std::uint32_t base = geometry.point_offset[li];
+        for (std::uint32_t k = 1; k + 2 < count; ++k) {
+            const float* a = &geometry.points[2u * (base + k)];
+            const float* b = a + 2;
+            const bool horizontal = a[1] == b[1];
+            if (!horizontal && a[0] != b[0]) continue;
+            const float lo = horizontal ? std::min(a[0], b[0]) : std::min(a[1], b[1]);
+            const float hi = horizontal ? std::max(a[0], b[0]) : std::max(a[1], b[1]);
+            segments_.push_back({ horizontal, horizontal ? a[1] : a[0], lo, hi, base + k, 0 });
+        }
+    }
+    std::sort(segments_.begin(), segments_.end(), [](const ChannelSegment& a, const ChannelSegment& b) {
+        if (a.horizontal != b.horizontal) return a.horizontal < b.horizontal;
+        if (a.coord != b.coord) return a.coord < b.coord;
+        return a.lo < b.lo;
+    });
+
+    // Within a channel (same orientation and coordinate), overlapping segments form clusters;
+    // greedy interval colouring gives each segment a track, tracks are centred on the channel.
+    std::size_t i = 0;
+    while (i < segments_.size()) {
+        std::size_t j = i;
+        float cluster_hi = segments_[i].hi;
+        track_end_.clear();
+        while (j < segments_.size() && segments_[j].horizontal == segments_[i].horizontal
+            && segments_[j].coord == segments_[i].coord && (j == i || segments_[j].lo < cluster_hi))
+        {
+            ChannelSegment& seg = segments_[j];
+            std::size_t t = 0;
+            while (t < track_end_.size() && track_end_[t] > seg.lo) ++t;
+            if (t == track_end_.size()) track_end_.push_back(seg.hi);
+            else track_end_[t] = seg.hi;
+            seg.track = static_cast<int>(t);
+            cluster_hi = std::max(cluster_hi, seg.hi);
+            ++j;
+        }
+        if (track_end_.size() > 1) {
+            // Keep the outermost tracks inside the clearance so no segment is pushed into a block.
+            const float centre = static_cast<float>(track_end_.size() - 1) * 0.5f;
+            const float spacing = std::min(static_cast<float>(options_.channel_spacing),
+                static_cast<float>(options_.obstacle_margin) * 0.8f / centre);
+            for (std::size_t k = i; k < j; ++k) {
+                const float shift = (static_cast<float>(segments_[k].track) - centre) * spacing;
+                const std::size_t axis = segments_[k].horizontal ? 1u : 0u;
+                geometry.points[2u * segments_[k].first_point + axis] += shift;
+                geometry.points[2u * (segments_[k].first_point + 1u) + axis] += shift;
+            }
+        }
+        i = j;
+    }
+}
+
+} // namespace diagram_placement
@@ -1,5 +1,6 @@
 #include <diagram_placement/physics_layout.hpp>
 #include <diagram_placement/class_diagram_layout_constants.hpp>
+#include <profiling/trace.hpp>
 #include <algorithm>
 #include <cmath>
 #include <map>
@@ -58,6 +59,7 @@ void PhysicsLayout::collect_current_positions(std::unordered_map<std::string, Re
 
 void PhysicsLayout::build_world(const std::unordered_map<std::string, Rect>* previous_positions) {
     if (!diagram_) return;
+    profiling::TraceScope trace("build_world", "physics");
 
     destroy_world();
 
@@ -351,6 +353,7 @@ void PhysicsLayout::build(const diagram_model::ClassDiagram& diagram,
     }
 
     build_world(previous_positions.empty() ? nullptr : &previous_positions);
+    ++generation_;
 }
 
 void PhysicsLayout::update_block_size(const std::string& id, double w, double h, bool expanded) {
@@ -392,6 +395,7 @@ void PhysicsLayout::update_block_size(const std::string& id, double w, double h,
     b2Body_SetLinearVelocity(state.body_id, b2Vec2{0.0f, 0.0f});
 
     state.expanded = expanded;
+    ++generation_;
     request_settle();
 }
 
@@ -458,7 +462,11 @@ void PhysicsLayout::step(float dt) {
         }
     }
 
-    b2World_Step(world_id_, clamped_dt, 4);
+    {
+        profiling::TraceScope trace("b2World_Step", "physics");
+        b2World_Step(world_id_, clamped_dt, 4);
+    }
+    ++generation_;
 
     if (!dragged_id_.empty() || !active_anims_.empty()) {
         return;
@@ -473,10 +481,12 @@ void PhysicsLayout::step(float dt) {
 }
 
 PlacedClassDiagram PhysicsLayout::get_placed() const {
+    profiling::TraceScope trace("get_placed", "physics");
     PlacedClassDiagram placed;
     if (!diagram_) return placed;
 
-    for (const auto& cls : diagram_->classes) {
+    for (std::size_t i = 0; i < diagram_->classes.size(); ++i) {
+        const auto& cls = diagram_->classes[i];
         auto it = blocks_.find(cls.id);
         if (it == blocks_.end()) continue;
         const auto& state = it->second;
@@ -485,6 +495,7 @@ PlacedClassDiagram PhysicsLayout::get_placed() const {
 
         PlacedClassBlock block;
         block.class_id = cls.id;
+        block.class_index = i;
         block.rect.width = state.rect.width;
         block.rect.height = state.rect.height;
         block.rect.x = static_cast<double>(p.x) - block.rect.width * 0.5;
@@ -532,6 +543,10 @@ void PhysicsLayout::end_drag(const std::string& id) {
     request_settle();
 }
 
+int PhysicsLayout::awake_body_count() const {
+    return b2World_IsValid(world_id_) ? b2World_GetAwakeBodyCount(world_id_) : 0;
+}
+
 bool PhysicsLayout::is_settled() const {
     if (!b2World_IsValid(world_id_)) return true;
     if (!active_anims_.empty()) return false;
@@ -559,7 +574,9 @@ void PhysicsLayout::request_settle() {
 
 void PhysicsLayout::warmup_settle(int steps) {
     if (!b2World_IsValid(world_id_)) return;
+    profiling::TraceScope trace("warmup_settle", "physics");
     for (int i = 0; i < steps; ++i) {
+        profiling::TraceScope step_trace("b2World_Step", "physics");
         b2World_Step(world_id_, 1.0f / 90.0f, 8);
     }
 }
@@ -0,0 +1,198 @@
+#include <diagram_placement/rect_batch.hpp>
+#include "rect_batch_kernels.hpp"
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DIAGRAM_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(DIAGRAM_HAVE_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace diagram_placement {
+
+namespace {
+
+using detail::RectQuery;
+
+std::uint32_t overlap_mask8_scalar(const double* left, const double* top,
+    const double* right, const double* bottom, const RectQuery& q)
+{
+    std::uint32_t mask = 0;
+    for (int k = 0; k < 8; ++k) {
+        const bool hit = q.inclusive
+            ? (q.right_gap >= left[k] && right[k] + q.gap >= q.left
+                && q.bottom_gap >= top[k] && bottom[k] + q.gap >= q.top)
+            : (q.right_gap > left[k] && right[k] + q.gap > q.left
+                && q.bottom_gap > top[k] && bottom[k] + q.gap > q.top);
+        mask |= static_cast<std::uint32_t>(hit) << k;
+    }
+    return mask;
+}
+
+#ifdef DIAGRAM_HAVE_SSE2
+std::uint32_t overlap_mask8_sse2(const double* left, const double* top,
+    const double* right, const double* bottom, const RectQuery& q)
+{
+    const __m128d q_left = _mm_set1_pd(q.left);
+    const __m128d q_top = _mm_set1_pd(q.top);
+    const __m128d q_right = _mm_set1_pd(q.right_gap);
+    const __m128d q_bottom = _mm_set1_pd(q.bottom_gap);
+    const __m128d gap = _mm_set1_pd(q.gap);
+    std::uint32_t mask = 0;
+    for (int k = 0; k < 8; k += 2) {
+        const __m128d l = _mm_loadu_pd(left + k);
+        const __m128d t = _mm_loadu_pd(top + k);
+        const __m128d r = _mm_add_pd(_mm_loadu_pd(right + k), gap);
+        const __m128d b = _mm_add_pd(_mm_loadu_pd(bottom + k), gap);
+        __m128d hit;
+        if (q.inclusive) {
+            hit = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(q_right, l), _mm_cmpge_pd(r, q_left)),
+                _mm_and_pd(_mm_cmpge_pd(q_bottom, t), _mm_cmpge_pd(b, q_top)));
+        } else {
+            hit = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(q_right, l), _mm_cmpgt_pd(r, q_left)),
+                _mm_and_pd(_mm_cmpgt_pd(q_bottom, t), _mm_cmpgt_pd(b, q_top)));
+        }
+        mask |= static_cast<std::uint32_t>(_mm_movemask_pd(hit)) << k;
+    }
+    return mask;
+}
+#endif
+
+bool cpu_has_avx2() {
+#if defined(DIAGRAM_HAVE_AVX2) && defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS saves XMM and YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(DIAGRAM_HAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool isa_available(RectBatchIsa isa) {
+    switch (isa) {
+    case RectBatchIsa::Scalar: return true;
+#ifdef DIAGRAM_HAVE_SSE2
+    case RectBatchIsa::Sse2: return true;
+#endif
+#ifdef DIAGRAM_HAVE_AVX2
+    case RectBatchIsa::Avx2: return cpu_has_avx2();
+#endif
+    default: return false;
+    }
+}
+
+detail::OverlapMask8Fn kernel_for(RectBatchIsa isa) {
+    switch (isa) {
+#ifdef DIAGRAM_HAVE_AVX2
+    case RectBatchIsa::Avx2: return &detail::overlap_mask8_avx2;
+#endif
+#ifdef DIAGRAM_HAVE_SSE2
+    case RectBatchIsa::Sse2: return &overlap_mask8_sse2;
+#endif
+    default: return &overlap_mask8_scalar;
+    }
+}
+
+RectBatchIsa best_isa() {
+    if (isa_available(RectBatchIsa::Avx2)) return RectBatchIsa::Avx2;
+    if (isa_available(RectBatchIsa::Sse2)) return RectBatchIsa::Sse2;
+    return RectBatchIsa::Scalar;
+}
+
+struct Dispatch {
+    RectBatchIsa isa = best_isa();
+    detail::OverlapMask8Fn fn = kernel_for(isa);
+};
+
+Dispatch& dispatch() {
+    static Dispatch d;
+    return d;
+}
+
+// Padding lanes: left = +inf, right = -inf never satisfy the overlap comparisons.
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+RectBatchIsa rect_batch_isa() {
+    return dispatch().isa;
+}
+
+const char* rect_batch_isa_name(RectBatchIsa isa) {
+    switch (isa) {
+    case RectBatchIsa::Avx2: return "avx2";
+    case RectBatchIsa::Sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+bool set_rect_batch_isa(RectBatchIsa isa) {
+    if (!isa_available(isa)) return false;
+    dispatch().isa = isa;
+    dispatch().fn = kernel_for(isa);
+    return true;
+}
+
+void RectBatch::clear() {
+    left_.clear();
+    top_.clear();
+    right_.clear();
+    bottom_.clear();
+    size_ = 0;
+}
+
+void RectBatch::reserve(std::size_t count) {
+    const std::size_t padded = (count + lanes - 1) & ~(lanes - 1);
+    left_.reserve(padded);
+    top_.reserve(padded);
+    right_.reserve(padded);
+    bottom_.reserve(padded);
+}
+
+void RectBatch::push_back(double left, double top, double right, double bottom) {
+    if (size_ == left_.size()) {
+        left_.resize(size_ + lanes, kInf);
+        top_.resize(size_ + lanes, kInf);
+        right_.resize(size_ + lanes, -kInf);
+        bottom_.resize(size_ + lanes, -kInf);
+    }
+    set(size_++, left, top, right, bottom);
+}
+
+void RectBatch::set(std::size_t i, double left, double top, double right, double bottom) {
+    left_[i] = left;
+    top_[i] = top;
+    right_[i] = right;
+    bottom_[i] = bottom;
+}
+
+std::uint32_t RectBatch::overlap_mask8(std::size_t first, double left, double top, double right, double bottom,
+    double gap, bool inclusive) const
+{
+    const RectQuery q{ left, top, right + gap, bottom + gap, gap, inclusive };
+    return dispatch().fn(left_.data() + first, top_.data() + first,
+        right_.data() + first, bottom_.data() + first, q);
+}
+
+std::size_t RectBatch::find_first_overlap(double left, double top, double right, double bottom, std::size_t begin,
+    double gap, bool inclusive) const
+{
+    for (std::size_t base = begin & ~(lanes - 1); base < size_; base += lanes) {
+        std::uint32_t mask = overlap_mask8(base, left, top, right, bottom, gap, inclusive);
+        if (base < begin) mask &= ~0u << (begin - base);
+        if (mask) return base + static_cast<std::size_t>(std::countr_zero(mask));
+    }
+    return npos;
+}
+
+} // namespace diagram_placement
@@ -0,0 +1,37 @@
+// Built with AVX2 code generation (see DIAGRAM_ENABLE_AVX2 in CMakeLists.txt); the dispatcher
+// in rect_batch.cpp only calls into this file after checking the CPU.
+#include "rect_batch_kernels.hpp"
+#include <immintrin.h>
+
+namespace diagram_placement::detail {
+
+std::uint32_t overlap_mask8_avx2(const double* left, const double* top,
+    const double* right, const double* bottom, const RectQuery& q)
+{
+    const __m256d q_left = _mm256_set1_pd(q.left);
+    const __m256d q_top = _mm256_set1_pd(q.top);
+    const __m256d q_right = _mm256_set1_pd(q.right_gap);
+    const __m256d q_bottom = _mm256_set1_pd(q.bottom_gap);
+    const __m256d gap = _mm256_set1_pd(q.gap);
+    std::uint32_t mask = 0;
+    for (int k = 0; k < 8; k += 4) {
+        const __m256d l = _mm256_loadu_pd(left + k);
+        const __m256d t = _mm256_loadu_pd(top + k);
+        const __m256d r = _mm256_add_pd(_mm256_loadu_pd(right + k), gap);
+        const __m256d b = _mm256_add_pd(_mm256_loadu_pd(bottom + k), gap);
+        __m256d hit;
+        if (q.inclusive) {
+            hit = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(q_right, l, _CMP_GE_OQ), _mm256_cmp_pd(r, q_left, _CMP_GE_OQ)),
+                _mm256_and_pd(_mm256_cmp_pd(q_bottom, t, _CMP_GE_OQ), _mm256_cmp_pd(b, q_top, _CMP_GE_OQ)));
+        } else {
+            hit = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(q_right, l, _CMP_GT_OQ), _mm256_cmp_pd(r, q_left, _CMP_GT_OQ)),
+                _mm256_and_pd(_mm256_cmp_pd(q_bottom, t, _CMP_GT_OQ), _mm256_cmp_pd(b, q_top, _CMP_GT_OQ)));
+        }
+        mask |= static_cast<std::uint32_t>(_mm256_movemask_pd(hit)) << k;
+    }
+    return mask;
+}
+
+} // namespace diagram_placement::detail
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace diagram_placement::detail {
+
+// Query edges with the gap already added where the scalar expression adds it.
+struct RectQuery {
+    double left;
+    double top;
+    double right_gap;   // right + gap
+    double bottom_gap;  // bottom + gap
+    double gap;
+    bool inclusive;
+};
+
+// Overlap bits for 8 consecutive rects given by their edge arrays.
+using OverlapMask8Fn = std::uint32_t (*)(const double* left, const double* top,
+    const double* right, const double* bottom, const RectQuery& q);
+
+#ifdef DIAGRAM_HAVE_AVX2
+// Compiled in its own translation unit with AVX2 enabled; only called after a CPU check.
+std::uint32_t overlap_mask8_avx2(const double* left, const double* top,
+    const double* right, const double* bottom, const RectQuery& q);
+#endif
+
+} // namespace diagram_placement::detail
@@ -0,0 +1,77 @@
+#include <diagram_placement/spatial_grid.hpp>
+#include <limits>
+
+namespace diagram_placement {
+
+void SpatialGrid::clear() {
+    rects_.clear();
+    cell_start_.clear();
+    items_.clear();
+    cols_ = 0;
+    rows_ = 0;
+}
+
+void SpatialGrid::build(const std::vector<Rect>& rects, double cell_size) {
+    rects_ = rects;
+    items_.clear();
+    if (rects_.empty()) {
+        cell_start_.assign(1, 0);
+        cols_ = 0;
+        rows_ = 0;
+        return;
+    }
+
+    double min_x = std::numeric_limits<double>::max();
+    double min_y = std::numeric_limits<double>::max();
+    double max_x = std::numeric_limits<double>::lowest();
+    double max_y = std::numeric_limits<double>::lowest();
+    double extent_sum = 0.0;
+    for (const auto& r : rects_) {
+        min_x = std::min(min_x, r.x);
+        min_y = std::min(min_y, r.y);
+        max_x = std::max(max_x, r.x + r.width);
+        max_y = std::max(max_y, r.y + r.height);
+        extent_sum += std::max(r.width, r.height);
+    }
+
+    const double span_x = std::max(max_x - min_x, 1.0);
+    const double span_y = std::max(max_y - min_y, 1.0);
+    if (cell_size <= 0.0)
+        cell_size = std::max(extent_sum / static_cast<double>(rects_.size()), 1.0);
+    // Keep the cell count proportional to the item count.
+    const double max_cells = 4.0 * static_cast<double>(rects_.size()) + 16.0;
+    while ((span_x / cell_size) * (span_y / cell_size) > max_cells)
+        cell_size *= 1.5;
+
+    cell_ = cell_size;
+    origin_x_ = min_x;
+    origin_y_ = min_y;
+    cols_ = static_cast<int>(span_x / cell_) + 1;
+    rows_ = static_cast<int>(span_y / cell_) + 1;
+
+    // Counting pass, prefix sum, fill pass (CSR).
+    const std::size_t cell_count = static_cast<std::size_t>(cols_) * rows_;
+    cell_start_.assign(cell_count + 1, 0);
+    for (const auto& r : rects_) {
+        const int c0 = col_of(r.x), c1 = col_of(r.x + r.width);
+        const int r0 = row_of(r.y), r1 = row_of(r.y + r.height);
+        for (int row = r0; row <= r1; ++row)
+            for (int col = c0; col <= c1; ++col)
+                ++cell_start_[static_cast<std::size_t>(row) * cols_ + col + 1];
+    }
+    for (std::size_t i = 0; i < cell_count; ++i)
+        cell_start_[i + 1] += cell_start_[i];
+
+    items_.resize(cell_start_[cell_count]);
+    std::vector<std::uint32_t> fill(cell_start_.begin(), cell_start_.end() - 1);
+    for (std::size_t i = 0; i < rects_.size(); ++i) {
+        const Rect& r = rects_[i];
+        const int c0 = col_of(r.x), c1 = col_of(r.x + r.width);
+        const int r0 = row_of(r.y), r1 = row_of(r.y + r.height);
+        for (int row = r0; row <= r1; ++row)
+            for (int col = c0; col <= c1; ++col)
+                items_[fill[static_cast<std::size_t>(row) * cols_ + col]++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+} // namespace diagram_placement
@@ -0,0 +1,133 @@
+#include <diagram_placement/worker_pool.hpp>
+#include <profiling/trace.hpp>
+#include <algorithm>
+#include <string>
+
+namespace diagram_placement {
+
+namespace {
+
+// Pool whose chunk the thread is running (workers: always their pool), and the worker id.
+thread_local const WorkerPool* t_pool = nullptr;
+thread_local unsigned t_worker = 0;
+
+} // namespace
+
+WorkerPool::WorkerPool(unsigned thread_count) {
+    if (thread_count == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        thread_count = hw > 1 ? hw - 1 : 0;
+    }
+    threads_.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; ++i)
+        threads_.emplace_back([this, i] { worker_main(i + 1); });
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_)
+        t.join();
+}
+
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool;
+    return pool;
+}
+
+void WorkerPool::run_chunks(const Job& job, unsigned worker) {
+    profiling::TraceScope trace("parallel_for", "worker");
+    // Workers count their allocations under the caller's phase.
+    profiling::ScopedAllocationPhase phase(job.phase);
+    for (;;) {
+        const std::size_t begin = next_.fetch_add(job.chunk, std::memory_order_relaxed);
+        if (begin >= job.count) break;
+        const std::size_t end = std::min(begin + job.chunk, job.count);
+        (*job.fn)(begin, end, worker);
+    }
+}
+
+void WorkerPool::worker_main(unsigned worker) {
+    profiling::set_trace_thread_name("worker " + std::to_string(worker));
+    t_pool = this;
+    t_worker = worker;
+    std::size_t seen_generation = 0;
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+            if (stop_) return;
+            seen_generation = generation_;
+            // A late wake-up after the job already finished finds no job to join.
+            if (!job_.fn) continue;
+            job = job_;
+            ++busy_;
+        }
+        run_chunks(job, worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busy_;
+        }
+        done_.notify_one();
+    }
+}
+
+void WorkerPool::parallel_for(std::size_t count, std::size_t min_chunk,
+    const std::function<void(std::size_t, std::size_t, unsigned)>& fn)
+{
+    if (count == 0) return;
+    // Nested call from a chunk of this pool: waiting for the workers would wait on ourselves.
+    if (t_pool == this) {
+        fn(0, count, t_worker);
+        return;
+    }
+    // Other threads wait for their turn: both would run chunks as worker 0.
+    std::lock_guard<std::mutex> call(call_mutex_);
+    // A chunk of another pool may call us; it must still know its own pool once we return.
+    struct InsidePool {
+        explicit InsidePool(const WorkerPool* pool) : outer_pool(t_pool), outer_worker(t_worker) {
+            t_pool = pool;
+            t_worker = 0;
+        }
+        ~InsidePool() {
+            t_pool = outer_pool;
+            t_worker = outer_worker;
+        }
+        const WorkerPool* outer_pool;
+        unsigned outer_worker;
+    } inside(this);
+    min_chunk = std::max<std::size_t>(min_chunk, 1);
+    if (threads_.empty() || count <= min_chunk) {
+        fn(0, count, 0);
+        return;
+    }
+
+    // Several chunks per thread so uneven items balance out.
+    const std::size_t target_chunks = static_cast<std::size_t>(concurrency()) * 4u;
+    Job job;
+    job.fn = &fn;
+    job.count = count;
+    job.chunk = std::max(min_chunk, (count + target_chunks - 1) / target_chunks);
+    job.phase = profiling::allocation_phase();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return busy_ == 0; });
+        job_ = job;
+        next_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    run_chunks(job, 0);
+
+    // Wait until every worker that joined has left the job before fn goes out of scope.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busy_ == 0; });
+    job_ = Job{};
+}
+
+} // namespace diagram_placement
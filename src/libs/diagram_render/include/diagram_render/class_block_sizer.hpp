@@ -0,0 +1,73 @@
+#pragma once
+
+#include <diagram_placement/types.hpp>
+#include <diagram_render/nested_expansion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace diagram_model {
+struct ClassDiagram;
+}
+
+namespace diagram_render {
+
+// Class block sizes kept between edits, so a toggle re-measures only the blocks it affects
+// instead of the whole diagram (compute_class_block_sizes).
+//
+// Every expanded block records the classes its content shows: its own class, the parent and
+// child classes named in its rows, and everything inside its expanded nested cards. Marking a
+// class changed re-measures its own block and every block that embeds it. Needs an active
+// ImGui context, like compute_class_block_sizes. The diagram must outlive the sizer or the
+// next reset().
+class ClassBlockSizer {
+public:
+    ClassBlockSizer();
+    ~ClassBlockSizer();
+
+    // Measures every class of `diagram` and rebuilds the dependency lists.
+    void reset(const diagram_model::ClassDiagram& diagram,
+        const std::unordered_map<std::string, bool>& expanded,
+        const NestedExpansion& nested_expanded);
+    void clear();
+
+    // The block of class_id was expanded/collapsed, or one of its nested cards was.
+    void mark_block_dirty(std::string_view class_id);
+    // The data of class_id changed: its block and every block embedding it are re-measured.
+    void mark_class_changed(std::string_view class_id);
+    void mark_all_dirty();
+
+    // Re-measures dirty blocks (all of them if the font or its size changed since the last pass).
+    // Returns the ids of blocks whose size changed; valid until the next call.
+    const std::vector<std::string>& update(const std::unordered_map<std::string, bool>& expanded,
+        const NestedExpansion& nested_expanded);
+
+    // class_id -> block size (x, y zero), same contents as compute_class_block_sizes.
+    const std::unordered_map<std::string, diagram_placement::Rect>& sizes() const { return sizes_; }
+    const diagram_placement::Rect* size_of(const std::string& class_id) const;
+
+    // Blocks measured by the last reset() or update().
+    std::size_t last_measured_count() const { return last_measured_; }
+
+private:
+    void mark_dirty(std::uint32_t block);
+    void set_deps(std::uint32_t block, std::vector<std::uint32_t>& deps);
+
+    const diagram_model::ClassDiagram* diagram_ = nullptr;
+    std::unordered_map<std::string_view, std::uint32_t> index_;
+    std::unordered_map<std::string, diagram_placement::Rect> sizes_;
+    std::vector<std::vector<std::uint32_t>> deps_;        // block -> classes its content shows
+    std::vector<std::vector<std::uint32_t>> dependents_;  // class -> expanded blocks showing it
+    std::vector<std::uint32_t> dirty_;
+    std::vector<char> is_dirty_;
+    std::vector<std::uint32_t> scratch_deps_;
+    std::vector<std::string> changed_;
+    const void* font_ = nullptr;
+    float font_size_ = 0.0f;
+    std::size_t last_measured_ = 0;
+};
+
+} // namespace diagram_render
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <diagram_render/nested_expansion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace diagram_model {
+struct ClassDiagram;
+}
+
+namespace diagram_render {
+
+namespace detail {
+class CardVertexCache;
+struct CardLayout;
+}
+
+// One preformatted card row: "type: name" or "type: name = default".
+// Widths are measured at the base font size, i.e. in world units; the renderer draws the text
+// at font size * zoom, so they scale with it.
+struct ClassRowText {
+    std::string text;
+    std::uint32_t name_begin = 0;  // [0, name_begin) is the muted "type: " prefix
+    std::uint32_t name_end = 0;    // [name_end, size) is the muted " = default" suffix
+    float type_width = 0.0f;       // width of [0, name_begin)
+    float name_width = 0.0f;       // width of [name_begin, name_end)
+};
+
+// Everything the card renderer needs per class that does not depend on layout or zoom.
+struct ClassRows {
+    std::vector<std::int32_t> parents;  // class index per parent id, -1 if not in the diagram
+    std::vector<ClassRowText> properties;
+    std::vector<ClassRowText> components;
+    std::vector<std::uint32_t> component_property_begin;  // per component, +1 end entry
+    std::vector<ClassRowText> component_properties;
+    std::vector<std::int32_t> children;  // class index per child object, -1 if not in the diagram
+    std::vector<ClassRowText> child_rows;  // "Type: label"; also the nested card title
+};
+
+// Per-class state kept by render_class_diagram between frames. Rows and card layouts are built
+// the first time a class is drawn and dropped when the font or font size changes. Call reset() when the
+// diagram is replaced or edited; a different diagram object or class count resets it too.
+//
+// With retained cards (the default), an expanded card drawn at full detail is recorded once
+// and replayed every frame with the pan/zoom transform. A recording is redone when the
+// block's size changes, the zoom leaves the recorded step (1/8 octave, so text stays sharp),
+// the font or font atlas texture changes, or invalidate_card() is called; hover highlights
+// are drawn over the cards and do not touch it.
+// Use from the ImGui thread. While it waits for card recording workers, those may call rows()
+// for classes whose rows it already built, and cycle_label_width(); nothing they call measures
+// text.
+class ClassDiagramRenderCache {
+public:
+    ClassDiagramRenderCache();
+    ~ClassDiagramRenderCache();
+    ClassDiagramRenderCache(const ClassDiagramRenderCache&) = delete;
+    ClassDiagramRenderCache& operator=(const ClassDiagramRenderCache&) = delete;
+
+    void reset();
+
+    void set_retained_cards(bool enabled);
+    bool retained_cards() const { return retained_cards_; }
+    // Drops the recorded geometry and layout of one block, e.g. after one of its nested cards
+    // was toggled.
+    void invalidate_card(std::string_view class_id);
+    detail::CardVertexCache& cards() { return *cards_; }
+
+    // Binds the cache to `diagram` and the current ImGui font; called once per frame by the
+    // renderer before rows(). Also loads every glyph the diagram's text uses at
+    // `card_font_size` (0 = skip), so drawing cards at that size on worker threads never adds
+    // glyphs to the font atlas.
+    void begin_frame(const diagram_model::ClassDiagram& diagram, float card_font_size = 0.0f);
+
+    // Built on first use, which measures text: the first call for a class must come from the
+    // ImGui thread.
+    const ClassRows& rows(std::uint32_t class_index);
+    // Content layout of the expanded block of a class, rebuilt when a nested card it shows
+    // was toggled in `nested_expanded` since it was built. Not for worker threads.
+    const detail::CardLayout& card_layout(std::uint32_t class_index,
+        const NestedExpansion& nested_expanded);
+    // -1 if `id` is not a class of the diagram.
+    std::int32_t class_index(std::string_view id) const;
+    // World width of the "(cycle)" marker.
+    float cycle_label_width() const { return cycle_width_; }
+
+private:
+    void build_rows(std::uint32_t class_index, ClassRows& out);
+    ClassRowText make_row(std::string_view type, std::string_view name, std::string_view default_value);
+    float measure(std::string_view text) const;
+    void collect_codepoints();
+    void warm_glyphs(float size);
+
+    const diagram_model::ClassDiagram* diagram_ = nullptr;
+    std::size_t class_count_ = 0;
+    const void* font_ = nullptr;
+    float font_size_ = 0.0f;
+    float cycle_width_ = 0.0f;
+    std::unordered_map<std::string_view, std::uint32_t> index_;
+    std::vector<ClassRows> rows_;
+    std::vector<std::uint8_t> built_;
+    std::vector<std::unique_ptr<detail::CardLayout>> layouts_;  // null until first drawn
+    std::vector<std::uint32_t> codepoints_;  // every codepoint of the diagram's card text
+    const void* warmed_card_ = nullptr;      // baked font whose glyphs were loaded
+    std::unique_ptr<detail::CardVertexCache> cards_;
+    bool retained_cards_ = true;
+};
+
+} // namespace diagram_render
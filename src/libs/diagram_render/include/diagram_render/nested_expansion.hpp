@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace diagram_model {
+struct ClassDiagram;
+}
+
+namespace diagram_render {
+
+// Key of a nested card inside a class block: a 64-bit hash of its path from the block, e.g.
+// "Player/child/0/parent/1" (the block's class id, then one section/index step per level).
+// Keys are derived level by level while a card is traversed, without building the string.
+// Never 0.
+using NestedPathKey = std::uint64_t;
+
+enum class NestedSection : std::uint8_t { Parent, Child };
+
+// Key of the block itself ("Player"); the keys of its nested cards derive from it.
+NestedPathKey nested_root_key(std::string_view block_class_id);
+
+// Key of `index`-th parent / child card inside the card `card`.
+constexpr NestedPathKey nested_child_key(NestedPathKey card, NestedSection section, std::size_t index) {
+    // splitmix64 finalizer over the parent key and the step.
+    std::uint64_t x = card ^ ((static_cast<std::uint64_t>(index) << 1 | static_cast<std::uint64_t>(section))
+        * 0x9E3779B97F4A7C15ull);
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x ? x : 1;
+}
+
+// Key of a string path such as "Player/child/0/parent/1"; nullopt if it has no
+// "/parent/<n>" or "/child/<n>" step. `block_class_id`, if given, receives the leading class id.
+std::optional<NestedPathKey> nested_path_key(std::string_view path, std::string_view* block_class_id = nullptr);
+
+// Set of expanded nested cards: an open-addressing hash set of path keys, so a lookup during
+// layout is one probe into a flat array. String paths are only for saving and loading.
+class NestedExpansion {
+public:
+    bool contains(NestedPathKey key) const;
+    void set(NestedPathKey key, bool expanded);
+    // Flips the state of `key`; returns the new one.
+    bool toggle(NestedPathKey key);
+    void clear();
+    std::size_t size() const { return size_; }
+
+    // Load: sets the card at a string path; false if the path is malformed.
+    bool set_path(std::string_view path, bool expanded);
+    // Save: string paths of the expanded cards that are shown, found by walking the nested
+    // cards of every class of `diagram` (an expanded card inside a collapsed one is not shown
+    // and not listed).
+    std::vector<std::string> expanded_paths(const diagram_model::ClassDiagram& diagram) const;
+
+private:
+    std::size_t find_slot(NestedPathKey key) const;
+    void grow();
+
+    std::vector<NestedPathKey> slots_;  // 0 = empty; size is a power of two
+    std::size_t size_ = 0;
+};
+
+} // namespace diagram_render
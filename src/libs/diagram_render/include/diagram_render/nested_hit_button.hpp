@@ -1,14 +1,16 @@
 #pragma once
 
-#include <string>
+#include <diagram_render/nested_expansion.hpp>
+#include <cstdint>
 
 namespace diagram_render {
 
 // Hit region for a nested expand/collapse button inside a class card.
 // Coordinates are in world space. Populated during rendering, checked on click.
+// Classes are indices into the rendered diagram's classes, so recording copies no strings.
 struct NestedHitButton {
-    std::string block_class_id; // top-level block that owns this button
-    std::string path;           // tree path key, e.g. "Player/parent" or "Player/child/0"
+    std::uint32_t block_class_index = 0;  // class of the top-level block that owns this button
+    NestedPathKey path = 0;               // key of the nested card the button expands or collapses
     double x = 0;               // world-space button rect
     double y = 0;
     double w = 0;
@@ -18,17 +20,17 @@ struct NestedHitButton {
 // Hit region for a navigate-to-class arrow button inside a class card.
 // When clicked, the viewport centers on the target class's block.
 struct NavHitButton {
-    std::string target_class_id;  // ID of the class to navigate to
-    double x = 0;                 // world-space button rect
+    std::uint32_t target_class_index = 0;  // class to navigate to
+    double x = 0;                         // world-space button rect
     double y = 0;
     double w = 0;
     double h = 0;
 };
 
-// Hover region that maps an area (parent/child row or nested card) to a class ID.
+// Hover region that maps an area (parent/child row or nested card) to a class.
 // Used to highlight the target block when the mouse hovers over the region.
 struct ClassHoverRegion {
-    std::string target_class_id;
+    std::uint32_t target_class_index = 0;
     double x = 0;
     double y = 0;
     double w = 0;
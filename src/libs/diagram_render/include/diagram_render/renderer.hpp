@@ -2,7 +2,11 @@
 
 #include <diagram_placement/types.hpp>
 #include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/edge_bundling.hpp>
+#include <diagram_render/class_diagram_render_cache.hpp>
+#include <diagram_render/nested_expansion.hpp>
 #include <diagram_render/nested_hit_button.hpp>
+#include <diagram_render/viewport_culling.hpp>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -25,23 +29,41 @@ void render_diagram(ImDrawList* draw_list,
     const diagram_placement::PlacedDiagram& placed,
     float offset_x, float offset_y, float zoom);
 
+// Level of detail of a class block, chosen from its projected size:
+//   Full   - header and content rows (when expanded);
+//   Header - card frame, header title and expand button only;
+//   Box    - one plain filled rectangle;
+//   Point  - merged with nearby points into one small square per screen cell.
+// Buttons and hover regions exist only where they are drawn (Full: all, Header: main button).
+enum class ClassBlockLod { Full, Header, Box, Point };
+
+ClassBlockLod class_block_lod(double width, double height, float zoom);
+
+// With a viewport, blocks and line segments outside viewport->visible are skipped entirely
+// (hit buttons and hover regions are then recorded for visible blocks only). A cull index, if
+// given, must have been built from `placed` and `connection_lines`.
+// render_cache keeps preformatted rows between frames; without one a per-thread cache is
+// used, which only notices a new diagram by its address and class count.
 void render_class_diagram(ImDrawList* draw_list,
     const diagram_model::ClassDiagram& diagram,
     const diagram_placement::PlacedClassDiagram& placed,
     float offset_x, float offset_y, float zoom,
-    const std::unordered_map<std::string, bool>& nested_expanded,
+    const NestedExpansion& nested_expanded,
     std::vector<NestedHitButton>* out_hit_buttons = nullptr,
     std::vector<NavHitButton>* out_nav_buttons = nullptr,
     std::vector<ClassHoverRegion>* out_hover_regions = nullptr,
     const std::string& hovered_class_id = {},
-    const std::vector<diagram_placement::ConnectionLine>& connection_lines = {},
-    const std::unordered_set<std::string>& highlighted_class_ids = {});
+    const diagram_placement::ConnectionGeometry* connection_lines = nullptr,
+    const std::unordered_set<std::string>& highlighted_class_ids = {},
+    const diagram_placement::ConnectionBundles* connection_bundles = nullptr,
+    const ClassDiagramViewport* viewport = nullptr,
+    ClassDiagramRenderCache* render_cache = nullptr);
 
 // Computes block width/height from content using ImGui::CalcTextSize (current font).
 // Call only when ImGui context is active. Returns map class_id -> Rect (width and height set; x,y zero).
 std::unordered_map<std::string, diagram_placement::Rect> compute_class_block_sizes(
     const diagram_model::ClassDiagram& diagram,
     const std::unordered_map<std::string, bool>& expanded,
-    const std::unordered_map<std::string, bool>& nested_expanded = {});
+    const NestedExpansion& nested_expanded = {});
 
 } // namespace diagram_render
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace diagram_render {
+
+// Persistent cache of ImGui::CalcTextSize widths, keyed by (font, font size, interned string).
+// Strings are interned once; each font/size pair keeps a dense width table indexed by string
+// id, so a repeated measurement is one hash lookup. Tables are dropped when the font atlas
+// changes (another atlas, or fonts added/removed); call invalidate() after reloading fonts
+// in place or loading another diagram, so strings of old diagrams do not pile up.
+// Not thread-safe: use from the ImGui thread.
+class TextMeasureCache {
+public:
+    static TextMeasureCache& shared();
+
+    // Width in pixels of `text` in the current ImGui font at the current font size.
+    // Requires an active ImGui context.
+    double width(std::string_view text);
+
+    // Drops every measurement and interned string.
+    void invalidate();
+    std::size_t interned_count() const { return strings_.size(); }
+    std::size_t measured_count() const;
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    struct FontTable {
+        const void* font = nullptr;
+        float size = 0.0f;
+        std::vector<float> widths;  // by string id; < 0 = not measured yet
+    };
+
+    std::uint32_t intern(std::string_view text);
+    FontTable& current_table();
+
+    std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>> ids_;
+    std::vector<const std::string*> strings_;  // id -> interned text (node keys are stable)
+    std::vector<FontTable> tables_;
+    std::size_t last_table_ = 0;
+    const void* atlas_ = nullptr;
+    int atlas_font_count_ = -1;
+};
+
+} // namespace diagram_render
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <diagram_placement/class_diagram_placement.hpp>
+#include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/spatial_grid.hpp>
+#include <diagram_placement/types.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace diagram_render {
+
+// World-space bounds of class blocks and connection routes, for skipping everything outside
+// the view and for picking. Rebuild the blocks when the placement changes and the lines when
+// the routes change; queries are read-only.
+class ClassDiagramCullIndex {
+public:
+    void build(const diagram_placement::PlacedClassDiagram& placed,
+        const diagram_placement::ConnectionGeometry* lines);
+    void build_blocks(const diagram_placement::PlacedClassDiagram& placed);
+    void build_lines(const diagram_placement::ConnectionGeometry* lines);
+    void clear();
+
+    // Indices into placed.blocks / connection lines whose bounds intersect `view`, ascending
+    // (so draw order, and with it overlap order, is unchanged).
+    void visible_blocks(const diagram_placement::Rect& view, std::vector<std::uint32_t>& out) const;
+    void visible_lines(const diagram_placement::Rect& view, std::vector<std::uint32_t>& out) const;
+    // Indices of the blocks containing (x, y), ascending: the last one is drawn on top.
+    void blocks_at(double x, double y, std::vector<std::uint32_t>& out) const;
+
+private:
+    diagram_placement::SpatialGrid blocks_;
+    diagram_placement::SpatialGrid lines_;
+    std::vector<std::uint32_t> line_ids_; // lines_ item -> line index (unrouted lines are skipped)
+    std::vector<diagram_placement::Rect> scratch_;
+};
+
+// Visible world rectangle for render_class_diagram. Without an index every block and line is
+// still bounds-tested, which already saves all the drawing.
+struct ClassDiagramViewport {
+    diagram_placement::Rect visible;
+    const ClassDiagramCullIndex* index = nullptr;
+};
+
+} // namespace diagram_render
@@ -0,0 +1,259 @@
+#include "card_layout.hpp"
+#include <diagram_placement/class_diagram_layout_constants.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+namespace diagram_render::detail {
+
+using namespace diagram_placement::layout;
+
+namespace {
+
+// Classes on the path from the block to the card being laid out (at most max_nesting_depth).
+using VisitedPath = std::vector<const diagram_model::DiagramClass*>;
+
+bool on_path(const VisitedPath& visited, const diagram_model::DiagramClass* cls) {
+    return std::find(visited.begin(), visited.end(), cls) != visited.end();
+}
+
+// State of one build_card_layout call shared by every nesting level.
+struct LayoutBuilder {
+    const diagram_model::ClassDiagram& diagram;
+    const ClassIndex& index;
+    const BlockMetrics& metrics;
+    const NestedExpansion& nested_expanded;
+    bool measure_text;
+    CardLayout& out;
+    std::vector<std::uint32_t>* deps;
+    std::string line_buffer{};
+    VisitedPath visited{};
+    double y = 0.0;
+
+    // Lookup that also records the class as a dependency of the block being measured.
+    std::int32_t find_class(const std::string& id) {
+        auto it = index.find(id);
+        if (it == index.end()) return -1;
+        if (deps) deps->push_back(it->second);
+        return static_cast<std::int32_t>(it->second);
+    }
+
+    // Zero when only positions are wanted.
+    double measure(std::string_view text) const {
+        return measure_text ? measure_text_width(text) : 0.0;
+    }
+
+    std::string_view format_typed_name(const std::string& type, const std::string& name,
+        const std::string& default_value)
+    {
+        line_buffer.assign(type).append(": ").append(name);
+        if (!default_value.empty())
+            line_buffer.append(" = ").append(default_value);
+        return line_buffer;
+    }
+
+    void add_row(CardRowKind kind, CardSection section, std::uint32_t class_index, std::size_t item,
+        int depth)
+    {
+        CardLayoutRow row;
+        row.top = static_cast<float>(y);
+        row.class_index = class_index;
+        row.item = static_cast<std::uint32_t>(item);
+        row.depth = static_cast<std::uint8_t>(depth);
+        row.kind = kind;
+        row.section = section;
+        out.rows.push_back(row);
+        y += metrics.row_height;
+    }
+
+    void add_header(CardSection section, std::uint32_t class_index, int depth) {
+        add_row(CardRowKind::Header, section, class_index, 0, depth);
+        y += metrics.row_inner_gap;
+    }
+
+    // Parent or child `item` of the class: a collapsed row, or a nested card with the target's
+    // content when it is expanded. title_width: width of the row text / card title.
+    // card: path key of the card holding the row.
+    void add_nested(CardSection section, std::uint32_t class_index, std::size_t item,
+        std::int32_t target, double title_width, NestedPathKey card, int depth, double& max_text_width)
+    {
+        const diagram_model::DiagramClass* target_cls = target >= 0 ? &diagram.classes[target] : nullptr;
+        const bool cycle = target_cls && on_path(visited, target_cls);
+        const bool can_expand = target_cls && !cycle && depth + 1 < max_nesting_depth;
+        max_text_width = std::max(max_text_width,
+            title_width + nav_button_size + nav_button_gap + nested_button_size + content_indent);
+
+        std::uint32_t key = no_card_key;
+        NestedPathKey path_key = 0;
+        bool expanded = false;
+        if (can_expand) {
+            path_key = nested_child_key(card,
+                section == CardSection::Parent ? NestedSection::Parent : NestedSection::Child, item);
+            expanded = nested_expanded.contains(path_key);
+            key = static_cast<std::uint32_t>(out.keys.size());
+            out.keys.push_back(path_key);
+            out.key_expanded.push_back(expanded ? 1 : 0);
+        }
+
+        if (!expanded) {
+            add_row(section == CardSection::Parent ? CardRowKind::Parent : CardRowKind::Child,
+                section, class_index, item, depth);
+            out.rows.back().target = target;
+            out.rows.back().key = key;
+            out.rows.back().cycle = cycle;
+            return;
+        }
+
+        // Expanded: the row turns into a card holding the target's content.
+        CardLayoutFrame frame;
+        frame.top = static_cast<float>(y);
+        frame.class_index = class_index;
+        frame.item = static_cast<std::uint32_t>(item);
+        frame.target = target;
+        frame.key = key;
+        frame.depth = static_cast<std::uint8_t>(depth);
+        frame.section = section;
+        y += nested_header_height + nested_card_content_inset_top;
+        visited.push_back(target_cls);
+        const double nested_width = add_content(static_cast<std::uint32_t>(target), path_key, depth + 1);
+        visited.pop_back();
+        y += nested_card_content_inset_bottom;
+        frame.bottom = static_cast<float>(y);
+        out.frames.push_back(frame);
+        max_text_width = std::max(max_text_width, nested_width + 2.0 * nested_card_pad_x);
+    }
+
+    // The 4 sections (Parent, Properties, Components, Children) of a class at `depth`
+    // (0 = top-level content of the block) inside the card with path key `card`. Returns the
+    // widest text, relative to this level's content area; card padding is added at nesting
+    // boundaries.
+    double add_content(std::uint32_t class_index, NestedPathKey card, int depth) {
+        const diagram_model::DiagramClass& cls = diagram.classes[class_index];
+        const double em_dash_width = measure("\xE2\x80\x94");
+        double max_text_width = 0.0;
+        auto track = [&](double w) { max_text_width = std::max(max_text_width, w); };
+
+        // --- Parent section ---
+        track(measure("Parent:"));
+        add_header(CardSection::Parent, class_index, depth);
+        if (!cls.parent_class_ids.empty()) {
+            for (std::size_t pi = 0; pi < cls.parent_class_ids.size(); ++pi) {
+                const std::int32_t parent = find_class(cls.parent_class_ids[pi]);
+                const std::string& parent_name = parent >= 0
+                    ? diagram.classes[parent].type_name : cls.parent_class_ids[pi];
+                add_nested(CardSection::Parent, class_index, pi, parent, measure(parent_name), card, depth,
+                    max_text_width);
+                if (pi + 1 < cls.parent_class_ids.size())
+                    y += metrics.row_inner_gap;
+            }
+        } else {
+            track(em_dash_width);
+            add_row(CardRowKind::Empty, CardSection::Parent, class_index, 0, depth);
+        }
+        y += metrics.group_vertical_gap;
+
+        // --- Properties section ---
+        track(measure("Properties:"));
+        add_header(CardSection::Properties, class_index, depth);
+        if (!cls.properties.empty()) {
+            for (std::size_t i = 0; i < cls.properties.size(); ++i) {
+                const auto& p = cls.properties[i];
+                if (measure_text) track(measure(format_typed_name(p.type, p.name, p.default_value)));
+                add_row(CardRowKind::Property, CardSection::Properties, class_index, i, depth);
+                if (i + 1 < cls.properties.size())
+                    y += metrics.row_inner_gap;
+            }
+        } else {
+            track(em_dash_width);
+            add_row(CardRowKind::Empty, CardSection::Properties, class_index, 0, depth);
+        }
+        y += metrics.group_vertical_gap;
+
+        // --- Components section ---
+        track(measure("Components:"));
+        add_header(CardSection::Components, class_index, depth);
+        if (!cls.components.empty()) {
+            std::size_t flat = 0;  // index of the next component property over all components
+            for (std::size_t i = 0; i < cls.components.size(); ++i) {
+                const auto& comp = cls.components[i];
+                if (measure_text) {
+                    line_buffer.assign(comp.type).append(": ").append(comp.name);
+                    track(measure(line_buffer));
+                }
+                add_row(CardRowKind::Component, CardSection::Components, class_index, i, depth);
+                if (!comp.properties.empty() || i + 1 < cls.components.size())
+                    y += metrics.row_inner_gap;
+
+                for (std::size_t j = 0; j < comp.properties.size(); ++j, ++flat) {
+                    const auto& p = comp.properties[j];
+                    if (measure_text)
+                        track(measure(format_typed_name(p.type, p.name, p.default_value)) + metrics.subproperty_indent);
+                    add_row(CardRowKind::ComponentProperty, CardSection::Components, class_index, flat, depth);
+                    if (j + 1 < comp.properties.size() || i + 1 < cls.components.size())
+                        y += metrics.row_inner_gap;
+                }
+            }
+        } else {
+            track(em_dash_width);
+            add_row(CardRowKind::Empty, CardSection::Components, class_index, 0, depth);
+        }
+        y += metrics.group_vertical_gap;
+
+        // --- Children section ---
+        track(measure("Children:"));
+        add_header(CardSection::Children, class_index, depth);
+        if (!cls.child_objects.empty()) {
+            for (std::size_t i = 0; i < cls.child_objects.size(); ++i) {
+                const auto& co = cls.child_objects[i];
+                const std::int32_t child = find_class(co.class_id);
+                double title_width = 0.0;
+                if (measure_text) {
+                    const std::string& type_name = child >= 0 ? diagram.classes[child].type_name : co.class_id;
+                    line_buffer.assign(type_name).append(": ").append(co.label.empty() ? type_name : co.label);
+                    title_width = measure(line_buffer);
+                }
+                add_nested(CardSection::Children, class_index, i, child, title_width, card, depth, max_text_width);
+                if (i + 1 < cls.child_objects.size())
+                    y += metrics.row_inner_gap;
+            }
+        } else {
+            track(em_dash_width);
+            add_row(CardRowKind::Empty, CardSection::Children, class_index, 0, depth);
+        }
+        // No trailing group_vertical_gap after last section.
+
+        return max_text_width;
+    }
+};
+
+} // namespace
+
+bool CardLayout::matches(const NestedExpansion& nested_expanded) const {
+    for (std::size_t k = 0; k < keys.size(); ++k)
+        if (nested_expanded.contains(keys[k]) != (key_expanded[k] != 0)) return false;
+    return true;
+}
+
+void build_card_layout(
+    const diagram_model::ClassDiagram& diagram,
+    const ClassIndex& index,
+    const BlockMetrics& metrics,
+    std::uint32_t class_index,
+    const NestedExpansion& nested_expanded,
+    bool measure_text,
+    CardLayout& out,
+    std::vector<std::uint32_t>* deps)
+{
+    out.rows.clear();
+    out.frames.clear();
+    out.keys.clear();
+    out.key_expanded.clear();
+    const diagram_model::DiagramClass& cls = diagram.classes[class_index];
+    LayoutBuilder builder{ diagram, index, metrics, nested_expanded, measure_text, out, deps };
+    builder.visited.push_back(&cls);
+    out.max_text_width = builder.add_content(class_index, nested_root_key(cls.id), 0);
+    out.height = builder.y;
+}
+
+} // namespace diagram_render::detail
@@ -0,0 +1,78 @@
+#pragma once
+
+// Flat layout of a class card's content sections, built by one traversal and read both by
+// measure_class_block (width/height) and by the card renderer (row and nested card positions).
+#include "class_block_measure.hpp"
+#include <diagram_render/nested_expansion.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace diagram_render::detail {
+
+enum class CardSection : std::uint8_t { Parent, Properties, Components, Children };
+
+enum class CardRowKind : std::uint8_t {
+    Header,             // "Parent:", "Properties:", ...; spans the whole content width
+    Empty,              // em dash of an empty section
+    Property,           // item: index into properties
+    Component,          // item: index into components
+    ComponentProperty,  // item: index into ClassRows::component_properties
+    Parent,             // collapsed parent row; item: index into parent_class_ids
+    Child,              // collapsed child row; item: index into child_objects
+};
+
+constexpr std::uint32_t no_card_key = 0xFFFFFFFFu;
+
+// One row of the card. Rows of nested content sit `depth` cards deep; every level insets the
+// content area by nested_card_pad_x on both sides, so x extents follow from the block width.
+struct CardLayoutRow {
+    float top = 0.0f;                 // relative to the top of the block's content area
+    std::uint32_t class_index = 0;    // class whose section holds the row
+    std::uint32_t item = 0;
+    std::int32_t target = -1;         // parent / child class index, -1 if not in the diagram
+    std::uint32_t key = no_card_key;  // index into CardLayout::keys of a row with a [+] button
+    std::uint8_t depth = 0;
+    CardRowKind kind = CardRowKind::Header;
+    CardSection section = CardSection::Parent;
+    bool cycle = false;               // target already on the expansion path: "(cycle)", no [+]
+};
+
+// An expanded parent or child card: header at `top`, its content rows below, border to `bottom`.
+struct CardLayoutFrame {
+    float top = 0.0f;
+    float bottom = 0.0f;
+    std::uint32_t class_index = 0;    // class whose section holds the card
+    std::uint32_t item = 0;           // index into parent_class_ids / child_objects
+    std::int32_t target = 0;          // class shown in the card
+    std::uint32_t key = 0;
+    std::uint8_t depth = 0;           // depth of the rows around the card, not of its content
+    CardSection section = CardSection::Parent;  // Parent or Children
+};
+
+struct CardLayout {
+    std::vector<CardLayoutRow> rows;      // top to bottom
+    std::vector<CardLayoutFrame> frames;  // in the order the cards close: inner before outer
+    // Path keys of every nested card that could be expanded, and whether it was.
+    std::vector<NestedPathKey> keys;
+    std::vector<std::uint8_t> key_expanded;
+    double height = 0.0;
+    double max_text_width = 0.0;          // only when built with measure_text
+
+    // Whether `nested_expanded` still gives every key the state the layout was built with.
+    bool matches(const NestedExpansion& nested_expanded) const;
+};
+
+// Lays out the content of the expanded block of diagram.classes[class_index]. With
+// measure_text, also the widest row text relative to the content area. If deps is given, the
+// index of every class looked up is appended to it (see measure_class_block).
+void build_card_layout(
+    const diagram_model::ClassDiagram& diagram,
+    const ClassIndex& index,
+    const BlockMetrics& metrics,
+    std::uint32_t class_index,
+    const NestedExpansion& nested_expanded,
+    bool measure_text,
+    CardLayout& out,
+    std::vector<std::uint32_t>* deps);
+
+} // namespace diagram_render::detail
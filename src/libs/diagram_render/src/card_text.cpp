@@ -0,0 +1,63 @@
+#include "card_text.hpp"
+#include "imgui_internal.h"
+#include <cstring>
+
+namespace diagram_render::detail {
+
+void add_text(ImDrawList& list, ImFontBaked& baked, float size, ImVec2 pos, ImU32 color,
+    const char* begin, const char* end)
+{
+    if ((color & IM_COL32_A_MASK) == 0) return;
+    if (!end) end = begin + std::strlen(begin);
+    if (begin == end) return;
+
+    // Pixel-aligned and clipped against the current clip rect, as in ImFont::RenderText.
+    const ImVec4 clip = list._CmdHeader.ClipRect;
+    float x = static_cast<float>(static_cast<int>(pos.x));
+    const float y = static_cast<float>(static_cast<int>(pos.y));
+    if (y > clip.w || y + size < clip.y) return;
+    const float scale = size / baked.Size;
+    const ImU32 untinted = color | ~IM_COL32_A_MASK;
+
+    // One quad per byte at most; the unused rest is given back below.
+    const int max_quads = static_cast<int>(end - begin);
+    list.PrimReserve(max_quads * 6, max_quads * 4);
+    ImDrawVert* vtx = list._VtxWritePtr;
+    ImDrawIdx* idx = list._IdxWritePtr;
+    unsigned int vtx_index = list._VtxCurrentIdx;
+    for (const char* s = begin; s < end;) {
+        unsigned int c = static_cast<unsigned char>(*s);
+        if (c < 0x80) ++s;
+        else s += ImTextCharFromUtf8(&c, s, end);
+        if (c < 32) continue;
+
+        const ImFontGlyph* glyph = baked.FindGlyph(static_cast<ImWchar>(c));
+        const float x1 = x + glyph->X0 * scale;
+        const float x2 = x + glyph->X1 * scale;
+        x += glyph->AdvanceX * scale;
+        if (!glyph->Visible || x1 > clip.z || x2 < clip.x) continue;
+        const float y1 = y + glyph->Y0 * scale;
+        const float y2 = y + glyph->Y1 * scale;
+        const ImU32 col = glyph->Colored ? untinted : color;
+        vtx[0].pos = ImVec2(x1, y1); vtx[0].uv = ImVec2(glyph->U0, glyph->V0); vtx[0].col = col;
+        vtx[1].pos = ImVec2(x2, y1); vtx[1].uv = ImVec2(glyph->U1, glyph->V0); vtx[1].col = col;
+        vtx[2].pos = ImVec2(x2, y2); vtx[2].uv = ImVec2(glyph->U1, glyph->V1); vtx[2].col = col;
+        vtx[3].pos = ImVec2(x1, y2); vtx[3].uv = ImVec2(glyph->U0, glyph->V1); vtx[3].col = col;
+        idx[0] = static_cast<ImDrawIdx>(vtx_index);
+        idx[1] = static_cast<ImDrawIdx>(vtx_index + 1);
+        idx[2] = static_cast<ImDrawIdx>(vtx_index + 2);
+        idx[3] = static_cast<ImDrawIdx>(vtx_index);
+        idx[4] = static_cast<ImDrawIdx>(vtx_index + 2);
+        idx[5] = static_cast<ImDrawIdx>(vtx_index + 3);
+        vtx += 4;
+        idx += 6;
+        vtx_index += 4;
+    }
+    const int unused = max_quads - static_cast<int>(vtx - list._VtxWritePtr) / 4;
+    list._VtxWritePtr = vtx;
+    list._IdxWritePtr = idx;
+    list._VtxCurrentIdx = vtx_index;
+    list.PrimUnreserve(unused * 6, unused * 4);
+}
+
+} // namespace diagram_render::detail
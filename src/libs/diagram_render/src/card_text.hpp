@@ -0,0 +1,16 @@
+#pragma once
+
+// Card text drawn from an already resolved baked font, for render_class_diagram.
+#include "imgui.h"
+
+namespace diagram_render::detail {
+
+// Appends one line of text to `list` like ImDrawList::AddText(font, size, ...), but with the
+// glyphs of `baked` instead of looking the baked font up by size. ImFont::GetFontBaked writes
+// the font's shared state, so card recording workers must not call it; the renderer resolves
+// the baked font on the ImGui thread and passes it in. Every glyph of the text must already
+// be loaded in `baked` when this runs off the ImGui thread. Control characters are skipped.
+void add_text(ImDrawList& list, ImFontBaked& baked, float size, ImVec2 pos, ImU32 color,
+    const char* begin, const char* end = nullptr);
+
+} // namespace diagram_render::detail
@@ -0,0 +1,128 @@
+#include "card_vertex_cache.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace diagram_render::detail {
+
+namespace {
+
+template <class T>
+void offset_regions(std::vector<T>& regions, double dx, double dy) {
+    for (T& r : regions) {
+        r.x += dx;
+        r.y += dy;
+    }
+}
+
+} // namespace
+
+void CardVertexCache::clear() {
+    for (CardRecording& rec : cards_)
+        rec.valid = false;
+}
+
+void CardVertexCache::begin_frame() {
+    const ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    const ImTextureData* tex = atlas ? atlas->TexData : nullptr;
+    const int tex_id = tex ? tex->UniqueID : -1;
+    const ImVec2 uv_scale = atlas ? atlas->TexUvScale : ImVec2();
+    if (atlas != atlas_ || tex != texture_ || tex_id != texture_id_
+        || uv_scale.x != uv_scale_.x || uv_scale.y != uv_scale_.y)
+    {
+        clear();
+        atlas_ = atlas;
+        texture_ = tex;
+        texture_id_ = tex_id;
+        uv_scale_ = uv_scale;
+    }
+}
+
+void CardVertexCache::invalidate(std::uint32_t class_index) {
+    if (class_index < cards_.size()) cards_[class_index].valid = false;
+}
+
+CardRecording& CardVertexCache::slot(std::uint32_t class_index) {
+    if (class_index >= cards_.size()) cards_.resize(class_index + 1);
+    return cards_[class_index];
+}
+
+void CardVertexCache::begin_recording(ImDrawList& scratch, const ImDrawList& target) {
+    constexpr float big = 1e7f;
+    scratch._ResetForNewFrame();
+    scratch.Flags = target.Flags;
+    scratch._FringeScale = target._FringeScale;
+    scratch.PushTexture(ImGui::GetIO().Fonts->TexRef);
+    scratch.PushClipRect(ImVec2(-big, -big), ImVec2(big, big));
+}
+
+void CardVertexCache::end_recording(const ImDrawList& scratch, CardRecording& rec,
+    double width, double height, float zoom, double origin_x, double origin_y)
+{
+    rec.vertices.clear();
+    rec.indices.clear();
+    rec.segments.clear();
+    for (const ImDrawCmd& cmd : scratch.CmdBuffer) {
+        if (cmd.ElemCount == 0 || cmd.UserCallback) continue;
+        const ImDrawIdx* idx = scratch.IdxBuffer.Data + cmd.IdxOffset;
+        unsigned int lo = std::numeric_limits<unsigned int>::max();
+        unsigned int hi = 0;
+        for (unsigned int e = 0; e < cmd.ElemCount; ++e) {
+            lo = std::min<unsigned int>(lo, idx[e]);
+            hi = std::max<unsigned int>(hi, idx[e]);
+        }
+
+        CardRecording::Segment seg;
+        seg.clip = cmd.ClipRect;
+        seg.texture = cmd.TexRef;
+        seg.vtx_begin = static_cast<std::uint32_t>(rec.vertices.size());
+        seg.vtx_count = hi - lo + 1;
+        seg.idx_begin = static_cast<std::uint32_t>(rec.indices.size());
+        seg.idx_count = cmd.ElemCount;
+        const ImDrawVert* vtx = scratch.VtxBuffer.Data + cmd.VtxOffset + lo;
+        rec.vertices.insert(rec.vertices.end(), vtx, vtx + seg.vtx_count);
+        for (unsigned int e = 0; e < cmd.ElemCount; ++e)
+            rec.indices.push_back(static_cast<ImDrawIdx>(idx[e] - lo));
+        rec.segments.push_back(seg);
+    }
+
+    offset_regions(rec.hit_buttons, -origin_x, -origin_y);
+    offset_regions(rec.nav_buttons, -origin_x, -origin_y);
+    offset_regions(rec.hover_regions, -origin_x, -origin_y);
+    rec.width = width;
+    rec.height = height;
+    rec.zoom = zoom;
+    rec.valid = true;
+}
+
+void CardVertexCache::replay(const CardRecording& rec, ImDrawList& target, float scale, ImVec2 translate) {
+    for (const CardRecording::Segment& seg : rec.segments) {
+        target.PushClipRect(
+            ImVec2(seg.clip.x * scale + translate.x, seg.clip.y * scale + translate.y),
+            ImVec2(seg.clip.z * scale + translate.x, seg.clip.w * scale + translate.y), true);
+        target.PushTexture(seg.texture);
+        target.PrimReserve(static_cast<int>(seg.idx_count), static_cast<int>(seg.vtx_count));
+
+        // Straight-line loops over contiguous arrays; the compiler vectorizes both.
+        const ImDrawVert* src = rec.vertices.data() + seg.vtx_begin;
+        ImDrawVert* dst = target._VtxWritePtr;
+        for (std::uint32_t i = 0; i < seg.vtx_count; ++i) {
+            dst[i].pos.x = src[i].pos.x * scale + translate.x;
+            dst[i].pos.y = src[i].pos.y * scale + translate.y;
+            dst[i].uv = src[i].uv;
+            dst[i].col = src[i].col;
+        }
+        const ImDrawIdx base = static_cast<ImDrawIdx>(target._VtxCurrentIdx);
+        const ImDrawIdx* src_idx = rec.indices.data() + seg.idx_begin;
+        ImDrawIdx* dst_idx = target._IdxWritePtr;
+        for (std::uint32_t i = 0; i < seg.idx_count; ++i)
+            dst_idx[i] = static_cast<ImDrawIdx>(src_idx[i] + base);
+
+        target._VtxWritePtr += seg.vtx_count;
+        target._IdxWritePtr += seg.idx_count;
+        target._VtxCurrentIdx += seg.vtx_count;
+        target.PopTexture();
+        target.PopClipRect();
+    }
+}
+
+} // namespace diagram_render::detail
@@ -0,0 +1,65 @@
+#pragma once
+
+// Retained geometry of expanded class cards, owned by ClassDiagramRenderCache and used by
+// render_class_diagram.
+#include <diagram_render/nested_hit_button.hpp>
+#include "imgui.h"
+#include <cstdint>
+#include <vector>
+
+namespace diagram_render::detail {
+
+// One card's draw commands, recorded with the card's top-left corner at the origin and at a
+// fixed zoom. Replaying scales by zoom / recorded zoom and translates to the card's screen
+// position, so pan and small zoom changes reuse it.
+struct CardRecording {
+    struct Segment {
+        ImVec4 clip;            // card-local, at the recorded zoom
+        ImTextureRef texture;
+        std::uint32_t vtx_begin = 0;
+        std::uint32_t vtx_count = 0;
+        std::uint32_t idx_begin = 0;
+        std::uint32_t idx_count = 0;  // indices relative to the segment's first vertex
+    };
+
+    bool valid = false;
+    double width = 0.0;
+    double height = 0.0;
+    float zoom = 0.0f;
+    std::vector<ImDrawVert> vertices;
+    std::vector<ImDrawIdx> indices;
+    std::vector<Segment> segments;
+    // Hit and hover regions, in world units relative to the card's top-left corner.
+    std::vector<NestedHitButton> hit_buttons;
+    std::vector<NavHitButton> nav_buttons;
+    std::vector<ClassHoverRegion> hover_regions;
+
+    bool matches(double w, double h, float z) const { return valid && width == w && height == h && zoom == z; }
+};
+
+class CardVertexCache {
+public:
+    void clear();
+    // Drops every recording if the font atlas texture changed (glyph UVs would be stale).
+    void begin_frame();
+    void invalidate(std::uint32_t class_index);
+
+    CardRecording& slot(std::uint32_t class_index);
+
+    // Resets `scratch` for recording one card drawn the way it would be into `target`.
+    static void begin_recording(ImDrawList& scratch, const ImDrawList& target);
+    // Moves the commands drawn into `scratch` into `rec` and makes hit regions card-local.
+    static void end_recording(const ImDrawList& scratch, CardRecording& rec,
+        double width, double height, float zoom, double origin_x, double origin_y);
+    // Appends the recording to `target`: screen = local * scale + translate.
+    static void replay(const CardRecording& rec, ImDrawList& target, float scale, ImVec2 translate);
+
+private:
+    std::vector<CardRecording> cards_;  // by class index
+    const void* atlas_ = nullptr;
+    const void* texture_ = nullptr;
+    int texture_id_ = -1;
+    ImVec2 uv_scale_;
+};
+
+} // namespace diagram_render::detail
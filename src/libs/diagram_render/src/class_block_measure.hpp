@@ -0,0 +1,45 @@
+#pragma once
+
+// Block measurement shared by compute_class_block_sizes and ClassBlockSizer.
+#include <diagram_render/nested_expansion.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <diagram_placement/types.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace diagram_render::detail {
+
+// class id -> index into ClassDiagram::classes; keys view the diagram's own id strings.
+using ClassIndex = std::unordered_map<std::string_view, std::uint32_t>;
+
+ClassIndex build_class_index(const diagram_model::ClassDiagram& diagram);
+
+// Text width in world units (ImGui returns pixels; at zoom 1 we treat 1 pixel = 1 world unit).
+// Widths are cached across calls, so only text not seen before reaches ImGui.
+double measure_text_width(std::string_view text);
+
+// Row spacing scaled to the current ImGui font.
+struct BlockMetrics {
+    double row_height = 0.0;
+    double row_inner_gap = 0.0;
+    double group_vertical_gap = 0.0;
+    double subproperty_indent = 0.0;
+};
+
+BlockMetrics current_block_metrics();
+
+// Width/height of the block of diagram.classes[class_index] (x, y zero). If deps is given, the
+// index of every class whose data the block shows is appended to it (unsorted, may repeat).
+diagram_placement::Rect measure_class_block(
+    const diagram_model::ClassDiagram& diagram,
+    const ClassIndex& index,
+    const BlockMetrics& metrics,
+    std::uint32_t class_index,
+    bool expanded,
+    const NestedExpansion& nested_expanded,
+    std::vector<std::uint32_t>* deps);
+
+} // namespace diagram_render::detail
@@ -0,0 +1,127 @@
+#include <diagram_render/class_block_sizer.hpp>
+#include "class_block_measure.hpp"
+#include <diagram_model/class_diagram.hpp>
+#include <profiling/trace.hpp>
+#include "imgui.h"
+#include <algorithm>
+
+namespace diagram_render {
+
+ClassBlockSizer::ClassBlockSizer() = default;
+ClassBlockSizer::~ClassBlockSizer() = default;
+
+void ClassBlockSizer::clear() {
+    diagram_ = nullptr;
+    index_.clear();
+    sizes_.clear();
+    deps_.clear();
+    dependents_.clear();
+    dirty_.clear();
+    is_dirty_.clear();
+    changed_.clear();
+    last_measured_ = 0;
+}
+
+void ClassBlockSizer::reset(const diagram_model::ClassDiagram& diagram,
+    const std::unordered_map<std::string, bool>& expanded,
+    const NestedExpansion& nested_expanded)
+{
+    profiling::TraceScope trace("block_sizer_reset", "sizing");
+    clear();
+    diagram_ = &diagram;
+    index_ = detail::build_class_index(diagram);
+    const std::size_t n = diagram.classes.size();
+    sizes_.reserve(n);
+    deps_.resize(n);
+    dependents_.resize(n);
+    is_dirty_.assign(n, 0);
+    mark_all_dirty();
+    update(expanded, nested_expanded);
+    changed_.clear();
+}
+
+void ClassBlockSizer::mark_dirty(std::uint32_t block) {
+    if (is_dirty_[block]) return;
+    is_dirty_[block] = 1;
+    dirty_.push_back(block);
+}
+
+void ClassBlockSizer::mark_block_dirty(std::string_view class_id) {
+    auto it = index_.find(class_id);
+    if (it != index_.end()) mark_dirty(it->second);
+}
+
+void ClassBlockSizer::mark_class_changed(std::string_view class_id) {
+    auto it = index_.find(class_id);
+    if (it == index_.end()) return;
+    mark_dirty(it->second);
+    for (std::uint32_t block : dependents_[it->second])
+        mark_dirty(block);
+}
+
+void ClassBlockSizer::mark_all_dirty() {
+    for (std::uint32_t i = 0; i < is_dirty_.size(); ++i)
+        mark_dirty(i);
+}
+
+void ClassBlockSizer::set_deps(std::uint32_t block, std::vector<std::uint32_t>& deps) {
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    std::vector<std::uint32_t>& old = deps_[block];
+    if (old == deps) return;
+    for (std::uint32_t c : old) {
+        auto& list = dependents_[c];
+        list.erase(std::find(list.begin(), list.end(), block));
+    }
+    for (std::uint32_t c : deps)
+        dependents_[c].push_back(block);
+    old.assign(deps.begin(), deps.end());
+}
+
+const std::vector<std::string>& ClassBlockSizer::update(
+    const std::unordered_map<std::string, bool>& expanded,
+    const NestedExpansion& nested_expanded)
+{
+    profiling::TraceScope trace("block_sizer_update", "sizing");
+    changed_.clear();
+    last_measured_ = 0;
+    if (!diagram_) return changed_;
+
+    // Row heights follow the font size and text widths the font, so every block depends on both.
+    const void* font = ImGui::GetFont();
+    const float font_size = ImGui::GetFontSize();
+    if (font != font_ || font_size != font_size_) {
+        font_ = font;
+        font_size_ = font_size;
+        mark_all_dirty();
+    }
+    if (dirty_.empty()) return changed_;
+
+    const detail::BlockMetrics metrics = detail::current_block_metrics();
+    for (std::uint32_t block : dirty_) {
+        is_dirty_[block] = 0;
+        const std::string& id = diagram_->classes[block].id;
+        auto eit = expanded.find(id);
+        const bool is_expanded = eit != expanded.end() && eit->second;
+        scratch_deps_.clear();
+        const diagram_placement::Rect r = detail::measure_class_block(*diagram_, index_, metrics,
+            block, is_expanded, nested_expanded, &scratch_deps_);
+        set_deps(block, scratch_deps_);
+        ++last_measured_;
+
+        auto [it, inserted] = sizes_.try_emplace(id, r);
+        if (inserted || it->second.width != r.width || it->second.height != r.height) {
+            it->second = r;
+            changed_.push_back(id);
+        }
+    }
+    dirty_.clear();
+    return changed_;
+}
+
+const diagram_placement::Rect* ClassBlockSizer::size_of(const std::string& class_id) const {
+    auto it = sizes_.find(class_id);
+    return it != sizes_.end() ? &it->second : nullptr;
+}
+
+} // namespace diagram_render
@@ -0,0 +1,206 @@
+#include <diagram_render/class_diagram_render_cache.hpp>
+#include "card_layout.hpp"
+#include "card_vertex_cache.hpp"
+#include <diagram_model/class_diagram.hpp>
+#include "imgui.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace diagram_render {
+
+ClassDiagramRenderCache::ClassDiagramRenderCache()
+    : cards_(std::make_unique<detail::CardVertexCache>())
+{
+}
+
+ClassDiagramRenderCache::~ClassDiagramRenderCache() = default;
+
+void ClassDiagramRenderCache::set_retained_cards(bool enabled) {
+    if (enabled == retained_cards_) return;
+    retained_cards_ = enabled;
+    *cards_ = detail::CardVertexCache{};
+}
+
+void ClassDiagramRenderCache::invalidate_card(std::string_view class_id) {
+    const std::int32_t index = class_index(class_id);
+    if (index < 0) return;
+    cards_->invalidate(static_cast<std::uint32_t>(index));
+    layouts_[index].reset();
+}
+
+void ClassDiagramRenderCache::reset() {
+    *cards_ = detail::CardVertexCache{};
+    diagram_ = nullptr;
+    class_count_ = 0;
+    font_ = nullptr;
+    font_size_ = 0.0f;
+    index_.clear();
+    rows_.clear();
+    built_.clear();
+    layouts_.clear();
+    codepoints_.clear();
+    warmed_card_ = nullptr;
+}
+
+void ClassDiagramRenderCache::begin_frame(const diagram_model::ClassDiagram& diagram, float card_font_size) {
+    if (&diagram != diagram_ || diagram.classes.size() != class_count_) {
+        reset();
+        diagram_ = &diagram;
+        class_count_ = diagram.classes.size();
+        index_.reserve(class_count_);
+        for (std::size_t i = 0; i < class_count_; ++i)
+            index_.emplace(diagram.classes[i].id, static_cast<std::uint32_t>(i));
+        rows_.resize(class_count_);
+        built_.assign(class_count_, 0);
+        layouts_.resize(class_count_);
+        collect_codepoints();
+    }
+
+    const void* font = ImGui::GetFont();
+    const float size = ImGui::GetFontSize();
+    if (font != font_ || size != font_size_) {
+        font_ = font;
+        font_size_ = size;
+        std::fill(built_.begin(), built_.end(), 0);
+        for (auto& layout : layouts_) layout.reset();
+        cycle_width_ = measure("(cycle)");
+        cards_->clear();
+        warmed_card_ = nullptr;
+    }
+    // Before the atlas check below, so glyphs added here are seen this frame.
+    if (card_font_size > 0.0f) warm_glyphs(card_font_size);
+    cards_->begin_frame();
+}
+
+void ClassDiagramRenderCache::collect_codepoints() {
+    codepoints_.clear();
+    std::vector<bool> seen(IM_UNICODE_CODEPOINT_MAX + 1);
+    auto add = [&](std::string_view text) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        while (p < end) {
+            unsigned int c = 0;
+            p += ImTextCharFromUtf8(&c, p, end);
+            if (seen[c]) continue;
+            seen[c] = true;
+            codepoints_.push_back(c);
+        }
+    };
+    // Fixed labels drawn by the card renderer.
+    add("Parent:Properties:Components:Children:(cycle)\xE2\x80\x94: = ");
+    for (const auto& cls : diagram_->classes) {
+        add(cls.id);
+        add(cls.type_name);
+        for (const auto& id : cls.parent_class_ids) add(id);
+        for (const auto& p : cls.properties) {
+            add(p.type);
+            add(p.name);
+            add(p.default_value);
+        }
+        for (const auto& comp : cls.components) {
+            add(comp.type);
+            add(comp.name);
+            for (const auto& p : comp.properties) {
+                add(p.type);
+                add(p.name);
+                add(p.default_value);
+            }
+        }
+        for (const auto& co : cls.child_objects) {
+            add(co.class_id);
+            add(co.label);
+        }
+    }
+}
+
+// ImGui bakes glyphs lazily on first use, which modifies the atlas. Loading them here, on the
+// ImGui thread, means workers drawing text at this size never add glyphs.
+void ClassDiagramRenderCache::warm_glyphs(float size) {
+    ImFontBaked* baked = ImGui::GetFont()->GetFontBaked(size);
+    if (baked == warmed_card_) return;
+    for (const std::uint32_t c : codepoints_)
+        baked->FindGlyph(static_cast<ImWchar>(c));
+    warmed_card_ = baked;
+}
+
+float ClassDiagramRenderCache::measure(std::string_view text) const {
+    if (text.empty()) return 0.0f;
+    return ImGui::GetFont()->CalcTextSizeA(font_size_, FLT_MAX, 0.0f,
+        text.data(), text.data() + text.size()).x;
+}
+
+std::int32_t ClassDiagramRenderCache::class_index(std::string_view id) const {
+    auto it = index_.find(id);
+    return it != index_.end() ? static_cast<std::int32_t>(it->second) : -1;
+}
+
+ClassRowText ClassDiagramRenderCache::make_row(std::string_view type, std::string_view name,
+    std::string_view default_value)
+{
+    ClassRowText row;
+    row.text.reserve(type.size() + name.size() + default_value.size() + 5);
+    row.text.append(type).append(": ");
+    row.name_begin = static_cast<std::uint32_t>(row.text.size());
+    row.text.append(name);
+    row.name_end = static_cast<std::uint32_t>(row.text.size());
+    if (!default_value.empty())
+        row.text.append(" = ").append(default_value);
+    const std::string_view text = row.text;
+    row.type_width = measure(text.substr(0, row.name_begin));
+    row.name_width = measure(text.substr(row.name_begin, row.name_end - row.name_begin));
+    return row;
+}
+
+void ClassDiagramRenderCache::build_rows(std::uint32_t class_index, ClassRows& out) {
+    const diagram_model::DiagramClass& cls = diagram_->classes[class_index];
+    out = ClassRows{};
+
+    out.parents.reserve(cls.parent_class_ids.size());
+    for (const auto& id : cls.parent_class_ids)
+        out.parents.push_back(this->class_index(id));
+
+    out.properties.reserve(cls.properties.size());
+    for (const auto& p : cls.properties)
+        out.properties.push_back(make_row(p.type, p.name, p.default_value));
+
+    out.components.reserve(cls.components.size());
+    out.component_property_begin.reserve(cls.components.size() + 1);
+    for (const auto& comp : cls.components) {
+        out.components.push_back(make_row(comp.type, comp.name, {}));
+        out.component_property_begin.push_back(static_cast<std::uint32_t>(out.component_properties.size()));
+        for (const auto& p : comp.properties)
+            out.component_properties.push_back(make_row(p.type, p.name, p.default_value));
+    }
+    out.component_property_begin.push_back(static_cast<std::uint32_t>(out.component_properties.size()));
+
+    out.children.reserve(cls.child_objects.size());
+    out.child_rows.reserve(cls.child_objects.size());
+    for (const auto& co : cls.child_objects) {
+        const std::int32_t ci = this->class_index(co.class_id);
+        out.children.push_back(ci);
+        const std::string& type_name = ci >= 0 ? diagram_->classes[ci].type_name : co.class_id;
+        out.child_rows.push_back(make_row(type_name, co.label.empty() ? type_name : co.label, {}));
+    }
+}
+
+const ClassRows& ClassDiagramRenderCache::rows(std::uint32_t class_index) {
+    if (!built_[class_index]) {
+        build_rows(class_index, rows_[class_index]);
+        built_[class_index] = 1;
+    }
+    return rows_[class_index];
+}
+
+const detail::CardLayout& ClassDiagramRenderCache::card_layout(std::uint32_t class_index,
+    const NestedExpansion& nested_expanded)
+{
+    std::unique_ptr<detail::CardLayout>& layout = layouts_[class_index];
+    if (layout && layout->matches(nested_expanded)) return *layout;
+    if (!layout) layout = std::make_unique<detail::CardLayout>();
+    detail::build_card_layout(*diagram_, index_, detail::current_block_metrics(), class_index,
+        nested_expanded, false, *layout, nullptr);
+    return *layout;
+}
+
+} // namespace diagram_render
@@ -1,14 +1,28 @@
 #include <diagram_render/renderer.hpp>
+#include <diagram_render/class_diagram_render_cache.hpp>
 #include <diagram_render/nested_hit_button.hpp>
+#include "card_layout.hpp"
+#include "card_text.hpp"
+#include "card_vertex_cache.hpp"
+#include "line_batch.hpp"
 #include <diagram_placement/class_diagram_layout_constants.hpp>
 #include <diagram_placement/class_diagram_placement.hpp>
+#include <diagram_placement/edge_bundling.hpp>
+#include <diagram_placement/spatial_grid.hpp>
+#include <diagram_placement/worker_pool.hpp>
 #include <diagram_model/class_diagram.hpp>
+#include <profiling/trace.hpp>
 #include "imgui.h"
+#include "imgui_internal.h"
 #include <algorithm>
-#include <cfloat>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 namespace diagram_render {
 
@@ -20,20 +34,44 @@ ImVec2 world_to_screen(float wx, float wy, float offset_x, float offset_y, float
     return ImVec2(wx * zoom + offset_x, wy * zoom + offset_y);
 }
 
-const diagram_model::DiagramClass* find_class(const diagram_model::ClassDiagram& diagram, const std::string& id) {
-    for (const auto& c : diagram.classes)
-        if (c.id == id) return &c;
-    return nullptr;
+// Class of a placed block: class_index when it still matches, otherwise a lookup by id.
+const diagram_model::DiagramClass* block_class(const diagram_model::ClassDiagram& diagram,
+    const ClassDiagramRenderCache& cache, const diagram_placement::PlacedClassBlock& block)
+{
+    if (block.class_index < diagram.classes.size() && diagram.classes[block.class_index].id == block.class_id)
+        return &diagram.classes[block.class_index];
+    const std::int32_t index = cache.class_index(block.class_id);
+    return index >= 0 ? &diagram.classes[index] : nullptr;
+}
+
+// World bounds of the segment seg[0..1] -> seg[2..3].
+diagram_placement::Rect segment_bounds(const float* seg) {
+    const float x0 = std::min(seg[0], seg[2]);
+    const float y0 = std::min(seg[1], seg[3]);
+    return { x0, y0, std::max(seg[0], seg[2]) - x0, std::max(seg[1], seg[3]) - y0 };
 }
 
-bool is_nested_expanded(const std::unordered_map<std::string, bool>& nested_expanded,
-    const std::string& key)
+// Calls fn(points, count) for every run of consecutive route segments that pass `visible`,
+// with the run's points converted to screen space.
+template <class Visible, class Fn>
+void for_each_visible_run(const float* pts, std::size_t count, const Visible& visible,
+    float offset_x, float offset_y, float zoom, Fn&& fn)
 {
-    auto it = nested_expanded.find(key);
-    return it != nested_expanded.end() && it->second;
+    static thread_local std::vector<ImVec2> run;
+    run.clear();
+    for (std::size_t i = 0; i + 1 < count; ++i) {
+        if (!visible(segment_bounds(pts + 2 * i))) {
+            if (run.size() >= 2) fn(run.data(), run.size());
+            run.clear();
+            continue;
+        }
+        if (run.empty()) run.push_back(world_to_screen(pts[2 * i], pts[2 * i + 1], offset_x, offset_y, zoom));
+        run.push_back(world_to_screen(pts[2 * i + 2], pts[2 * i + 3], offset_x, offset_y, zoom));
+    }
+    if (run.size() >= 2) fn(run.data(), run.size());
 }
 
-// Shared rendering context passed to the recursive content renderer.
+// Shared rendering context passed to the card and content drawing functions.
 struct RenderContext {
     ImDrawList* draw_list;
     const diagram_model::ClassDiagram& diagram;
@@ -41,7 +79,7 @@ struct RenderContext {
     float offset_y;
     float zoom;
     float safe_zoom;
-    ImFont* font;
+    ImFontBaked* font;  // at scaled_font_size, resolved on the ImGui thread
     float scaled_font_size;
     float font_world_height;
     float f_row_height_effective;
@@ -81,13 +119,25 @@ struct RenderContext {
     unsigned int child_card_border;
     unsigned int child_card_header_bg;
     unsigned int nav_button_color;
-    // Nested state.
-    const std::unordered_map<std::string, bool>& nested_expanded;
+    ClassDiagramRenderCache& cache;
     std::vector<NestedHitButton>* out_hit_buttons;
     std::vector<NavHitButton>* out_nav_buttons;
     std::vector<ClassHoverRegion>* out_hover_regions;
+    unsigned int block_bg;
+    unsigned int header_bg;
+    // World y range that can be seen; content rows outside it are skipped.
+    float visible_top;
+    float visible_bottom;
 };
 
+// Text at world (x, y) in the card font.
+void draw_card_text(const RenderContext& ctx, float x, float y, unsigned int color,
+    const char* begin, const char* end = nullptr)
+{
+    detail::add_text(*ctx.draw_list, *ctx.font, ctx.scaled_font_size,
+        world_to_screen(x, y, ctx.offset_x, ctx.offset_y, ctx.zoom), color, begin, end);
+}
+
 // Draw a small [+] or [-] button for nested expand/collapse.
 // Returns the world-space rect as a NestedHitButton (without path/id filled).
 void draw_nested_button(const RenderContext& ctx, float btn_x, float btn_y, bool is_expanded) {
@@ -116,19 +166,19 @@ void draw_nested_button(const RenderContext& ctx, float btn_x, float btn_y, bool
 
 // Record a hit region for a nested button.
 void record_hit_button(const RenderContext& ctx,
-    const std::string& block_class_id,
-    const std::string& path,
+    std::uint32_t block_class_index,
+    NestedPathKey path,
     float btn_x, float btn_y)
 {
     if (!ctx.out_hit_buttons) return;
     NestedHitButton hb;
-    hb.block_class_id = block_class_id;
+    hb.block_class_index = block_class_index;
     hb.path = path;
     hb.x = static_cast<double>(btn_x);
     hb.y = static_cast<double>(btn_y);
     hb.w = static_cast<double>(ctx.f_nested_button_size);
     hb.h = static_cast<double>(ctx.f_nested_button_size);
-    ctx.out_hit_buttons->push_back(std::move(hb));
+    ctx.out_hit_buttons->push_back(hb);
 }
 
 // Draw a small navigation arrow button (right-pointing triangle).
@@ -152,32 +202,32 @@ void draw_nav_button(const RenderContext& ctx, float btn_x, float btn_y) {
 
 // Record a hit region for a navigation button.
 void record_nav_button(const RenderContext& ctx,
-    const std::string& target_class_id,
+    std::uint32_t target_class_index,
     float btn_x, float btn_y)
 {
     if (!ctx.out_nav_buttons) return;
     NavHitButton nb;
-    nb.target_class_id = target_class_id;
+    nb.target_class_index = target_class_index;
     nb.x = static_cast<double>(btn_x);
     nb.y = static_cast<double>(btn_y);
     nb.w = static_cast<double>(ctx.f_nav_button_size);
     nb.h = static_cast<double>(ctx.f_nav_button_size);
-    ctx.out_nav_buttons->push_back(std::move(nb));
+    ctx.out_nav_buttons->push_back(nb);
 }
 
 // Record a hover region that maps an area to a target class.
 void record_hover_region(const RenderContext& ctx,
-    const std::string& target_class_id,
+    std::uint32_t target_class_index,
     float rx, float ry, float rw, float rh)
 {
     if (!ctx.out_hover_regions) return;
     ClassHoverRegion hr;
-    hr.target_class_id = target_class_id;
+    hr.target_class_index = target_class_index;
     hr.x = static_cast<double>(rx);
     hr.y = static_cast<double>(ry);
     hr.w = static_cast<double>(rw);
     hr.h = static_cast<double>(rh);
-    ctx.out_hover_regions->push_back(std::move(hr));
+    ctx.out_hover_regions->push_back(hr);
 }
 
 // Colors for a nested card (mini-block drawn inside a parent card).
@@ -191,13 +241,13 @@ struct NestedCardColors {
 // Caller provides exact card bounds (no internal padding applied here).
 // Uses draw list channels: card background/header on channel 0,
 // border + header text on channel 1 (so they render on top of row backgrounds).
-// Draw a nested card frame. If collapse_key is non-empty, draw collapse [-] and nav [->] buttons on the header.
+// Draw a nested card frame. If collapse_key is set, draw collapse [-] and nav [->] buttons on the header.
 void draw_nested_card(const RenderContext& ctx,
     float card_left, float card_top, float card_right, float card_bottom,
     const char* class_name, const NestedCardColors& colors,
-    const std::string& block_class_id = {},
-    const std::string& collapse_key = {},
-    const std::string& nav_target_class_id = {})
+    std::uint32_t block_class_index = 0,
+    NestedPathKey collapse_key = 0,
+    std::int32_t nav_target_class = -1)
 {
     const float card_rounding = 6.0f;
     const float border_thickness = 2.0f;
@@ -227,403 +277,407 @@ void draw_nested_card(const RenderContext& ctx,
 
     const float text_pad = 6.0f;
     const float text_y = card_top + (f_header_h - ctx.font_world_height) * 0.5f;
-    ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-        world_to_screen(card_left + text_pad, text_y, ctx.offset_x, ctx.offset_y, ctx.zoom),
-        ctx.text_color, class_name);
+    draw_card_text(ctx, card_left + text_pad, text_y, ctx.text_color, class_name);
 
     // Collapse [-] button on card header (right side).
-    if (!collapse_key.empty()) {
+    if (collapse_key != 0) {
         const float btn_x = card_right - text_pad - ctx.f_nested_button_size;
         const float btn_y = card_top + (f_header_h - ctx.f_nested_button_size) * 0.5f;
         draw_nested_button(ctx, btn_x, btn_y, true); // always shows [-] since it's expanded
-        record_hit_button(ctx, block_class_id, collapse_key, btn_x, btn_y);
+        record_hit_button(ctx, block_class_index, collapse_key, btn_x, btn_y);
 
         // Nav [->] button to the left of collapse button.
-        if (!nav_target_class_id.empty()) {
+        if (nav_target_class >= 0) {
             const float nav_x = btn_x - ctx.f_nav_button_gap - ctx.f_nav_button_size;
             const float nav_y = card_top + (f_header_h - ctx.f_nav_button_size) * 0.5f;
             draw_nav_button(ctx, nav_x, nav_y);
-            record_nav_button(ctx, nav_target_class_id, nav_x, nav_y);
+            record_nav_button(ctx, static_cast<std::uint32_t>(nav_target_class), nav_x, nav_y);
         }
     }
 }
 
-// Recursively render the 4 content sections (Parent, Properties, Components, Children)
-// of a class inside a block card.
-// area_left, area_right: content area bounds (rows are drawn within these).
-// cy: current y position (world); returns the new cy after rendering.
-// depth: nesting depth (0 = direct content of the block), used for depth limit.
-// path_prefix: tree path prefix, e.g. "Player/" or "Player/parent/".
-// block_class_id: the top-level block's class id (for hit button recording).
-// visited: set of class ids already on the current expansion path (cycle guard).
-float render_class_content(
+// Draw the content sections of an expanded block from its layout. Only rows and nested cards
+// that reach into [ctx.visible_top, ctx.visible_bottom] are drawn; rows are sorted by top, so
+// the first one is found by binary search.
+// area_left, area_right: the block's content area; content_top: world y of layout y 0.
+// block_class_index: the top-level block's class (for hit button recording).
+void draw_card_content(
     const RenderContext& ctx,
-    const diagram_model::DiagramClass& cls,
+    const detail::CardLayout& layout,
     float area_left, float area_right,
-    float cy,
-    int depth,
-    const std::string& path_prefix,
-    const std::string& block_class_id,
-    std::unordered_set<std::string>& visited)
+    float content_top,
+    std::uint32_t block_class_index)
 {
-    const float content_x = area_left;
-    const float content_right = area_right;
-    const float content_w = content_right - content_x;
-    if (content_w <= 0.0f) return cy;
-
-    const float list_text_left = content_x + static_cast<float>(content_left_offset());
-    const float item_left = std::max(content_x,
-        list_text_left - (ctx.f_accent_bar_width + ctx.f_content_indent));
-
-    // --- Lambdas for drawing rows ---
+    const float row_h = ctx.f_row_height_effective;
+    const float pad_x = static_cast<float>(nested_card_pad_x);
+
+    struct SectionColors {
+        unsigned int bg;
+        unsigned int accent;
+        unsigned int header;
+        const char* label;
+    };
+    const SectionColors sections[4] = {
+        { ctx.parent_bg, ctx.parent_accent, ctx.parent_header_color, "Parent:" },
+        { ctx.properties_bg, ctx.properties_accent, ctx.properties_header_color, "Properties:" },
+        { ctx.components_bg, ctx.components_accent, ctx.components_header_color, "Components:" },
+        { ctx.children_bg, ctx.children_accent, ctx.children_header_color, "Children:" },
+    };
 
-    auto draw_row_background = [&](float row_left, float row_top,
-        unsigned int sect_bg, unsigned int sect_accent)
-    {
+    auto draw_row_background = [&](float row_left, float row_right, float row_top, const SectionColors& colors) {
         ImVec2 sect_min = world_to_screen(row_left, row_top, ctx.offset_x, ctx.offset_y, ctx.zoom);
-        ImVec2 sect_max = world_to_screen(content_right, row_top + ctx.f_row_height_effective,
+        ImVec2 sect_max = world_to_screen(row_right, row_top + row_h, ctx.offset_x, ctx.offset_y, ctx.zoom);
+        ctx.draw_list->AddRectFilled(sect_min, sect_max, colors.bg, ctx.section_rounding);
+        ImVec2 accent_max = world_to_screen(row_left + ctx.f_accent_bar_width, row_top + row_h,
             ctx.offset_x, ctx.offset_y, ctx.zoom);
-        ctx.draw_list->AddRectFilled(sect_min, sect_max, sect_bg, ctx.section_rounding);
-        ImVec2 accent_min = world_to_screen(row_left, row_top, ctx.offset_x, ctx.offset_y, ctx.zoom);
-        ImVec2 accent_max = world_to_screen(row_left + ctx.f_accent_bar_width,
-            row_top + ctx.f_row_height_effective, ctx.offset_x, ctx.offset_y, ctx.zoom);
-        ctx.draw_list->AddRectFilled(accent_min, accent_max, sect_accent);
+        ctx.draw_list->AddRectFilled(sect_min, accent_max, colors.accent);
     };
 
-    auto row_text_y = [&](float row_top) {
-        return row_top + (ctx.f_row_height_effective - ctx.font_world_height) * 0.5f;
+    auto draw_text = [&](float text_x, float text_y, unsigned int color, const char* begin, const char* end) {
+        draw_card_text(ctx, text_x, text_y, color, begin, end);
     };
 
-    auto draw_row_text = [&](float row_top, unsigned int color, const char* text) {
-        ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-            world_to_screen(list_text_left, row_text_y(row_top), ctx.offset_x, ctx.offset_y, ctx.zoom),
-            color, text);
-    };
-
-    auto draw_typed_row_text = [&](float row_top, const std::string& type_part,
-        const std::string& name_part)
-    {
-        const std::string type_colon = type_part + ": ";
-        ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-            world_to_screen(list_text_left, row_text_y(row_top), ctx.offset_x, ctx.offset_y, ctx.zoom),
-            ctx.type_muted_color, type_colon.c_str());
-        const float type_w = ctx.font->CalcTextSizeA(ctx.scaled_font_size, FLT_MAX, 0.0f,
-            type_colon.c_str(), nullptr).x / ctx.safe_zoom;
-        ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-            world_to_screen(list_text_left + type_w, row_text_y(row_top),
-                ctx.offset_x, ctx.offset_y, ctx.zoom),
-            ctx.text_color, name_part.c_str());
+    // "type: name = default" from the row cache: muted type, name, muted default value.
+    // Cached widths are world units, so segments are placed without measuring per frame.
+    auto draw_typed_row_text = [&](float text_x, float text_y, const ClassRowText& row) {
+        const char* text = row.text.data();
+        draw_text(text_x, text_y, ctx.type_muted_color, text, text + row.name_begin);
+        draw_text(text_x + row.type_width, text_y, ctx.text_color, text + row.name_begin, text + row.name_end);
+        if (row.name_end < row.text.size()) {
+            draw_text(text_x + row.type_width + row.name_width, text_y, ctx.type_muted_color,
+                text + row.name_end, text + row.text.size());
+        }
     };
 
-    auto draw_property_row_text = [&](float row_top, const diagram_model::Property& p,
-        float extra_indent)
-    {
-        const float text_x = list_text_left + extra_indent;
-        const std::string type_colon = p.type + ": ";
-        ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-            world_to_screen(text_x, row_text_y(row_top), ctx.offset_x, ctx.offset_y, ctx.zoom),
-            ctx.type_muted_color, type_colon.c_str());
-
-        const float type_w = ctx.font->CalcTextSizeA(ctx.scaled_font_size, FLT_MAX, 0.0f,
-            type_colon.c_str(), nullptr).x / ctx.safe_zoom;
-        ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-            world_to_screen(text_x + type_w, row_text_y(row_top),
-                ctx.offset_x, ctx.offset_y, ctx.zoom),
-            ctx.text_color, p.name.c_str());
-
-        if (!p.default_value.empty()) {
-            const float name_w = ctx.font->CalcTextSizeA(ctx.scaled_font_size, FLT_MAX, 0.0f,
-                p.name.c_str(), nullptr).x / ctx.safe_zoom;
-            const std::string default_text = " = " + p.default_value;
-            ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-                world_to_screen(text_x + type_w + name_w, row_text_y(row_top),
-                    ctx.offset_x, ctx.offset_y, ctx.zoom),
-                ctx.type_muted_color, default_text.c_str());
+    const auto& rows = layout.rows;
+    const float first_top = ctx.visible_top - content_top - row_h;
+    auto it = std::lower_bound(rows.begin(), rows.end(), first_top,
+        [](const detail::CardLayoutRow& row, float top) { return row.top < top; });
+    for (; it != rows.end(); ++it) {
+        const detail::CardLayoutRow& row = *it;
+        const float row_top = content_top + row.top;
+        if (row_top > ctx.visible_bottom) break;
+        const float inset = static_cast<float>(row.depth) * pad_x;
+        const float content_x = area_left + inset;
+        const float content_right = area_right - inset;
+        if (content_right <= content_x) continue;
+        const float list_text_left = content_x + static_cast<float>(content_left_offset());
+        const float item_left = std::max(content_x,
+            list_text_left - (ctx.f_accent_bar_width + ctx.f_content_indent));
+        const float text_y = row_top + (row_h - ctx.font_world_height) * 0.5f;
+        const SectionColors& colors = sections[static_cast<int>(row.section)];
+        const ClassRows& class_rows = ctx.cache.rows(row.class_index);
+
+        switch (row.kind) {
+        case detail::CardRowKind::Header:
+            draw_row_background(content_x, content_right, row_top, colors);
+            draw_text(list_text_left, text_y, colors.header, colors.label, nullptr);
+            continue;
+        case detail::CardRowKind::Empty:
+            draw_row_background(item_left, content_right, row_top, colors);
+            draw_text(list_text_left, text_y, ctx.empty_color, "\xE2\x80\x94", nullptr);
+            continue;
+        case detail::CardRowKind::Property:
+            draw_row_background(item_left, content_right, row_top, colors);
+            draw_typed_row_text(list_text_left, text_y, class_rows.properties[row.item]);
+            continue;
+        case detail::CardRowKind::Component:
+            draw_row_background(item_left, content_right, row_top, colors);
+            draw_typed_row_text(list_text_left, text_y, class_rows.components[row.item]);
+            continue;
+        case detail::CardRowKind::ComponentProperty: {
+            const float sub_indent = ctx.f_content_indent * 2.0f;
+            draw_row_background(item_left + sub_indent, content_right, row_top, colors);
+            draw_typed_row_text(list_text_left + sub_indent, text_y, class_rows.component_properties[row.item]);
+            continue;
+        }
+        case detail::CardRowKind::Parent:
+        case detail::CardRowKind::Child:
+            break;
         }
-    };
 
-    // --- Group: Parent ---
-    {
-        const float row_top = cy;
-        draw_row_background(content_x, row_top, ctx.parent_bg, ctx.parent_accent);
-        draw_row_text(row_top, ctx.parent_header_color, "Parent:");
-        cy += ctx.f_row_height_effective + ctx.f_row_inner_gap_effective;
-    }
-    if (!cls.parent_class_ids.empty()) {
-        for (std::size_t pi = 0; pi < cls.parent_class_ids.size(); ++pi) {
-            const diagram_model::DiagramClass* parent_cls = find_class(ctx.diagram, cls.parent_class_ids[pi]);
-            const char* parent_name = parent_cls
-                ? parent_cls->type_name.c_str() : cls.parent_class_ids[pi].c_str();
-
-            const std::string parent_key = path_prefix + "parent/" + std::to_string(pi);
-            const bool parent_is_cycle = parent_cls && visited.find(parent_cls->id) != visited.end();
-            const bool can_expand = parent_cls && !parent_is_cycle
-                && depth + 1 < max_nesting_depth;
-            const bool is_expanded = can_expand && is_nested_expanded(ctx.nested_expanded, parent_key);
-
-            if (is_expanded) {
-                // Expanded: row transforms into the card directly (no separate row).
-                visited.insert(parent_cls->id);
-                const float card_left = content_x;
-                const float card_right = content_right;
-                const float card_top = cy;
-                cy += static_cast<float>(nested_header_height);
-                cy += static_cast<float>(nested_card_content_inset_top);
-                const float inner_left = card_left + static_cast<float>(nested_card_pad_x);
-                const float inner_right = card_right - static_cast<float>(nested_card_pad_x);
-                cy = render_class_content(ctx, *parent_cls, inner_left, inner_right,
-                    cy, depth + 1, parent_key + "/", block_class_id, visited);
-                cy += static_cast<float>(nested_card_content_inset_bottom);
-                const NestedCardColors parent_colors {
-                    ctx.parent_card_bg, ctx.parent_card_border,
-                    ctx.parent_card_header_bg };
-                draw_nested_card(ctx, card_left, card_top, card_right, cy,
-                    parent_name, parent_colors,
-                    block_class_id, parent_key, parent_cls->id);
-                // Hover region covers the card header.
-                record_hover_region(ctx, parent_cls->id,
-                    card_left, card_top, card_right - card_left, static_cast<float>(nested_header_height));
-                visited.erase(parent_cls->id);
-            } else {
-                // Collapsed: draw the row with name + buttons.
-                const float row_top = cy;
-                draw_row_background(item_left, row_top, ctx.parent_bg, ctx.parent_accent);
-                draw_row_text(row_top, ctx.text_color, parent_name);
-
-                if (can_expand) {
-                    const float nbtn_x = content_right - ctx.f_nested_button_size;
-                    const float nbtn_y = row_top + (ctx.f_row_height_effective - ctx.f_nested_button_size) * 0.5f;
-                    draw_nested_button(ctx, nbtn_x, nbtn_y, false);
-                    record_hit_button(ctx, block_class_id, parent_key, nbtn_x, nbtn_y);
-                    const float nav_x = nbtn_x - ctx.f_nav_button_gap - ctx.f_nav_button_size;
-                    const float nav_y = row_top + (ctx.f_row_height_effective - ctx.f_nav_button_size) * 0.5f;
-                    draw_nav_button(ctx, nav_x, nav_y);
-                    record_nav_button(ctx, parent_cls->id, nav_x, nav_y);
-                } else if (parent_is_cycle) {
-                    const float cycle_x = content_right - ctx.font->CalcTextSizeA(
-                        ctx.scaled_font_size, FLT_MAX, 0.0f, "(cycle)", nullptr).x / ctx.safe_zoom;
-                    ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-                        world_to_screen(cycle_x, row_text_y(row_top),
-                            ctx.offset_x, ctx.offset_y, ctx.zoom),
-                        ctx.empty_color, "(cycle)");
-                }
-                if (parent_cls && !can_expand) {
-                    const float nav_x = content_right - ctx.f_nav_button_size;
-                    const float nav_y = row_top + (ctx.f_row_height_effective - ctx.f_nav_button_size) * 0.5f;
-                    draw_nav_button(ctx, nav_x, nav_y);
-                    record_nav_button(ctx, parent_cls->id, nav_x, nav_y);
-                }
-                if (parent_cls) {
-                    record_hover_region(ctx, parent_cls->id,
-                        item_left, row_top, content_right - item_left, ctx.f_row_height_effective);
-                }
-                cy += ctx.f_row_height_effective;
-            }
+        // Collapsed parent / child row: name, [+] and nav buttons or the cycle marker.
+        const diagram_model::DiagramClass* target = row.target >= 0 ? &ctx.diagram.classes[row.target] : nullptr;
+        draw_row_background(item_left, content_right, row_top, colors);
+        if (row.kind == detail::CardRowKind::Parent) {
+            const char* name = target ? target->type_name.c_str()
+                : ctx.diagram.classes[row.class_index].parent_class_ids[row.item].c_str();
+            draw_text(list_text_left, text_y, ctx.text_color, name, nullptr);
+        } else {
+            draw_typed_row_text(list_text_left, text_y, class_rows.child_rows[row.item]);
+        }
 
-            if (pi + 1 < cls.parent_class_ids.size())
-                cy += ctx.f_row_inner_gap_effective;
+        if (row.key != detail::no_card_key) {
+            const float nbtn_x = content_right - ctx.f_nested_button_size;
+            const float nbtn_y = row_top + (row_h - ctx.f_nested_button_size) * 0.5f;
+            draw_nested_button(ctx, nbtn_x, nbtn_y, false);
+            record_hit_button(ctx, block_class_index, layout.keys[row.key], nbtn_x, nbtn_y);
+            const float nav_x = nbtn_x - ctx.f_nav_button_gap - ctx.f_nav_button_size;
+            const float nav_y = row_top + (row_h - ctx.f_nav_button_size) * 0.5f;
+            draw_nav_button(ctx, nav_x, nav_y);
+            record_nav_button(ctx, static_cast<std::uint32_t>(row.target), nav_x, nav_y);
+        } else if (row.cycle) {
+            draw_text(content_right - ctx.cache.cycle_label_width(), text_y, ctx.empty_color, "(cycle)", nullptr);
+        }
+        if (target && row.key == detail::no_card_key) {
+            const float nav_x = content_right - ctx.f_nav_button_size;
+            const float nav_y = row_top + (row_h - ctx.f_nav_button_size) * 0.5f;
+            draw_nav_button(ctx, nav_x, nav_y);
+            record_nav_button(ctx, static_cast<std::uint32_t>(row.target), nav_x, nav_y);
+        }
+        if (target) {
+            record_hover_region(ctx, static_cast<std::uint32_t>(row.target), item_left, row_top, content_right - item_left, row_h);
         }
-    } else {
-        const float row_top = cy;
-        draw_row_background(item_left, row_top, ctx.parent_bg, ctx.parent_accent);
-        draw_row_text(row_top, ctx.empty_color, "\xE2\x80\x94");
-        cy += ctx.f_row_height_effective;
     }
-    cy += ctx.f_group_vertical_gap_effective;
-
-    // --- Group: Properties ---
-    {
-        const float row_top = cy;
-        draw_row_background(content_x, row_top, ctx.properties_bg, ctx.properties_accent);
-        draw_row_text(row_top, ctx.properties_header_color, "Properties:");
-        cy += ctx.f_row_height_effective + ctx.f_row_inner_gap_effective;
+
+    // Nested cards after the rows, so their borders and header buttons are on top; inner cards
+    // come first, as the frames close.
+    const NestedCardColors parent_colors { ctx.parent_card_bg, ctx.parent_card_border, ctx.parent_card_header_bg };
+    const NestedCardColors child_colors { ctx.child_card_bg, ctx.child_card_border, ctx.child_card_header_bg };
+    for (const detail::CardLayoutFrame& frame : layout.frames) {
+        const float card_top = content_top + frame.top;
+        const float card_bottom = content_top + frame.bottom;
+        if (card_bottom < ctx.visible_top || card_top > ctx.visible_bottom) continue;
+        const float inset = static_cast<float>(frame.depth) * pad_x;
+        const float card_left = area_left + inset;
+        const float card_right = area_right - inset;
+        if (card_right <= card_left) continue;
+        const diagram_model::DiagramClass& target = ctx.diagram.classes[frame.target];
+        const bool parent = frame.section == detail::CardSection::Parent;
+        // Parent cards show the type name, child cards "Type: label" like the collapsed row.
+        const char* title = parent ? target.type_name.c_str()
+            : ctx.cache.rows(frame.class_index).child_rows[frame.item].text.c_str();
+        draw_nested_card(ctx, card_left, card_top, card_right, card_bottom, title,
+            parent ? parent_colors : child_colors, block_class_index, layout.keys[frame.key], frame.target);
+        // Hover region covers the card header.
+        record_hover_region(ctx, static_cast<std::uint32_t>(frame.target),
+            card_left, card_top, card_right - card_left, static_cast<float>(nested_header_height));
     }
-    if (!cls.properties.empty()) {
-        for (size_t i = 0; i < cls.properties.size(); ++i) {
-            const auto& p = cls.properties[i];
-            const float row_top = cy;
-            draw_row_background(item_left, row_top, ctx.properties_bg, ctx.properties_accent);
-            draw_property_row_text(row_top, p, 0.0f);
-            cy += ctx.f_row_height_effective;
-            if (i + 1 < cls.properties.size())
-                cy += ctx.f_row_inner_gap_effective;
-        }
+}
+
+// Inheritance (empty triangle) or composition (filled diamond) marker at seg[2..3],
+// pointing along the segment seg[0..1] -> seg[2..3].
+void draw_connection_marker(detail::LineBatch& batch, diagram_placement::ConnectionKind kind, const float* seg,
+    unsigned int color, float thickness, float offset_x, float offset_y, float zoom, float marker_size)
+{
+    const float last_x = seg[2];
+    const float last_y = seg[3];
+    ImVec2 tip = world_to_screen(last_x, last_y, offset_x, offset_y, zoom);
+    float dx = last_x - seg[0];
+    float dy = last_y - seg[1];
+    float len = std::sqrt(dx * dx + dy * dy);
+    if (len <= 1e-4f) return;
+    dx /= len; dy /= len;
+    float px = -dy, py = dx; // perpendicular
+    if (kind != diagram_placement::ConnectionKind::Composition) {
+        // Empty triangle marker.
+        const ImVec2 triangle[3] = {
+            tip,
+            ImVec2(tip.x - dx * marker_size + px * marker_size * 0.5f,
+                   tip.y - dy * marker_size + py * marker_size * 0.5f),
+            ImVec2(tip.x - dx * marker_size - px * marker_size * 0.5f,
+                   tip.y - dy * marker_size - py * marker_size * 0.5f),
+        };
+        batch.add_polyline(triangle, 3, color, thickness, true);
     } else {
-        const float row_top = cy;
-        draw_row_background(item_left, row_top, ctx.properties_bg, ctx.properties_accent);
-        draw_row_text(row_top, ctx.empty_color, "\xE2\x80\x94");
-        cy += ctx.f_row_height_effective;
-    }
-    cy += ctx.f_group_vertical_gap_effective;
-
-    // --- Group: Components ---
-    {
-        const float row_top = cy;
-        draw_row_background(content_x, row_top, ctx.components_bg, ctx.components_accent);
-        draw_row_text(row_top, ctx.components_header_color, "Components:");
-        cy += ctx.f_row_height_effective + ctx.f_row_inner_gap_effective;
+        // Filled diamond marker for composition.
+        float hs = marker_size * 0.5f;
+        const ImVec2 diamond[4] = {
+            tip,
+            ImVec2(tip.x - dx * hs + px * hs * 0.5f, tip.y - dy * hs + py * hs * 0.5f),
+            ImVec2(tip.x - dx * marker_size, tip.y - dy * marker_size),
+            ImVec2(tip.x - dx * hs - px * hs * 0.5f, tip.y - dy * hs - py * hs * 0.5f),
+        };
+        batch.add_convex_filled(diamond, 4, color);
     }
-    if (!cls.components.empty()) {
-        for (size_t i = 0; i < cls.components.size(); ++i) {
-            const auto& comp = cls.components[i];
-            const float row_top = cy;
-            draw_row_background(item_left, row_top, ctx.components_bg, ctx.components_accent);
-            draw_typed_row_text(row_top, comp.type, comp.name);
-            cy += ctx.f_row_height_effective;
-
-            if (!comp.properties.empty() || i + 1 < cls.components.size())
-                cy += ctx.f_row_inner_gap_effective;
-
-            const float sub_item_left = item_left + ctx.f_content_indent * 2.0f;
-            const float sub_text_indent = ctx.f_content_indent * 2.0f;
-            for (size_t j = 0; j < comp.properties.size(); ++j) {
-                const auto& p = comp.properties[j];
-                const float sub_row_top = cy;
-                draw_row_background(sub_item_left, sub_row_top,
-                    ctx.components_bg, ctx.components_accent);
-                draw_property_row_text(sub_row_top, p, sub_text_indent);
-                cy += ctx.f_row_height_effective;
-                if (j + 1 < comp.properties.size() || i + 1 < cls.components.size())
-                    cy += ctx.f_row_inner_gap_effective;
-            }
-        }
+}
+
+// Block card at Header or Full detail: frame, header with title and expand button, and for
+// expanded blocks at Full detail the content sections laid out by `layout`.
+void draw_class_card(const RenderContext& ctx,
+    const diagram_placement::PlacedClassBlock& block,
+    const diagram_model::DiagramClass& cl,
+    ClassBlockLod lod,
+    const detail::CardLayout* layout)
+{
+    ImDrawList* draw_list = ctx.draw_list;
+    const float line_thickness = 2.0f;
+    const float block_rounding = 8.0f;
+    const float f_padding = static_cast<float>(padding);
+    const float f_button_size = static_cast<float>(button_size);
+    const float f_header_height = static_cast<float>(header_height);
+    const float f_content_inset_side = static_cast<float>(content_inset_side);
+    const float f_header_content_gap = static_cast<float>(header_content_gap);
+
+    const float x = static_cast<float>(block.rect.x);
+    const float y = static_cast<float>(block.rect.y);
+    const float w = static_cast<float>(block.rect.width);
+    const float h = static_cast<float>(block.rect.height);
+    const ImVec2 min_pt = world_to_screen(x, y, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    const ImVec2 max_pt = world_to_screen(x + w, y + h, ctx.offset_x, ctx.offset_y, ctx.zoom);
+
+    draw_list->AddRectFilled(min_pt, max_pt, ctx.block_bg, block_rounding);
+    draw_list->AddRect(min_pt, max_pt, ctx.border_color, block_rounding, 0, line_thickness);
+
+    draw_list->PushClipRect(min_pt, max_pt, true);
+
+    // --- Header ---
+    ImVec2 header_min = min_pt;
+    ImVec2 header_max = world_to_screen(x + w, y + f_header_height, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    draw_list->AddRectFilled(header_min, header_max, ctx.header_bg,
+        block_rounding, ImDrawFlags_RoundCornersTop);
+    ImVec2 header_sep_left = world_to_screen(x, y + f_header_height, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    ImVec2 header_sep_right = world_to_screen(x + w, y + f_header_height, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    draw_list->AddLine(header_sep_left, header_sep_right, ctx.border_color, 1.0f);
+
+    // Main expand/collapse button.
+    float btn_x = x + w - f_padding - f_button_size;
+    float btn_y = y + (f_header_height - f_button_size) * 0.5f;
+    ImVec2 btn_min = world_to_screen(btn_x, btn_y, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    ImVec2 btn_max = world_to_screen(btn_x + f_button_size, btn_y + f_button_size, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    draw_list->AddRectFilled(btn_min, btn_max, ctx.button_bg);
+    draw_list->AddRect(btn_min, btn_max, ctx.border_color, 0.0f, 0, 1.0f);
+
+    float text_left = x + f_padding;
+    float text_y = y + (f_header_height - ctx.font_world_height) * 0.5f;
+    draw_card_text(ctx, text_left, text_y, ctx.text_color, cl.type_name.c_str());
+
+    ImVec2 plus_center = world_to_screen(btn_x + f_button_size * 0.5f,
+        btn_y + f_button_size * 0.5f, ctx.offset_x, ctx.offset_y, ctx.zoom);
+    float plus_half = 4.0f * ctx.zoom;
+    if (block.expanded) {
+        draw_list->AddLine(
+            ImVec2(plus_center.x - plus_half, plus_center.y),
+            ImVec2(plus_center.x + plus_half, plus_center.y), ctx.text_color, 1.5f);
     } else {
-        const float row_top = cy;
-        draw_row_background(item_left, row_top, ctx.components_bg, ctx.components_accent);
-        draw_row_text(row_top, ctx.empty_color, "\xE2\x80\x94");
-        cy += ctx.f_row_height_effective;
+        draw_list->AddLine(
+            ImVec2(plus_center.x - plus_half, plus_center.y),
+            ImVec2(plus_center.x + plus_half, plus_center.y), ctx.text_color, 1.5f);
+        draw_list->AddLine(
+            ImVec2(plus_center.x, plus_center.y - plus_half),
+            ImVec2(plus_center.x, plus_center.y + plus_half), ctx.text_color, 1.5f);
     }
-    cy += ctx.f_group_vertical_gap_effective;
-
-    // --- Group: Children ---
-    {
-        const float row_top = cy;
-        draw_row_background(content_x, row_top, ctx.children_bg, ctx.children_accent);
-        draw_row_text(row_top, ctx.children_header_color, "Children:");
-        cy += ctx.f_row_height_effective + ctx.f_row_inner_gap_effective;
+
+    if (!block.expanded || lod == ClassBlockLod::Header || !layout) {
+        draw_list->PopClipRect();
+        return;
     }
-    if (!cls.child_objects.empty()) {
-        for (size_t i = 0; i < cls.child_objects.size(); ++i) {
-            const auto& co = cls.child_objects[i];
-            const diagram_model::DiagramClass* child_class = find_class(ctx.diagram, co.class_id);
-            const char* type_name = child_class
-                ? child_class->type_name.c_str() : co.class_id.c_str();
-            const std::string name_part = co.label.empty() ? std::string(type_name) : co.label;
-
-            const std::string child_key = path_prefix + "child/" + std::to_string(i);
-            const bool child_is_cycle = child_class && visited.find(child_class->id) != visited.end();
-            const bool can_expand = child_class && !child_is_cycle
-                && depth + 1 < max_nesting_depth;
-            const bool is_expanded = can_expand && is_nested_expanded(ctx.nested_expanded, child_key);
-
-            if (is_expanded) {
-                // Expanded: row transforms into the card directly.
-                visited.insert(child_class->id);
-                const float card_left = content_x;
-                const float card_right = content_right;
-                const float card_top = cy;
-                cy += static_cast<float>(nested_header_height);
-                cy += static_cast<float>(nested_card_content_inset_top);
-                const float inner_left = card_left + static_cast<float>(nested_card_pad_x);
-                const float inner_right = card_right - static_cast<float>(nested_card_pad_x);
-                cy = render_class_content(ctx, *child_class, inner_left, inner_right,
-                    cy, depth + 1, child_key + "/", block_class_id, visited);
-                cy += static_cast<float>(nested_card_content_inset_bottom);
-                // Card header shows "Type: label" like the collapsed row.
-                std::string card_title = std::string(type_name) + ": " + name_part;
-                const NestedCardColors child_colors {
-                    ctx.child_card_bg, ctx.child_card_border,
-                    ctx.child_card_header_bg };
-                draw_nested_card(ctx, card_left, card_top, card_right, cy,
-                    card_title.c_str(), child_colors,
-                    block_class_id, child_key, child_class->id);
-                record_hover_region(ctx, child_class->id,
-                    card_left, card_top, card_right - card_left, static_cast<float>(nested_header_height));
-                visited.erase(child_class->id);
-            } else {
-                // Collapsed: draw the row.
-                const float row_top = cy;
-                draw_row_background(item_left, row_top, ctx.children_bg, ctx.children_accent);
-                draw_typed_row_text(row_top, type_name, name_part);
-
-                if (can_expand) {
-                    const float nbtn_x = content_right - ctx.f_nested_button_size;
-                    const float nbtn_y = row_top + (ctx.f_row_height_effective - ctx.f_nested_button_size) * 0.5f;
-                    draw_nested_button(ctx, nbtn_x, nbtn_y, false);
-                    record_hit_button(ctx, block_class_id, child_key, nbtn_x, nbtn_y);
-                    const float nav_x = nbtn_x - ctx.f_nav_button_gap - ctx.f_nav_button_size;
-                    const float nav_y = row_top + (ctx.f_row_height_effective - ctx.f_nav_button_size) * 0.5f;
-                    draw_nav_button(ctx, nav_x, nav_y);
-                    record_nav_button(ctx, child_class->id, nav_x, nav_y);
-                } else if (child_is_cycle) {
-                    const float cycle_x = content_right - ctx.font->CalcTextSizeA(
-                        ctx.scaled_font_size, FLT_MAX, 0.0f, "(cycle)", nullptr).x / ctx.safe_zoom;
-                    ctx.draw_list->AddText(ctx.font, ctx.scaled_font_size,
-                        world_to_screen(cycle_x, row_text_y(row_top),
-                            ctx.offset_x, ctx.offset_y, ctx.zoom),
-                        ctx.empty_color, "(cycle)");
-                }
-                if (child_class && !can_expand) {
-                    const float nav_x = content_right - ctx.f_nav_button_size;
-                    const float nav_y = row_top + (ctx.f_row_height_effective - ctx.f_nav_button_size) * 0.5f;
-                    draw_nav_button(ctx, nav_x, nav_y);
-                    record_nav_button(ctx, child_class->id, nav_x, nav_y);
-                }
-                if (child_class) {
-                    record_hover_region(ctx, child_class->id,
-                        item_left, row_top, content_right - item_left, ctx.f_row_height_effective);
-                }
-                cy += ctx.f_row_height_effective;
-            }
 
-            if (i + 1 < cls.child_objects.size())
-                cy += ctx.f_row_inner_gap_effective;
-        }
-    } else {
-        const float row_top = cy;
-        draw_row_background(item_left, row_top, ctx.children_bg, ctx.children_accent);
-        draw_row_text(row_top, ctx.empty_color, "\xE2\x80\x94");
-        cy += ctx.f_row_height_effective;
+    // --- Content (4 sections, nested cards) ---
+    // Use draw list channels so nested frame backgrounds go behind content:
+    //   channel 0 = frame backgrounds + accents
+    //   channel 1 = row content + frame borders
+    draw_list->ChannelsSplit(2);
+    draw_list->ChannelsSetCurrent(1);
+
+    const float content_top = y + f_header_height + static_cast<float>(content_inset_top) + f_header_content_gap;
+    draw_card_content(ctx, *layout, x + f_content_inset_side, x + w - f_content_inset_side,
+        content_top, static_cast<std::uint32_t>(&cl - ctx.diagram.classes.data()));
+
+    draw_list->ChannelsMerge();
+    draw_list->PopClipRect();
+}
+
+// Hit/hover regions of a replayed card, moved from card-local to world coordinates.
+template <class T>
+void append_card_regions(const std::vector<T>& regions, std::vector<T>* out, double x, double y) {
+    if (!out) return;
+    for (const T& r : regions) {
+        out->push_back(r);
+        out->back().x += x;
+        out->back().y += y;
     }
+}
+
+// Zoom a card is recorded at: zoom rounded to 1/8 octave, so replays scale by at most ~4%
+// and text is rasterized at a size close to the one on screen.
+float card_zoom_step(float zoom) {
+    return std::exp2(std::round(std::log2(std::max(zoom, 1e-4f)) * 8.0f) / 8.0f);
+}
 
-    return cy;
+// Fewer stale cards than this are recorded on the calling thread.
+constexpr std::size_t parallel_record_min_cards = 4;
+// Builds the cached rows a card layout draws, so recording workers only read them.
+void build_layout_rows(ClassDiagramRenderCache& cache, const detail::CardLayout& layout) {
+    for (const detail::CardLayoutRow& row : layout.rows) cache.rows(row.class_index);
+    for (const detail::CardLayoutFrame& frame : layout.frames) cache.rows(frame.class_index);
 }
 
+// Retained cards are recorded whole; a card taller than this many views is drawn directly.
+constexpr double retained_card_max_view_heights = 2.0;
+
+// LOD thresholds in screen pixels.
+constexpr float lod_full_header_px = 11.0f;   // header tall enough for readable rows (~zoom 0.4)
+constexpr float lod_header_px = 5.0f;         // header bar still distinguishable
+constexpr float lod_box_px = 3.0f;            // larger side of the block
+constexpr float lod_cluster_cell_px = 4.0f;   // Point tier: one square per cell this size
+
 } // namespace
 
+ClassBlockLod class_block_lod(double width, double height, float zoom) {
+    const float header_px = static_cast<float>(header_height) * zoom;
+    if (header_px >= lod_full_header_px) return ClassBlockLod::Full;
+    if (header_px >= lod_header_px) return ClassBlockLod::Header;
+    if (static_cast<float>(std::max(width, height)) * zoom >= lod_box_px) return ClassBlockLod::Box;
+    return ClassBlockLod::Point;
+}
+
 void render_class_diagram(ImDrawList* draw_list,
     const diagram_model::ClassDiagram& diagram,
     const diagram_placement::PlacedClassDiagram& placed,
     float offset_x, float offset_y, float zoom,
-    const std::unordered_map<std::string, bool>& nested_expanded,
+    const NestedExpansion& nested_expanded,
     std::vector<NestedHitButton>* out_hit_buttons,
     std::vector<NavHitButton>* out_nav_buttons,
     std::vector<ClassHoverRegion>* out_hover_regions,
     const std::string& hovered_class_id,
-    const std::vector<diagram_placement::ConnectionLine>& connection_lines,
-    const std::unordered_set<std::string>& highlighted_class_ids)
+    const diagram_placement::ConnectionGeometry* connection_lines,
+    const std::unordered_set<std::string>& highlighted_class_ids,
+    const diagram_placement::ConnectionBundles* connection_bundles,
+    const ClassDiagramViewport* viewport,
+    ClassDiagramRenderCache* render_cache)
 {
     if (!draw_list) return;
+    profiling::TraceScope trace("render_class_diagram", "render");
+
+    static thread_local ClassDiagramRenderCache fallback_cache;
+    ClassDiagramRenderCache& cache = render_cache ? *render_cache : fallback_cache;
+    const float card_zoom = card_zoom_step(zoom);
+    const float card_font_size = ImGui::GetFontSize() * card_zoom;
+    cache.begin_frame(diagram, cache.retained_cards() ? card_font_size : 0.0f);
+
+    // Viewport culling. The view is padded so markers, glows and borders of items just outside
+    // it are still drawn; those extras are sized in screen pixels, so the pad is too.
+    const float cull_pad = 16.0f / zoom;
+    diagram_placement::Rect cull_view;
+    if (viewport) {
+        cull_view = viewport->visible;
+        cull_view.x -= cull_pad;
+        cull_view.y -= cull_pad;
+        cull_view.width += 2.0 * cull_pad;
+        cull_view.height += 2.0 * cull_pad;
+    }
+    auto is_visible = [&](const diagram_placement::Rect& r) {
+        return !viewport || diagram_placement::rects_intersect(cull_view, r);
+    };
+    const ClassDiagramCullIndex* cull_index = viewport ? viewport->index : nullptr;
+    static thread_local std::vector<std::uint32_t> visible_items;
+    // Connection lines and markers of one pass go to the draw list as one batch.
+    static thread_local detail::LineBatch line_batch;
 
     const unsigned int bg_color = IM_COL32(45, 45, 48, 255);
     const unsigned int border_color = IM_COL32(125, 125, 132, 255);
     const unsigned int text_color = IM_COL32(220, 220, 220, 255);
     const unsigned int header_bg = IM_COL32(38, 38, 42, 255);
     const unsigned int button_bg = IM_COL32(70, 70, 75, 255);
-    const float line_thickness = 2.0f;
-    const float block_rounding = 8.0f;
+    const unsigned int lod_box_color = IM_COL32(88, 88, 96, 255);
 
-    const float f_padding = static_cast<float>(padding);
-    const float f_button_size = static_cast<float>(button_size);
-    const float f_header_height = static_cast<float>(header_height);
     const float f_row_height = static_cast<float>(row_height);
     const float f_content_inset_side = static_cast<float>(content_inset_side);
-    const float f_content_inset_top = static_cast<float>(content_inset_top);
     const float f_accent_bar_width = static_cast<float>(accent_bar_width);
     const float f_content_indent = static_cast<float>(content_indent);
     const float f_group_vertical_gap = static_cast<float>(group_vertical_gap);
     const float f_row_inner_gap = static_cast<float>(row_inner_gap);
-    const float f_header_content_gap = static_cast<float>(header_content_gap);
 
     const float safe_zoom = std::max(zoom, 1e-4f);
     ImFont* const font = ImGui::GetFont();
@@ -645,7 +699,7 @@ void render_class_diagram(ImDrawList* draw_list,
         offset_y,
         zoom,
         safe_zoom,
-        font,
+        nullptr, // font, resolved once there are cards to draw
         scaled_font_size,
         font_world_height,
         f_row_height_effective,
@@ -682,14 +736,19 @@ void render_class_diagram(ImDrawList* draw_list,
         IM_COL32(120, 85, 165, 255),  // child_card_border (bright purple, fully opaque)
         IM_COL32(42, 30, 52, 255),    // child_card_header_bg (darker purple)
         IM_COL32(100, 180, 255, 255),  // nav_button_color (bright blue arrow)
-        nested_expanded,
+        cache,
         out_hit_buttons,
         out_nav_buttons,
         out_hover_regions,
+        bg_color,
+        header_bg,
+        viewport ? static_cast<float>(cull_view.y) : -std::numeric_limits<float>::infinity(),
+        viewport ? static_cast<float>(cull_view.y + cull_view.height) : std::numeric_limits<float>::infinity(),
     };
 
     // ====== Permanent connection lines (behind blocks) ======
-    {
+    if (connection_lines) {
+        const diagram_placement::ConnectionGeometry& geom = *connection_lines;
         const unsigned int primary_inh_color = IM_COL32(100, 120, 150, 100);
         const unsigned int primary_inh_hover = IM_COL32(100, 120, 150, 220);
         const unsigned int composition_color = IM_COL32(130, 100, 150, 100);
@@ -697,69 +756,104 @@ void render_class_diagram(ImDrawList* draw_list,
         const float line_w = 1.5f;
         const float line_w_hover = 2.5f;
         const float marker_size = 6.0f * zoom;
-
-        for (const auto& cl : connection_lines) {
-            if (cl.kind == diagram_placement::ConnectionKind::SecondaryInheritance)
+        const bool draw_markers = marker_size >= 1.5f; // sub-pixel markers only add vertices
+
+        line_batch.begin(*draw_list);
+        if (cull_index) cull_index->visible_lines(cull_view, visible_items);
+        const std::size_t line_count = cull_index ? visible_items.size() : geom.size();
+        for (std::size_t n = 0; n < line_count; ++n) {
+            const std::size_t li = cull_index ? visible_items[n] : n;
+            const diagram_placement::ConnectionKind kind = geom.kind[li];
+            if (kind == diagram_placement::ConnectionKind::SecondaryInheritance)
                 continue; // Drawn later, on top of blocks.
+            const std::size_t count = geom.point_count[li];
+            if (count < 2) continue;
+            const float* pts = geom.route(li);
 
+            const std::string& from_id = diagram.classes[geom.from_class[li]].id;
+            const std::string& to_id = diagram.classes[geom.to_class[li]].id;
             const bool is_hovered = (!hovered_class_id.empty() &&
-                (cl.from_class_id == hovered_class_id || cl.to_class_id == hovered_class_id))
-                || highlighted_class_ids.count(cl.from_class_id)
-                || highlighted_class_ids.count(cl.to_class_id);
-            unsigned int color = (cl.kind == diagram_placement::ConnectionKind::PrimaryInheritance)
+                (from_id == hovered_class_id || to_id == hovered_class_id))
+                || highlighted_class_ids.count(from_id)
+                || highlighted_class_ids.count(to_id);
+            unsigned int color = (kind == diagram_placement::ConnectionKind::PrimaryInheritance)
                 ? (is_hovered ? primary_inh_hover : primary_inh_color)
                 : (is_hovered ? composition_hover : composition_color);
             float thickness = is_hovered ? line_w_hover : line_w;
-
-            // Draw line segments.
-            for (std::size_t i = 0; i + 1 < cl.points.size(); ++i) {
-                ImVec2 p0 = world_to_screen(static_cast<float>(cl.points[i].first),
-                    static_cast<float>(cl.points[i].second), offset_x, offset_y, zoom);
-                ImVec2 p1 = world_to_screen(static_cast<float>(cl.points[i + 1].first),
-                    static_cast<float>(cl.points[i + 1].second), offset_x, offset_y, zoom);
-                draw_list->AddLine(p0, p1, color, thickness);
+            const bool bundled = connection_bundles && connection_bundles->is_bundled(li);
+
+            // Each run of visible segments becomes one polyline.
+            for_each_visible_run(pts, count, is_visible, offset_x, offset_y, zoom,
+                [&](const ImVec2* run, std::size_t run_count) {
+                    line_batch.add_polyline(run, run_count, color, thickness, false);
+                });
+
+            // Marker at the "to" end (parent / target); bundled lines share their trunk's marker.
+            if (draw_markers && !bundled && is_visible(segment_bounds(pts + 2 * count - 4))) {
+                draw_connection_marker(line_batch, kind, pts + 2 * count - 4, color, thickness,
+                    offset_x, offset_y, zoom, marker_size);
             }
 
-            // Marker at the "to" end (parent / target).
-            if (cl.points.size() >= 2) {
-                auto& last = cl.points.back();
-                ImVec2 tip = world_to_screen(static_cast<float>(last.first),
-                    static_cast<float>(last.second), offset_x, offset_y, zoom);
-                auto& prev = cl.points[cl.points.size() - 2];
-                float dx = static_cast<float>(last.first - prev.first);
-                float dy = static_cast<float>(last.second - prev.second);
-                float len = std::sqrt(dx * dx + dy * dy);
-                if (len > 1e-4f) {
-                    dx /= len; dy /= len;
-                    float px = -dy, py = dx; // perpendicular
-                    if (cl.kind == diagram_placement::ConnectionKind::PrimaryInheritance) {
-                        // Empty triangle marker.
-                        ImVec2 a = ImVec2(tip.x - dx * marker_size + px * marker_size * 0.5f,
-                                          tip.y - dy * marker_size + py * marker_size * 0.5f);
-                        ImVec2 b = ImVec2(tip.x - dx * marker_size - px * marker_size * 0.5f,
-                                          tip.y - dy * marker_size - py * marker_size * 0.5f);
-                        draw_list->AddTriangle(tip, a, b, color, thickness);
-                    } else {
-                        // Filled diamond marker for composition.
-                        float hs = marker_size * 0.5f;
-                        ImVec2 top_d = tip;
-                        ImVec2 right_d = ImVec2(tip.x - dx * hs + px * hs * 0.5f,
-                                                tip.y - dy * hs + py * hs * 0.5f);
-                        ImVec2 bottom_d = ImVec2(tip.x - dx * marker_size,
-                                                 tip.y - dy * marker_size);
-                        ImVec2 left_d = ImVec2(tip.x - dx * hs - px * hs * 0.5f,
-                                               tip.y - dy * hs - py * hs * 0.5f);
-                        draw_list->AddQuadFilled(top_d, right_d, bottom_d, left_d, color);
-                    }
+            // Labels on lines removed — they are hard to read and add visual clutter.
+        }
+
+        // Bundle trunks: one bus + trunk + marker per hub instead of one marker per member.
+        if (connection_bundles) {
+            const diagram_placement::ConnectionBundles& bundles = *connection_bundles;
+            for (std::size_t bi = 0; bi < bundles.size(); ++bi) {
+                const std::string& to_id = diagram.classes[bundles.to_class[bi]].id;
+                const bool is_hovered = (!hovered_class_id.empty() && to_id == hovered_class_id)
+                    || highlighted_class_ids.count(to_id);
+                const bool inheritance = bundles.kind[bi] != diagram_placement::ConnectionKind::Composition;
+                unsigned int color = inheritance
+                    ? (is_hovered ? primary_inh_hover : primary_inh_color)
+                    : (is_hovered ? composition_hover : composition_color);
+                float thickness = is_hovered ? line_w_hover : line_w;
+                const float* bus = &bundles.bus[4 * bi];
+                const float* trunk = &bundles.trunk[4 * bi];
+                if (!is_visible(segment_bounds(bus)) && !is_visible(segment_bounds(trunk))) continue;
+                const ImVec2 bus_px[2] = { world_to_screen(bus[0], bus[1], offset_x, offset_y, zoom),
+                    world_to_screen(bus[2], bus[3], offset_x, offset_y, zoom) };
+                const ImVec2 trunk_px[2] = { world_to_screen(trunk[0], trunk[1], offset_x, offset_y, zoom),
+                    world_to_screen(trunk[2], trunk[3], offset_x, offset_y, zoom) };
+                line_batch.add_polyline(bus_px, 2, color, thickness, false);
+                line_batch.add_polyline(trunk_px, 2, color, thickness, false);
+                if (draw_markers) {
+                    draw_connection_marker(line_batch, bundles.kind[bi], trunk, color, thickness,
+                        offset_x, offset_y, zoom, marker_size);
                 }
             }
-
-            // Labels on lines removed — they are hard to read and add visual clutter.
         }
+        line_batch.flush(*draw_list);
     }
 
-    for (const auto& block : placed.blocks) {
-        const diagram_model::DiagramClass* cl = find_class(diagram, block.class_id);
+    static thread_local std::vector<std::uint64_t> cluster_cells;
+    cluster_cells.clear();
+    bool replayed_cards = false;
+
+    // Blocks are drawn in two passes: the first collects what to draw in z-order and the cards
+    // whose recordings are stale, those are recorded (on the worker pool when there are
+    // several), and the second draws and splices the recordings into draw_list in order.
+    struct BlockDraw {
+        const diagram_placement::PlacedClassBlock* block;
+        const diagram_model::DiagramClass* cl;
+        ClassBlockLod lod;
+        const detail::CardLayout* layout;  // content of an expanded block at Full detail
+        detail::CardRecording* rec;        // retained card, else drawn directly
+        ImVec2 min_pt;
+        ImVec2 max_pt;
+    };
+    static thread_local std::vector<BlockDraw> block_draws;
+    static thread_local std::vector<std::uint32_t> stale_cards;  // indices into block_draws
+    block_draws.clear();
+    stale_cards.clear();
+
+    if (cull_index) cull_index->visible_blocks(cull_view, visible_items);
+    const std::size_t block_count = cull_index ? visible_items.size() : placed.blocks.size();
+    for (std::size_t n = 0; n < block_count; ++n) {
+        const auto& block = placed.blocks[cull_index ? visible_items[n] : n];
+        if (!is_visible(block.rect)) continue;
+        const diagram_model::DiagramClass* cl = block_class(diagram, cache, block);
         if (!cl) continue;
 
         float x = (float)block.rect.x;
@@ -769,132 +863,154 @@ void render_class_diagram(ImDrawList* draw_list,
         ImVec2 min_pt = world_to_screen(x, y, offset_x, offset_y, zoom);
         ImVec2 max_pt = world_to_screen(x + w, y + h, offset_x, offset_y, zoom);
 
-        draw_list->AddRectFilled(min_pt, max_pt, bg_color, block_rounding);
-        draw_list->AddRect(min_pt, max_pt, border_color, block_rounding, 0, line_thickness);
-
-        draw_list->PushClipRect(min_pt, max_pt, true);
-
-        // --- Header ---
-        ImVec2 header_min = min_pt;
-        ImVec2 header_max = world_to_screen(x + w, y + f_header_height, offset_x, offset_y, zoom);
-        draw_list->AddRectFilled(header_min, header_max, header_bg,
-            block_rounding, ImDrawFlags_RoundCornersTop);
-        ImVec2 header_sep_left = world_to_screen(x, y + f_header_height, offset_x, offset_y, zoom);
-        ImVec2 header_sep_right = world_to_screen(x + w, y + f_header_height, offset_x, offset_y, zoom);
-        draw_list->AddLine(header_sep_left, header_sep_right, border_color, 1.0f);
-
-        // Main expand/collapse button.
-        float btn_x = x + w - f_padding - f_button_size;
-        float btn_y = y + (f_header_height - f_button_size) * 0.5f;
-        ImVec2 btn_min = world_to_screen(btn_x, btn_y, offset_x, offset_y, zoom);
-        ImVec2 btn_max = world_to_screen(btn_x + f_button_size, btn_y + f_button_size, offset_x, offset_y, zoom);
-        draw_list->AddRectFilled(btn_min, btn_max, button_bg);
-        draw_list->AddRect(btn_min, btn_max, border_color, 0.0f, 0, 1.0f);
-
-        float text_left = x + f_padding;
-        float text_y = y + (f_header_height - scaled_font_size / zoom) * 0.5f;
-        ImVec2 text_pos = world_to_screen(text_left, text_y, offset_x, offset_y, zoom);
-        draw_list->AddText(font, scaled_font_size, text_pos, text_color, cl->type_name.c_str());
-
-        ImVec2 plus_center = world_to_screen(btn_x + f_button_size * 0.5f,
-            btn_y + f_button_size * 0.5f, offset_x, offset_y, zoom);
-        float plus_half = 4.0f * zoom;
-        if (block.expanded) {
-            draw_list->AddLine(
-                ImVec2(plus_center.x - plus_half, plus_center.y),
-                ImVec2(plus_center.x + plus_half, plus_center.y), text_color, 1.5f);
-        } else {
-            draw_list->AddLine(
-                ImVec2(plus_center.x - plus_half, plus_center.y),
-                ImVec2(plus_center.x + plus_half, plus_center.y), text_color, 1.5f);
-            draw_list->AddLine(
-                ImVec2(plus_center.x, plus_center.y - plus_half),
-                ImVec2(plus_center.x, plus_center.y + plus_half), text_color, 1.5f);
+        const ClassBlockLod lod = class_block_lod(block.rect.width, block.rect.height, zoom);
+        if (lod == ClassBlockLod::Point) {
+            const auto cell_x = static_cast<std::int32_t>(std::floor((min_pt.x + max_pt.x) * 0.5f / lod_cluster_cell_px));
+            const auto cell_y = static_cast<std::int32_t>(std::floor((min_pt.y + max_pt.y) * 0.5f / lod_cluster_cell_px));
+            cluster_cells.push_back((static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell_x)) << 32)
+                | static_cast<std::uint32_t>(cell_y));
+            continue;
         }
 
-        if (!block.expanded) {
-            draw_list->PopClipRect();
-            continue;
+        const auto class_index = static_cast<std::uint32_t>(cl - diagram.classes.data());
+        const detail::CardLayout* layout = block.expanded && lod == ClassBlockLod::Full
+            ? &cache.card_layout(class_index, nested_expanded) : nullptr;
+        detail::CardRecording* rec = nullptr;
+        // Cards much taller than the view are drawn directly so that only their visible rows are.
+        const bool tall = viewport && block.rect.height > retained_card_max_view_heights * cull_view.height;
+        if (cache.retained_cards() && layout && !tall) {
+            rec = &cache.cards().slot(class_index);
+            if (!rec->matches(block.rect.width, block.rect.height, card_zoom)) {
+                stale_cards.push_back(static_cast<std::uint32_t>(block_draws.size()));
+                build_layout_rows(cache, *layout);
+            }
         }
+        block_draws.push_back({ &block, cl, lod, layout, rec, min_pt, max_pt });
+    }
 
-        // --- Content (4 sections, recursively expandable) ---
-        // Use draw list channels so nested frame backgrounds go behind content:
-        //   channel 0 = frame backgrounds + accents
-        //   channel 1 = row content + frame borders
-        draw_list->ChannelsSplit(2);
-        draw_list->ChannelsSetCurrent(1);
-
-        float cy = y + f_header_height + static_cast<float>(content_inset_top) + f_header_content_gap;
-        const std::string path_prefix = block.class_id + "/";
-        std::unordered_set<std::string> visited;
-        visited.insert(cl->id);
-        const float area_left = x + f_content_inset_side;
-        const float area_right = x + w - f_content_inset_side;
-        render_class_content(ctx, *cl, area_left, area_right, cy, 0, path_prefix, block.class_id, visited);
-
-        draw_list->ChannelsMerge();
-        draw_list->PopClipRect();
+    // Baked fonts are looked up here, on the ImGui thread: ImFont::GetFontBaked updates the
+    // font's shared state, and a size is only baked when some card text uses it.
+    if (!block_draws.empty()) ctx.font = font->GetFontBaked(scaled_font_size);
+
+    // Retained cards are recorded at the current zoom step with the card's top-left corner at
+    // the origin. Each recording thread has its own scratch draw list; the ones used off this
+    // thread get a private copy of the shared data, whose temp buffers are not thread-safe.
+    // Scratch lists are not kept: a draw list must not outlive the ImGui context, and the
+    // cache may. Workers make no ImGui font calls: the rows they draw were built above and
+    // text goes through the baked font resolved here.
+    if (!stale_cards.empty()) {
+        struct CardScratch {
+            std::unique_ptr<ImDrawListSharedData> shared;
+            std::unique_ptr<ImDrawList> list;
+        };
+        ImFontBaked* const card_font = font->GetFontBaked(card_font_size);
+        auto& pool = diagram_placement::WorkerPool::shared();
+        const bool parallel = stale_cards.size() >= parallel_record_min_cards && pool.concurrency() > 1;
+        std::vector<CardScratch> scratch(parallel ? pool.concurrency() : 1);
+        ImDrawListSharedData* main_shared = ImGui::GetDrawListSharedData();
+        for (std::size_t i = 0; i < scratch.size(); ++i) {
+            ImDrawListSharedData* shared = main_shared;
+            if (i > 0) {
+                scratch[i].shared = std::make_unique<ImDrawListSharedData>(*main_shared);
+                scratch[i].shared->DrawLists.clear();
+                shared = scratch[i].shared.get();
+            }
+            scratch[i].list = std::make_unique<ImDrawList>(shared);
+        }
+
+        auto record = [&](std::size_t begin, std::size_t end, unsigned worker) {
+            ImDrawList& list = *scratch[worker].list;
+            for (std::size_t i = begin; i < end; ++i) {
+                const BlockDraw& d = block_draws[stale_cards[i]];
+                const auto& block = *d.block;
+                detail::CardRecording& rec = *d.rec;
+                detail::CardVertexCache::begin_recording(list, *draw_list);
+                rec.hit_buttons.clear();
+                rec.nav_buttons.clear();
+                rec.hover_regions.clear();
+                RenderContext rec_ctx = ctx;
+                rec_ctx.draw_list = &list;
+                rec_ctx.offset_x = static_cast<float>(-block.rect.x) * card_zoom;
+                rec_ctx.offset_y = static_cast<float>(-block.rect.y) * card_zoom;
+                rec_ctx.zoom = card_zoom;
+                rec_ctx.safe_zoom = std::max(card_zoom, 1e-4f);
+                rec_ctx.font = card_font;
+                rec_ctx.scaled_font_size = card_font_size;
+                rec_ctx.out_hit_buttons = &rec.hit_buttons;
+                rec_ctx.out_nav_buttons = &rec.nav_buttons;
+                rec_ctx.out_hover_regions = &rec.hover_regions;
+                rec_ctx.visible_top = -std::numeric_limits<float>::infinity();
+                rec_ctx.visible_bottom = std::numeric_limits<float>::infinity();
+                draw_class_card(rec_ctx, block, *d.cl, d.lod, d.layout);
+                detail::CardVertexCache::end_recording(list, rec,
+                    block.rect.width, block.rect.height, card_zoom, block.rect.x, block.rect.y);
+            }
+        };
+        if (parallel) pool.parallel_for(stale_cards.size(), 1, record);
+        else record(0, stale_cards.size(), 0);
+    }
+
+    for (const BlockDraw& d : block_draws) {
+        const auto& block = *d.block;
+        if (d.lod == ClassBlockLod::Box) {
+            draw_list->AddRectFilled(d.min_pt, d.max_pt, lod_box_color);
+        } else if (!d.rec) {
+            draw_class_card(ctx, block, *d.cl, d.lod, d.layout);
+        } else {
+            detail::CardVertexCache::replay(*d.rec, *draw_list, zoom / card_zoom, d.min_pt);
+            append_card_regions(d.rec->hit_buttons, out_hit_buttons, block.rect.x, block.rect.y);
+            append_card_regions(d.rec->nav_buttons, out_nav_buttons, block.rect.x, block.rect.y);
+            append_card_regions(d.rec->hover_regions, out_hover_regions, block.rect.x, block.rect.y);
+            replayed_cards = true;
+        }
+    }
+
+    // Replayed cards draw text baked at the card zoom step; use that size this frame so ImGui
+    // keeps its glyphs in the atlas.
+    if (replayed_cards) font->GetFontBaked(card_font_size);
+
+    // Point tier: one square per occupied screen cell, however many blocks fall into it.
+    if (!cluster_cells.empty()) {
+        std::sort(cluster_cells.begin(), cluster_cells.end());
+        cluster_cells.erase(std::unique(cluster_cells.begin(), cluster_cells.end()), cluster_cells.end());
+        for (const std::uint64_t cell : cluster_cells) {
+            const float cx = static_cast<float>(static_cast<std::int32_t>(cell >> 32)) * lod_cluster_cell_px;
+            const float cy = static_cast<float>(static_cast<std::int32_t>(cell & 0xFFFFFFFFu)) * lod_cluster_cell_px;
+            draw_list->AddRectFilled(ImVec2(cx, cy), ImVec2(cx + lod_cluster_cell_px - 1.0f,
+                cy + lod_cluster_cell_px - 1.0f), lod_box_color);
+        }
     }
 
     // ====== Hover connection lines (SecondaryInheritance) — drawn over blocks ======
-    if (!hovered_class_id.empty()) {
+    if (connection_lines && !hovered_class_id.empty()) {
+        const diagram_placement::ConnectionGeometry& geom = *connection_lines;
         const unsigned int sec_inh_color = IM_COL32(180, 140, 80, 180);
         const float sec_line_w = 2.0f;
         const float marker_size = 6.0f * zoom;
         const float dash_len = 8.0f * zoom;
         const float gap_len = 4.0f * zoom;
-
-        for (const auto& cl : connection_lines) {
-            if (cl.kind != diagram_placement::ConnectionKind::SecondaryInheritance) continue;
-            if (cl.from_class_id != hovered_class_id) continue;
-
-            // Draw dashed line segments.
-            for (std::size_t i = 0; i + 1 < cl.points.size(); ++i) {
-                ImVec2 p0 = world_to_screen(static_cast<float>(cl.points[i].first),
-                    static_cast<float>(cl.points[i].second), offset_x, offset_y, zoom);
-                ImVec2 p1 = world_to_screen(static_cast<float>(cl.points[i + 1].first),
-                    static_cast<float>(cl.points[i + 1].second), offset_x, offset_y, zoom);
-                // Draw dashed.
-                float seg_dx = p1.x - p0.x;
-                float seg_dy = p1.y - p0.y;
-                float seg_len = std::sqrt(seg_dx * seg_dx + seg_dy * seg_dy);
-                if (seg_len < 1e-3f) continue;
-                float ndx = seg_dx / seg_len, ndy = seg_dy / seg_len;
-                float drawn = 0.0f;
-                bool drawing = true;
-                while (drawn < seg_len) {
-                    float step = drawing ? dash_len : gap_len;
-                    float end = std::min(drawn + step, seg_len);
-                    if (drawing) {
-                        ImVec2 a = ImVec2(p0.x + ndx * drawn, p0.y + ndy * drawn);
-                        ImVec2 b = ImVec2(p0.x + ndx * end, p0.y + ndy * end);
-                        draw_list->AddLine(a, b, sec_inh_color, sec_line_w);
-                    }
-                    drawn = end;
-                    drawing = !drawing;
-                }
-            }
+        line_batch.begin(*draw_list);
+
+        for (std::size_t li = 0; li < geom.size(); ++li) {
+            if (geom.kind[li] != diagram_placement::ConnectionKind::SecondaryInheritance) continue;
+            if (diagram.classes[geom.from_class[li]].id != hovered_class_id) continue;
+            const std::size_t count = geom.point_count[li];
+            if (count < 2) continue;
+            const float* pts = geom.route(li);
+
+            // Dashed, except when zoomed out so far that dashes would be sub-pixel.
+            for_each_visible_run(pts, count, is_visible, offset_x, offset_y, zoom,
+                [&](const ImVec2* run, std::size_t run_count) {
+                    if (dash_len < 2.0f) line_batch.add_polyline(run, run_count, sec_inh_color, sec_line_w, false);
+                    else line_batch.add_dashed_polyline(run, run_count, sec_inh_color, sec_line_w, dash_len, gap_len);
+                });
 
             // Empty triangle marker at the "to" end.
-            if (cl.points.size() >= 2) {
-                auto& last = cl.points.back();
-                ImVec2 tip = world_to_screen(static_cast<float>(last.first),
-                    static_cast<float>(last.second), offset_x, offset_y, zoom);
-                auto& prev = cl.points[cl.points.size() - 2];
-                float dx = static_cast<float>(last.first - prev.first);
-                float dy = static_cast<float>(last.second - prev.second);
-                float len = std::sqrt(dx * dx + dy * dy);
-                if (len > 1e-4f) {
-                    dx /= len; dy /= len;
-                    float px = -dy, py = dx;
-                    ImVec2 a = ImVec2(tip.x - dx * marker_size + px * marker_size * 0.5f,
-                                      tip.y - dy * marker_size + py * marker_size * 0.5f);
-                    ImVec2 b = ImVec2(tip.x - dx * marker_size - px * marker_size * 0.5f,
-                                      tip.y - dy * marker_size - py * marker_size * 0.5f);
-                    draw_list->AddTriangle(tip, a, b, sec_inh_color, sec_line_w);
-                }
-            }
+            if (marker_size >= 1.5f && is_visible(segment_bounds(pts + 2 * count - 4)))
+                draw_connection_marker(line_batch, geom.kind[li], pts + 2 * count - 4, sec_inh_color, sec_line_w,
+                    offset_x, offset_y, zoom, marker_size);
         }
+        line_batch.flush(*draw_list);
     }
 
     // --- Hover highlight pass: draw a glow overlay on highlighted blocks ---
@@ -908,7 +1024,7 @@ void render_class_diagram(ImDrawList* draw_list,
         for (const auto& block : placed.blocks) {
             const bool match = (block.class_id == hovered_class_id)
                 || (highlighted_class_ids.count(block.class_id) > 0);
-            if (!match) continue;
+            if (!match || !is_visible(block.rect)) continue;
 
             const float x = static_cast<float>(block.rect.x);
             const float y = static_cast<float>(block.rect.y);
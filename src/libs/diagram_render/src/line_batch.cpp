@@ -0,0 +1,218 @@
+#include "line_batch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace diagram_render::detail {
+
+namespace {
+
+// A draw command addresses at most this many vertices with 16-bit indices.
+constexpr std::size_t max_chunk_vertices = sizeof(ImDrawIdx) == 2
+    ? 0xFFFF : std::numeric_limits<std::uint32_t>::max();
+// Points of a polyline that fit in one chunk, at four vertices each.
+constexpr std::size_t max_polyline_points = max_chunk_vertices / 4;
+// Same cap as ImGui's own miter computation (IM_FIXNORMAL2F_MAX_INVLEN2).
+constexpr float max_miter_inv_len2 = 100.0f;
+
+// Unit normal of a -> b, pointing left of the direction in screen space (y down).
+ImVec2 edge_normal(ImVec2 a, ImVec2 b) {
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    const float len2 = dx * dx + dy * dy;
+    if (len2 <= 1e-12f) return ImVec2(0.0f, 0.0f);
+    const float inv = 1.0f / std::sqrt(len2);
+    return ImVec2(dy * inv, -dx * inv);
+}
+
+// Offset direction at a join of two edges, long enough that both edges keep their width.
+ImVec2 miter(ImVec2 n0, ImVec2 n1) {
+    float x = (n0.x + n1.x) * 0.5f;
+    float y = (n0.y + n1.y) * 0.5f;
+    const float len2 = x * x + y * y;
+    if (len2 > 1e-6f) {
+        const float inv = std::min(1.0f / len2, max_miter_inv_len2);
+        x *= inv;
+        y *= inv;
+    }
+    return ImVec2(x, y);
+}
+
+ImVec2 offset(ImVec2 p, ImVec2 dir, float distance) {
+    return ImVec2(p.x + dir.x * distance, p.y + dir.y * distance);
+}
+
+} // namespace
+
+void LineBatch::begin(const ImDrawList& target) {
+    fringe_ = (target.Flags & ImDrawListFlags_AntiAliasedLines) ? target._FringeScale : 0.0f;
+    uv_ = target._Data->TexUvWhitePixel;
+    vertices_.clear();
+    indices_.clear();
+    chunks_.clear();
+}
+
+std::uint32_t LineBatch::reserve(std::size_t vtx_count) {
+    if (chunks_.empty() || vertices_.size() - chunks_.back().vtx_begin + vtx_count > max_chunk_vertices) {
+        chunks_.push_back({ static_cast<std::uint32_t>(vertices_.size()),
+            static_cast<std::uint32_t>(indices_.size()) });
+    }
+    return static_cast<std::uint32_t>(vertices_.size() - chunks_.back().vtx_begin);
+}
+
+void LineBatch::push_vertex(ImVec2 pos, ImU32 color) {
+    ImDrawVert v;
+    v.pos = pos;
+    v.uv = uv_;
+    v.col = color;
+    vertices_.push_back(v);
+}
+
+void LineBatch::add_polyline(const ImVec2* points, std::size_t count, ImU32 color, float thickness, bool closed) {
+    if (count < 2) return;
+    if (count > max_polyline_points) {
+        // Open pieces that share their end points, each within one chunk; the joins between
+        // pieces are not mitred.
+        for (std::size_t first = 0; first + 1 < count; first += max_polyline_points - 1)
+            add_polyline(points + first, std::min(max_polyline_points, count - first), color, thickness, false);
+        if (closed) add_segment(points[count - 1], points[0], color, thickness);
+        return;
+    }
+    const std::size_t edges = closed ? count : count - 1;
+    normals_.resize(edges);
+    for (std::size_t e = 0; e < edges; ++e) {
+        normals_[e] = edge_normal(points[e], points[(e + 1) % count]);
+        // A repeated point keeps the previous direction.
+        if (e > 0 && normals_[e].x == 0.0f && normals_[e].y == 0.0f) normals_[e] = normals_[e - 1];
+    }
+
+    // Four vertices per point: fringe, core, core, fringe across the line.
+    const float core = std::max(thickness - fringe_, 0.0f) * 0.5f;
+    const float outer = core + fringe_;
+    const ImU32 transparent = color & ~IM_COL32_A_MASK;
+    const std::uint32_t base = reserve(count * 4);
+    for (std::size_t i = 0; i < count; ++i) {
+        ImVec2 m;
+        if (closed) m = miter(normals_[(i + edges - 1) % edges], normals_[i]);
+        else if (i == 0) m = normals_[0];
+        else if (i + 1 == count) m = normals_[edges - 1];
+        else m = miter(normals_[i - 1], normals_[i]);
+        push_vertex(offset(points[i], m, outer), transparent);
+        push_vertex(offset(points[i], m, core), color);
+        push_vertex(offset(points[i], m, -core), color);
+        push_vertex(offset(points[i], m, -outer), transparent);
+    }
+    for (std::size_t e = 0; e < edges; ++e) {
+        const std::uint32_t a = base + static_cast<std::uint32_t>(4 * e);
+        const std::uint32_t b = base + static_cast<std::uint32_t>(4 * ((e + 1) % count));
+        for (std::uint32_t k = 0; k < 3; ++k) {
+            const ImDrawIdx quad[6] = {
+                static_cast<ImDrawIdx>(a + k), static_cast<ImDrawIdx>(a + k + 1), static_cast<ImDrawIdx>(b + k + 1),
+                static_cast<ImDrawIdx>(a + k), static_cast<ImDrawIdx>(b + k + 1), static_cast<ImDrawIdx>(b + k),
+            };
+            indices_.insert(indices_.end(), quad, quad + 6);
+        }
+    }
+}
+
+void LineBatch::add_segment(ImVec2 a, ImVec2 b, ImU32 color, float thickness) {
+    const ImVec2 points[2] = { a, b };
+    add_polyline(points, 2, color, thickness, false);
+}
+
+void LineBatch::add_dashed_polyline(const ImVec2* points, std::size_t count, ImU32 color, float thickness,
+    float dash_length, float gap_length)
+{
+    if (dash_length <= 0.0f || gap_length <= 0.0f) {
+        add_polyline(points, count, color, thickness, false);
+        return;
+    }
+    // Dash k covers [k * period, k * period + dash_length) of the length along the polyline.
+    // Boundaries follow from the dash index rather than a running phase, so rounding cannot
+    // stall the walk: every step moves on to the next dash.
+    const double period = static_cast<double>(dash_length) + static_cast<double>(gap_length);
+    double start = 0.0;  // length along the polyline at points[i]
+    for (std::size_t i = 0; i + 1 < count; ++i) {
+        const ImVec2 a = points[i];
+        const float dx = points[i + 1].x - a.x;
+        const float dy = points[i + 1].y - a.y;
+        const float len = std::sqrt(dx * dx + dy * dy);
+        if (len < 1e-3f) continue;
+        const ImVec2 dir(dx / len, dy / len);
+        const double end = start + len;
+        for (auto k = static_cast<std::int64_t>(std::floor(start / period)); static_cast<double>(k) * period < end; ++k) {
+            const double d0 = std::max(static_cast<double>(k) * period, start);
+            const double d1 = std::min(static_cast<double>(k) * period + dash_length, end);
+            if (d1 - d0 < 1e-3) continue;
+            add_segment(offset(a, dir, static_cast<float>(d0 - start)), offset(a, dir, static_cast<float>(d1 - start)),
+                color, thickness);
+        }
+        start = end;
+    }
+}
+
+void LineBatch::add_convex_filled(const ImVec2* points, std::size_t count, ImU32 color) {
+    if (count < 3) return;
+    // Outward normals: edge_normal points outward for clockwise (positive area) polygons.
+    float area2 = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        const ImVec2 p = points[i];
+        const ImVec2 q = points[(i + 1) % count];
+        area2 += p.x * q.y - q.x * p.y;
+    }
+    const float side = area2 < 0.0f ? -1.0f : 1.0f;
+    normals_.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        normals_[i] = edge_normal(points[i], points[(i + 1) % count]);
+
+    // Two vertices per point: inner (solid) and outer (transparent), half a fringe each way.
+    const float half = fringe_ * 0.5f * side;
+    const ImU32 transparent = color & ~IM_COL32_A_MASK;
+    const std::uint32_t base = reserve(count * 2);
+    for (std::size_t i = 0; i < count; ++i) {
+        const ImVec2 m = miter(normals_[(i + count - 1) % count], normals_[i]);
+        push_vertex(offset(points[i], m, -half), color);
+        push_vertex(offset(points[i], m, half), transparent);
+    }
+    for (std::uint32_t i = 2; i < count; ++i) {
+        const ImDrawIdx tri[3] = {
+            static_cast<ImDrawIdx>(base), static_cast<ImDrawIdx>(base + 2 * (i - 1)), static_cast<ImDrawIdx>(base + 2 * i),
+        };
+        indices_.insert(indices_.end(), tri, tri + 3);
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const std::uint32_t a = base + 2 * i;
+        const std::uint32_t b = base + 2 * static_cast<std::uint32_t>((i + 1) % count);
+        const ImDrawIdx quad[6] = {
+            static_cast<ImDrawIdx>(a), static_cast<ImDrawIdx>(b), static_cast<ImDrawIdx>(b + 1),
+            static_cast<ImDrawIdx>(a), static_cast<ImDrawIdx>(b + 1), static_cast<ImDrawIdx>(a + 1),
+        };
+        indices_.insert(indices_.end(), quad, quad + 6);
+    }
+}
+
+void LineBatch::flush(ImDrawList& target) {
+    for (std::size_t c = 0; c < chunks_.size(); ++c) {
+        const Chunk& chunk = chunks_[c];
+        const std::size_t vtx_end = c + 1 < chunks_.size() ? chunks_[c + 1].vtx_begin : vertices_.size();
+        const std::size_t idx_end = c + 1 < chunks_.size() ? chunks_[c + 1].idx_begin : indices_.size();
+        const auto vtx_count = static_cast<unsigned int>(vtx_end - chunk.vtx_begin);
+        const auto idx_count = static_cast<unsigned int>(idx_end - chunk.idx_begin);
+        if (idx_count == 0) continue;
+        target.PrimReserve(static_cast<int>(idx_count), static_cast<int>(vtx_count));
+        std::copy(vertices_.begin() + chunk.vtx_begin, vertices_.begin() + vtx_end, target._VtxWritePtr);
+        const ImDrawIdx base = static_cast<ImDrawIdx>(target._VtxCurrentIdx);
+        const ImDrawIdx* src = indices_.data() + chunk.idx_begin;
+        ImDrawIdx* dst = target._IdxWritePtr;
+        for (unsigned int i = 0; i < idx_count; ++i)
+            dst[i] = static_cast<ImDrawIdx>(src[i] + base);
+        target._VtxWritePtr += vtx_count;
+        target._IdxWritePtr += idx_count;
+        target._VtxCurrentIdx += vtx_count;
+    }
+    vertices_.clear();
+    indices_.clear();
+    chunks_.clear();
+}
+
+} // namespace diagram_render::detail
@@ -0,0 +1,52 @@
+#pragma once
+
+// Batched tessellation of connection lines and their markers for render_class_diagram.
+#include "imgui.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace diagram_render::detail {
+
+// Collects anti-aliased polylines, dashed polylines and filled convex markers in screen space
+// and appends them to a draw list in one PrimReserve per 64k vertices, instead of one
+// AddLine/AddTriangle call each. Geometry matches ImGui's anti-aliased paths: a solid core
+// with a one-fringe alpha ramp on both sides, mitred joins.
+class LineBatch {
+public:
+    // Clears the batch and takes the fringe width and white-pixel UV from `target`.
+    void begin(const ImDrawList& target);
+
+    // Polylines too long for one chunk are split into pieces that are not mitred at the cut.
+    void add_polyline(const ImVec2* points, std::size_t count, ImU32 color, float thickness, bool closed);
+    // Dashes run along the whole polyline, so the pattern continues around corners.
+    void add_dashed_polyline(const ImVec2* points, std::size_t count, ImU32 color, float thickness,
+        float dash_length, float gap_length);
+    void add_convex_filled(const ImVec2* points, std::size_t count, ImU32 color);
+
+    // Appends everything added since begin() to `target`, in order.
+    void flush(ImDrawList& target);
+
+    bool empty() const { return vertices_.empty(); }
+
+private:
+    struct Chunk {
+        std::uint32_t vtx_begin = 0;
+        std::uint32_t idx_begin = 0;
+    };
+
+    // Starts a new chunk when `vtx_count` more vertices would not fit in 16-bit indices;
+    // returns the index of the next vertex relative to the current chunk.
+    std::uint32_t reserve(std::size_t vtx_count);
+    void push_vertex(ImVec2 pos, ImU32 color);
+    void add_segment(ImVec2 a, ImVec2 b, ImU32 color, float thickness);
+
+    float fringe_ = 1.0f;
+    ImVec2 uv_;
+    std::vector<ImDrawVert> vertices_;
+    std::vector<ImDrawIdx> indices_;  // relative to their chunk's first vertex
+    std::vector<Chunk> chunks_;
+    std::vector<ImVec2> normals_;     // scratch
+};
+
+} // namespace diagram_render::detail
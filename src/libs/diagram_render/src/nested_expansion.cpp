@@ -0,0 +1,178 @@
+#include <diagram_render/nested_expansion.hpp>
+#include "class_block_measure.hpp"
+#include <diagram_placement/class_diagram_layout_constants.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <algorithm>
+#include <charconv>
+
+namespace diagram_render {
+
+namespace {
+
+constexpr std::size_t min_slots = 16;
+
+// Keys are already well mixed; fold the high half in for 32-bit size_t.
+std::size_t slot_hash(NestedPathKey key) {
+    return static_cast<std::size_t>(key ^ (key >> 32));
+}
+
+// Depth-first walk over the expanded nested cards of one block, with the same cycle and depth
+// rules as the card layout, collecting their string paths.
+struct PathCollector {
+    const diagram_model::ClassDiagram& diagram;
+    const detail::ClassIndex& index;
+    const NestedExpansion& expansion;
+    std::vector<std::string>& out;
+    std::string path{};
+    std::vector<const diagram_model::DiagramClass*> visited{};
+
+    void walk(const diagram_model::DiagramClass& cls, NestedPathKey key, int depth) {
+        if (depth + 1 >= diagram_placement::layout::max_nesting_depth) return;
+        for (std::size_t i = 0; i < cls.parent_class_ids.size(); ++i)
+            visit(key, NestedSection::Parent, i, cls.parent_class_ids[i], depth);
+        for (std::size_t i = 0; i < cls.child_objects.size(); ++i)
+            visit(key, NestedSection::Child, i, cls.child_objects[i].class_id, depth);
+    }
+
+    void visit(NestedPathKey card, NestedSection section, std::size_t i, const std::string& id, int depth) {
+        auto it = index.find(id);
+        if (it == index.end()) return;
+        const diagram_model::DiagramClass* target = &diagram.classes[it->second];
+        if (std::find(visited.begin(), visited.end(), target) != visited.end()) return;
+        const NestedPathKey key = nested_child_key(card, section, i);
+        if (!expansion.contains(key)) return;
+
+        const std::size_t prefix_size = path.size();
+        char digits[24];
+        const auto res = std::to_chars(digits, digits + sizeof(digits), i);
+        path.append(section == NestedSection::Parent ? "/parent/" : "/child/").append(digits, res.ptr);
+        out.push_back(path);
+        visited.push_back(target);
+        walk(*target, key, depth + 1);
+        visited.pop_back();
+        path.resize(prefix_size);
+    }
+};
+
+} // namespace
+
+NestedPathKey nested_root_key(std::string_view block_class_id) {
+    // 64-bit FNV-1a.
+    std::uint64_t h = 14695981039346656037ull;
+    for (const char c : block_class_id) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+std::optional<NestedPathKey> nested_path_key(std::string_view path, std::string_view* block_class_id) {
+    struct Step {
+        NestedSection section;
+        std::size_t index;
+    };
+    // Steps are parsed from the end, so the class id may itself contain '/'.
+    std::vector<Step> steps;  // innermost first
+    std::string_view rest = path;
+    for (;;) {
+        const std::size_t index_slash = rest.rfind('/');
+        if (index_slash == std::string_view::npos) break;
+        const std::string_view digits = rest.substr(index_slash + 1);
+        std::size_t index = 0;
+        const auto res = std::from_chars(digits.data(), digits.data() + digits.size(), index);
+        if (digits.empty() || res.ec != std::errc() || res.ptr != digits.data() + digits.size()) break;
+        const std::string_view head = rest.substr(0, index_slash);
+        const std::size_t section_slash = head.rfind('/');
+        if (section_slash == std::string_view::npos) break;
+        const std::string_view section = head.substr(section_slash + 1);
+        if (section == "parent") steps.push_back({ NestedSection::Parent, index });
+        else if (section == "child") steps.push_back({ NestedSection::Child, index });
+        else break;
+        rest = head.substr(0, section_slash);
+    }
+    if (steps.empty() || rest.empty()) return std::nullopt;
+    if (block_class_id) *block_class_id = rest;
+
+    NestedPathKey key = nested_root_key(rest);
+    for (auto it = steps.rbegin(); it != steps.rend(); ++it)
+        key = nested_child_key(key, it->section, it->index);
+    return key;
+}
+
+std::size_t NestedExpansion::find_slot(NestedPathKey key) const {
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t i = slot_hash(key) & mask;
+    while (slots_[i] != 0 && slots_[i] != key) i = (i + 1) & mask;
+    return i;
+}
+
+bool NestedExpansion::contains(NestedPathKey key) const {
+    return size_ > 0 && slots_[find_slot(key)] == key;
+}
+
+void NestedExpansion::grow() {
+    std::vector<NestedPathKey> old(std::max(min_slots, slots_.size() * 2), 0);
+    old.swap(slots_);
+    for (const NestedPathKey key : old)
+        if (key != 0) slots_[find_slot(key)] = key;
+}
+
+void NestedExpansion::set(NestedPathKey key, bool expanded) {
+    if (expanded) {
+        // Load factor at most 3/4.
+        if ((size_ + 1) * 4 > slots_.size() * 3) grow();
+        const std::size_t i = find_slot(key);
+        if (slots_[i] == key) return;
+        slots_[i] = key;
+        ++size_;
+        return;
+    }
+    if (size_ == 0) return;
+    std::size_t hole = find_slot(key);
+    if (slots_[hole] != key) return;
+    // Backward-shift deletion: later keys of the probe run move into the hole when it lies
+    // between their home slot and their slot, so no tombstones are needed.
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t j = (hole + 1) & mask; slots_[j] != 0; j = (j + 1) & mask) {
+        const std::size_t home = slot_hash(slots_[j]) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+    }
+    slots_[hole] = 0;
+    --size_;
+}
+
+bool NestedExpansion::toggle(NestedPathKey key) {
+    const bool expanded = !contains(key);
+    set(key, expanded);
+    return expanded;
+}
+
+void NestedExpansion::clear() {
+    std::fill(slots_.begin(), slots_.end(), 0);
+    size_ = 0;
+}
+
+bool NestedExpansion::set_path(std::string_view path, bool expanded) {
+    const std::optional<NestedPathKey> key = nested_path_key(path);
+    if (!key) return false;
+    set(*key, expanded);
+    return true;
+}
+
+std::vector<std::string> NestedExpansion::expanded_paths(const diagram_model::ClassDiagram& diagram) const {
+    std::vector<std::string> out;
+    if (size_ == 0) return out;
+    const detail::ClassIndex index = detail::build_class_index(diagram);
+    PathCollector collector{ diagram, index, *this, out };
+    for (const auto& cls : diagram.classes) {
+        collector.path.assign(cls.id);
+        collector.visited.assign(1, &cls);
+        collector.walk(cls, nested_root_key(cls.id), 0);
+    }
+    return out;
+}
+
+} // namespace diagram_render
@@ -0,0 +1,76 @@
+#include <diagram_render/text_measure_cache.hpp>
+#include "imgui.h"
+
+namespace diagram_render {
+
+TextMeasureCache& TextMeasureCache::shared() {
+    static TextMeasureCache cache;
+    return cache;
+}
+
+void TextMeasureCache::invalidate() {
+    tables_.clear();
+    strings_.clear();
+    ids_.clear();
+    last_table_ = 0;
+    atlas_ = nullptr;
+    atlas_font_count_ = -1;
+}
+
+std::size_t TextMeasureCache::measured_count() const {
+    std::size_t count = 0;
+    for (const auto& table : tables_)
+        for (float w : table.widths)
+            if (w >= 0.0f) ++count;
+    return count;
+}
+
+std::uint32_t TextMeasureCache::intern(std::string_view text) {
+    auto it = ids_.find(text);
+    if (it != ids_.end()) return it->second;
+    const auto id = static_cast<std::uint32_t>(strings_.size());
+    auto inserted = ids_.emplace(std::string(text), id).first;
+    strings_.push_back(&inserted->first);
+    return id;
+}
+
+TextMeasureCache::FontTable& TextMeasureCache::current_table() {
+    const ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    const int font_count = atlas ? atlas->Fonts.Size : 0;
+    if (atlas != atlas_ || font_count != atlas_font_count_) {
+        tables_.clear();
+        last_table_ = 0;
+        atlas_ = atlas;
+        atlas_font_count_ = font_count;
+    }
+
+    const void* font = ImGui::GetFont();
+    const float size = ImGui::GetFontSize();
+    if (last_table_ < tables_.size() && tables_[last_table_].font == font && tables_[last_table_].size == size)
+        return tables_[last_table_];
+    for (std::size_t i = 0; i < tables_.size(); ++i) {
+        if (tables_[i].font == font && tables_[i].size == size) {
+            last_table_ = i;
+            return tables_[i];
+        }
+    }
+    tables_.push_back(FontTable{ font, size, {} });
+    last_table_ = tables_.size() - 1;
+    return tables_.back();
+}
+
+double TextMeasureCache::width(std::string_view text) {
+    if (text.empty()) return 0.0;
+    FontTable& table = current_table();
+    const std::uint32_t id = intern(text);
+    if (id >= table.widths.size())
+        table.widths.resize(strings_.size(), -1.0f);
+    float& w = table.widths[id];
+    if (w < 0.0f) {
+        const std::string& s = *strings_[id];
+        w = ImGui::CalcTextSize(s.data(), s.data() + s.size()).x;
+    }
+    return static_cast<double>(w);
+}
+
+} // namespace diagram_render
@@ -0,0 +1,71 @@
+#include <diagram_render/viewport_culling.hpp>
+#include <algorithm>
+
+namespace diagram_render {
+
+void ClassDiagramCullIndex::build(const diagram_placement::PlacedClassDiagram& placed,
+    const diagram_placement::ConnectionGeometry* lines)
+{
+    build_blocks(placed);
+    build_lines(lines);
+}
+
+void ClassDiagramCullIndex::build_blocks(const diagram_placement::PlacedClassDiagram& placed) {
+    scratch_.clear();
+    for (const auto& block : placed.blocks)
+        scratch_.push_back(block.rect);
+    blocks_.build(scratch_);
+}
+
+void ClassDiagramCullIndex::build_lines(const diagram_placement::ConnectionGeometry* lines) {
+    scratch_.clear();
+    line_ids_.clear();
+    if (lines) {
+        for (std::size_t li = 0; li < lines->size(); ++li) {
+            const std::uint32_t count = lines->point_count[li];
+            if (count < 2) continue;
+            const float* pts = lines->route(li);
+            float min_x = pts[0], max_x = pts[0], min_y = pts[1], max_y = pts[1];
+            for (std::uint32_t k = 1; k < count; ++k) {
+                min_x = std::min(min_x, pts[2 * k]);
+                max_x = std::max(max_x, pts[2 * k]);
+                min_y = std::min(min_y, pts[2 * k + 1]);
+                max_y = std::max(max_y, pts[2 * k + 1]);
+            }
+            scratch_.push_back({ min_x, min_y, static_cast<double>(max_x - min_x), static_cast<double>(max_y - min_y) });
+            line_ids_.push_back(static_cast<std::uint32_t>(li));
+        }
+    }
+    lines_.build(scratch_);
+}
+
+void ClassDiagramCullIndex::clear() {
+    blocks_.clear();
+    lines_.clear();
+    line_ids_.clear();
+    scratch_.clear();
+}
+
+void ClassDiagramCullIndex::visible_blocks(const diagram_placement::Rect& view,
+    std::vector<std::uint32_t>& out) const
+{
+    out.clear();
+    blocks_.query(view, [&](std::uint32_t item) { out.push_back(item); });
+    std::sort(out.begin(), out.end());
+}
+
+void ClassDiagramCullIndex::visible_lines(const diagram_placement::Rect& view,
+    std::vector<std::uint32_t>& out) const
+{
+    out.clear();
+    lines_.query(view, [&](std::uint32_t item) { out.push_back(line_ids_[item]); });
+    std::sort(out.begin(), out.end());
+}
+
+void ClassDiagramCullIndex::blocks_at(double x, double y, std::vector<std::uint32_t>& out) const {
+    out.clear();
+    blocks_.query_point(x, y, [&](std::uint32_t item) { out.push_back(item); });
+    std::sort(out.begin(), out.end());
+}
+
+} // namespace diagram_render
@@ -0,0 +1,51 @@
+#pragma once
+
+// Heap allocation counts per thread, attributed to the frame profiler phase active on that
+// thread. They are fed by the operator new replacement in the profiling_alloc_hooks target,
+// which executables link when they want allocations counted (render_bench always, main with
+// DIAGRAM_PROFILE_ALLOCATIONS); without it nothing is counted and allocation_counting_active()
+// stays false.
+#include <profiling/frame_phase.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace profiling {
+
+struct AllocationCount {
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Threads with a counter block of their own; later threads share one.
+constexpr std::size_t max_counted_threads = 64;
+
+// Called by the operator new replacement; never allocates.
+void note_allocation(std::size_t bytes) noexcept;
+
+// Phase the calling thread's allocations are counted under; FramePhase::Count is "no phase".
+FramePhase allocation_phase() noexcept;
+void set_allocation_phase(FramePhase phase) noexcept;
+
+// Allocations made so far by the calling thread / by all threads / by all threads in `phase`.
+AllocationCount thread_allocations() noexcept;
+AllocationCount process_allocations() noexcept;
+AllocationCount phase_allocations(FramePhase phase) noexcept;
+
+// Whether any allocation has been counted, i.e. the operator new replacement is linked in.
+bool allocation_counting_active() noexcept;
+
+// Counts the calling thread's allocations under `phase` until the end of the scope.
+class ScopedAllocationPhase {
+public:
+    explicit ScopedAllocationPhase(FramePhase phase) noexcept : previous_(allocation_phase()) {
+        set_allocation_phase(phase);
+    }
+    ~ScopedAllocationPhase() { set_allocation_phase(previous_); }
+    ScopedAllocationPhase(const ScopedAllocationPhase&) = delete;
+    ScopedAllocationPhase& operator=(const ScopedAllocationPhase&) = delete;
+
+private:
+    FramePhase previous_;
+};
+
+} // namespace profiling
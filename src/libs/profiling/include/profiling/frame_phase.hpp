@@ -0,0 +1,36 @@
+#pragma once
+
+// Phases of a canvas frame and the per-frame counters, shared by the frame profiler and the
+// allocation counters.
+#include <cstddef>
+#include <cstdint>
+
+namespace profiling {
+
+enum class FramePhase : std::uint8_t {
+    Input,            // handle_input: picking, toggles, drag
+    PhysicsStep,      // PhysicsLayout::step
+    GetPlaced,        // PhysicsLayout::get_placed and the block grid over it
+    OverlapAudit,     // log_visual_overlaps
+    ConnectionLines,  // routing, bundling and the line grid
+    Hover,            // hover detection
+    GraphLayout,      // GraphLayout::sync and step of a generic node/edge diagram
+    Render,           // grid and render_class_diagram
+    Count
+};
+
+enum class FrameCounter : std::uint8_t {
+    BodiesAwake,      // awake physics bodies after the step
+    LinesRebuilt,     // connection lines routed this frame
+    DrawVertices,     // vertices the canvas added to the draw list
+    Allocations,      // heap allocations during the frame, all threads (see allocation_counters.hpp)
+    Count
+};
+
+constexpr std::size_t frame_phase_count = static_cast<std::size_t>(FramePhase::Count);
+constexpr std::size_t frame_counter_count = static_cast<std::size_t>(FrameCounter::Count);
+
+const char* frame_phase_name(FramePhase phase);
+const char* frame_counter_name(FrameCounter counter);
+
+} // namespace profiling
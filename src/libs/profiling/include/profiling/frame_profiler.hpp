@@ -0,0 +1,112 @@
+#pragma once
+
+// Per-frame timings of the canvas phases plus a few counters, kept for the last frames so the
+// overlay can show rolling percentiles and a session can be dumped to CSV. Frames and phases
+// are also recorded as trace events while tracing is on (see trace.hpp).
+#include <profiling/allocation_counters.hpp>
+#include <profiling/frame_phase.hpp>
+#include <profiling/trace.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace profiling {
+
+struct FrameSample {
+    std::uint64_t frame = 0;
+    double total_ms = 0.0;  // begin_frame to end_frame, including time outside the phases
+    std::array<double, frame_phase_count> phase_ms{};
+    std::array<std::int64_t, frame_counter_count> counters{};
+    // Heap allocations of every thread while it ran the phase; all zero unless counting is
+    // active (see allocation_counters.hpp).
+    std::array<std::int64_t, frame_phase_count> phase_allocations{};
+};
+
+class FrameProfiler {
+public:
+    explicit FrameProfiler(std::size_t history = 1024);
+
+    // A disabled profiler ignores frames, timers and counters.
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool enabled() const { return enabled_; }
+
+    void begin_frame();
+    void end_frame();
+
+    // Only between begin_frame and end_frame; a phase may be timed several times per frame.
+    void add_time(FramePhase phase, double ms);
+    void set_counter(FrameCounter counter, std::int64_t value);
+
+    // Recorded frames, oldest first.
+    std::size_t size() const { return size_; }
+    const FrameSample& sample(std::size_t i) const;
+    const FrameSample* last() const { return size_ ? &sample(size_ - 1) : nullptr; }
+
+    // p in [0, 1] over the recorded frames; 0 when there are none.
+    double phase_percentile(FramePhase phase, double p) const;
+    double total_percentile(double p) const;
+    double counter_percentile(FrameCounter counter, double p) const;
+    double phase_allocation_percentile(FramePhase phase, double p) const;
+
+    // One line per recorded frame. Returns false if the file cannot be written.
+    bool write_csv(const std::string& path) const;
+    void clear();
+
+private:
+    double percentile_of(double (*value)(const FrameSample&, std::size_t), std::size_t field, double p) const;
+
+    std::vector<FrameSample> history_;  // ring buffer
+    std::size_t next_ = 0;
+    std::size_t size_ = 0;
+    FrameSample current_;
+    std::uint64_t frame_ = 0;
+    std::uint64_t allocations_at_begin_ = 0;
+    std::array<std::uint64_t, frame_phase_count> phase_allocations_at_begin_{};
+    std::chrono::steady_clock::time_point frame_start_;
+    bool in_frame_ = false;
+    bool count_allocations_ = false;  // counting was active at begin_frame
+    bool enabled_ = true;
+    mutable std::vector<double> scratch_;
+};
+
+// Adds the time until the end of the scope to `phase` of the current frame, and counts the
+// thread's allocations meanwhile under it.
+class ScopedPhase {
+public:
+    ScopedPhase(FrameProfiler& profiler, FramePhase phase)
+        : trace_(frame_phase_name(phase), "frame"), allocations_(phase), profiler_(profiler), phase_(phase),
+          start_(std::chrono::steady_clock::now()) {}
+    ~ScopedPhase() {
+        profiler_.add_time(phase_,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count());
+    }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    TraceScope trace_;
+    ScopedAllocationPhase allocations_;
+    FrameProfiler& profiler_;
+    FramePhase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// begin_frame / end_frame around a scope with early returns.
+class ScopedFrame {
+public:
+    explicit ScopedFrame(FrameProfiler& profiler) : trace_("frame", "frame"), profiler_(profiler) {
+        profiler_.begin_frame();
+    }
+    ~ScopedFrame() { profiler_.end_frame(); }
+    ScopedFrame(const ScopedFrame&) = delete;
+    ScopedFrame& operator=(const ScopedFrame&) = delete;
+
+private:
+    TraceScope trace_;
+    FrameProfiler& profiler_;
+};
+
+} // namespace profiling
@@ -0,0 +1,95 @@
+#include <profiling/allocation_counters.hpp>
+#include <atomic>
+
+namespace profiling {
+
+namespace {
+
+constexpr std::size_t tag_count = frame_phase_count + 1;  // phases + "no phase"
+
+// One cache line apart so threads do not contend; only the shared overflow block is written
+// by several threads.
+struct alignas(64) ThreadCounters {
+    std::atomic<std::uint64_t> count[tag_count];
+    std::atomic<std::uint64_t> bytes[tag_count];
+};
+
+// Static storage: counting must not allocate. Zero-initialized before any thread runs.
+ThreadCounters g_counters[max_counted_threads];
+std::atomic<std::size_t> g_threads{ 0 };
+std::atomic<bool> g_active{ false };
+
+thread_local ThreadCounters* t_counters = nullptr;
+thread_local FramePhase t_phase = FramePhase::Count;
+
+ThreadCounters& thread_counters() noexcept {
+    if (!t_counters) {
+        // The last block is shared by every thread past the limit.
+        const std::size_t slot = g_threads.fetch_add(1, std::memory_order_relaxed);
+        t_counters = &g_counters[slot < max_counted_threads ? slot : max_counted_threads - 1];
+    }
+    return *t_counters;
+}
+
+AllocationCount sum(const ThreadCounters& c, std::size_t first_tag, std::size_t last_tag) noexcept {
+    AllocationCount out;
+    for (std::size_t t = first_tag; t < last_tag; ++t) {
+        out.count += c.count[t].load(std::memory_order_relaxed);
+        out.bytes += c.bytes[t].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+std::size_t used_blocks() noexcept {
+    const std::size_t n = g_threads.load(std::memory_order_relaxed);
+    return n < max_counted_threads ? n : max_counted_threads;
+}
+
+} // namespace
+
+void note_allocation(std::size_t bytes) noexcept {
+    ThreadCounters& c = thread_counters();
+    const std::size_t tag = static_cast<std::size_t>(t_phase);
+    c.count[tag].fetch_add(1, std::memory_order_relaxed);
+    c.bytes[tag].fetch_add(bytes, std::memory_order_relaxed);
+    if (!g_active.load(std::memory_order_relaxed)) g_active.store(true, std::memory_order_relaxed);
+}
+
+FramePhase allocation_phase() noexcept {
+    return t_phase;
+}
+
+void set_allocation_phase(FramePhase phase) noexcept {
+    t_phase = phase;
+}
+
+AllocationCount thread_allocations() noexcept {
+    return t_counters ? sum(*t_counters, 0, tag_count) : AllocationCount{};
+}
+
+AllocationCount process_allocations() noexcept {
+    AllocationCount out;
+    for (std::size_t i = 0; i < used_blocks(); ++i) {
+        const AllocationCount c = sum(g_counters[i], 0, tag_count);
+        out.count += c.count;
+        out.bytes += c.bytes;
+    }
+    return out;
+}
+
+AllocationCount phase_allocations(FramePhase phase) noexcept {
+    const std::size_t tag = static_cast<std::size_t>(phase);
+    AllocationCount out;
+    for (std::size_t i = 0; i < used_blocks(); ++i) {
+        const AllocationCount c = sum(g_counters[i], tag, tag + 1);
+        out.count += c.count;
+        out.bytes += c.bytes;
+    }
+    return out;
+}
+
+bool allocation_counting_active() noexcept {
+    return g_active.load(std::memory_order_relaxed);
+}
+
+} // namespace profiling
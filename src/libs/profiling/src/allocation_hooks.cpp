@@ -0,0 +1,15 @@
+// Replacement of the global operator new / delete that feeds the allocation counters. Linked
+// only into executables that ask for it (target profiling_alloc_hooks). The array and nothrow
+// forms call these; over-aligned allocations keep the default operators and are not counted.
+#include <profiling/allocation_counters.hpp>
+#include <cstdlib>
+#include <new>
+
+void* operator new(std::size_t size) {
+    profiling::note_allocation(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,144 @@
+#include <profiling/frame_profiler.hpp>
+#include <profiling/allocation_counters.hpp>
+#include <algorithm>
+#include <cstdio>
+
+namespace profiling {
+
+namespace {
+
+double phase_value(const FrameSample& s, std::size_t i) { return s.phase_ms[i]; }
+double total_value(const FrameSample& s, std::size_t) { return s.total_ms; }
+double counter_value(const FrameSample& s, std::size_t i) { return static_cast<double>(s.counters[i]); }
+double phase_allocation_value(const FrameSample& s, std::size_t i) { return static_cast<double>(s.phase_allocations[i]); }
+
+} // namespace
+
+const char* frame_phase_name(FramePhase phase) {
+    switch (phase) {
+    case FramePhase::Input: return "input";
+    case FramePhase::PhysicsStep: return "physics_step";
+    case FramePhase::GetPlaced: return "get_placed";
+    case FramePhase::OverlapAudit: return "overlap_audit";
+    case FramePhase::ConnectionLines: return "connection_lines";
+    case FramePhase::Hover: return "hover";
+    case FramePhase::GraphLayout: return "graph_layout";
+    case FramePhase::Render: return "render";
+    case FramePhase::Count: break;
+    }
+    return "?";
+}
+
+const char* frame_counter_name(FrameCounter counter) {
+    switch (counter) {
+    case FrameCounter::BodiesAwake: return "bodies_awake";
+    case FrameCounter::LinesRebuilt: return "lines_rebuilt";
+    case FrameCounter::DrawVertices: return "draw_vertices";
+    case FrameCounter::Allocations: return "allocations";
+    case FrameCounter::Count: break;
+    }
+    return "?";
+}
+
+FrameProfiler::FrameProfiler(std::size_t history)
+    : history_(std::max<std::size_t>(history, 1)) {}
+
+void FrameProfiler::begin_frame() {
+    if (!enabled_) return;
+    current_ = FrameSample{};
+    current_.frame = frame_++;
+    count_allocations_ = allocation_counting_active();
+    if (count_allocations_) {
+        allocations_at_begin_ = process_allocations().count;
+        for (std::size_t i = 0; i < frame_phase_count; ++i)
+            phase_allocations_at_begin_[i] = phase_allocations(static_cast<FramePhase>(i)).count;
+    }
+    frame_start_ = std::chrono::steady_clock::now();
+    in_frame_ = true;
+}
+
+void FrameProfiler::end_frame() {
+    if (!in_frame_) return;
+    in_frame_ = false;
+    current_.total_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - frame_start_).count();
+    if (count_allocations_) {
+        current_.counters[static_cast<std::size_t>(FrameCounter::Allocations)] =
+            static_cast<std::int64_t>(process_allocations().count - allocations_at_begin_);
+        for (std::size_t i = 0; i < frame_phase_count; ++i) {
+            current_.phase_allocations[i] = static_cast<std::int64_t>(
+                phase_allocations(static_cast<FramePhase>(i)).count - phase_allocations_at_begin_[i]);
+        }
+    }
+    history_[next_] = current_;
+    next_ = (next_ + 1) % history_.size();
+    size_ = std::min(size_ + 1, history_.size());
+}
+
+void FrameProfiler::add_time(FramePhase phase, double ms) {
+    if (in_frame_) current_.phase_ms[static_cast<std::size_t>(phase)] += ms;
+}
+
+void FrameProfiler::set_counter(FrameCounter counter, std::int64_t value) {
+    if (in_frame_) current_.counters[static_cast<std::size_t>(counter)] = value;
+}
+
+const FrameSample& FrameProfiler::sample(std::size_t i) const {
+    // The oldest frame sits at next_ once the ring is full.
+    const std::size_t first = size_ < history_.size() ? 0 : next_;
+    return history_[(first + i) % history_.size()];
+}
+
+double FrameProfiler::percentile_of(double (*value)(const FrameSample&, std::size_t), std::size_t field, double p) const {
+    if (size_ == 0) return 0.0;
+    scratch_.clear();
+    for (std::size_t i = 0; i < size_; ++i) scratch_.push_back(value(history_[i], field));
+    const std::size_t k = static_cast<std::size_t>(std::clamp(p, 0.0, 1.0) * static_cast<double>(size_ - 1) + 0.5);
+    std::nth_element(scratch_.begin(), scratch_.begin() + static_cast<std::ptrdiff_t>(k), scratch_.end());
+    return scratch_[k];
+}
+
+double FrameProfiler::phase_percentile(FramePhase phase, double p) const {
+    return percentile_of(phase_value, static_cast<std::size_t>(phase), p);
+}
+
+double FrameProfiler::total_percentile(double p) const {
+    return percentile_of(total_value, 0, p);
+}
+
+double FrameProfiler::counter_percentile(FrameCounter counter, double p) const {
+    return percentile_of(counter_value, static_cast<std::size_t>(counter), p);
+}
+
+double FrameProfiler::phase_allocation_percentile(FramePhase phase, double p) const {
+    return percentile_of(phase_allocation_value, static_cast<std::size_t>(phase), p);
+}
+
+bool FrameProfiler::write_csv(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "frame,total_ms");
+    for (std::size_t i = 0; i < frame_phase_count; ++i)
+        std::fprintf(f, ",%s_ms", frame_phase_name(static_cast<FramePhase>(i)));
+    for (std::size_t i = 0; i < frame_counter_count; ++i)
+        std::fprintf(f, ",%s", frame_counter_name(static_cast<FrameCounter>(i)));
+    for (std::size_t i = 0; i < frame_phase_count; ++i)
+        std::fprintf(f, ",%s_allocs", frame_phase_name(static_cast<FramePhase>(i)));
+    std::fprintf(f, "\n");
+    for (std::size_t r = 0; r < size_; ++r) {
+        const FrameSample& s = sample(r);
+        std::fprintf(f, "%llu,%.4f", static_cast<unsigned long long>(s.frame), s.total_ms);
+        for (const double ms : s.phase_ms) std::fprintf(f, ",%.4f", ms);
+        for (const std::int64_t c : s.counters) std::fprintf(f, ",%lld", static_cast<long long>(c));
+        for (const std::int64_t c : s.phase_allocations) std::fprintf(f, ",%lld", static_cast<long long>(c));
+        std::fprintf(f, "\n");
+    }
+    return std::fclose(f) == 0;
+}
+
+void FrameProfiler::clear() {
+    next_ = 0;
+    size_ = 0;
+}
+
+} // namespace profiling
@@ -0,0 +1,187 @@
+#include <profiling/trace.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace profiling {
+
+namespace detail {
+
+std::atomic<bool> tracing_on{ false };
+
+} // namespace detail
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    std::uint64_t start_ns;
+    std::uint64_t end_ns;
+};
+
+// One ring buffer entry, guarded by a sequence lock: seq is 2 * index + 1 while event `index` is
+// being stored and 2 * index + 2 once it is complete. The fields are relaxed atomics so a reader
+// racing the writer gets a torn copy it then throws away, not undefined behaviour.
+struct TraceSlot {
+    std::atomic<std::uint64_t> seq{ 0 };
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<const char*> category{ nullptr };
+    std::atomic<std::uint64_t> start_ns{ 0 };
+    std::atomic<std::uint64_t> end_ns{ 0 };
+};
+
+// Written only by its thread; `written` is published with release so a reader sees the events
+// before it.
+struct ThreadBuffer {
+    std::unique_ptr<TraceSlot[]> events{ new TraceSlot[trace_buffer_events] };
+    std::atomic<std::uint64_t> written{ 0 };
+    std::atomic<std::uint64_t> cleared{ 0 };  // events before this index were dropped by clear_trace
+    std::uint32_t tid = 0;
+    char name[32] = {};  // guarded by Registry::mutex
+};
+
+// Buffers outlive their threads so a trace written at exit still has the worker events.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry() {
+    static Registry* r = new Registry();  // never destroyed: threads may record during exit
+    return *r;
+}
+
+const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+
+ThreadBuffer& thread_buffer() {
+    if (!t_buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffer->tid = static_cast<std::uint32_t>(r.buffers.size() + 1);
+        r.buffers.push_back(buffer);
+        t_buffer = std::move(buffer);
+    }
+    return *t_buffer;
+}
+
+// Trace names are literals; thread names are escaped just in case.
+void write_json_string(std::FILE* f, const char* s) {
+    std::fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') std::fputc('\\', f);
+        if (static_cast<unsigned char>(*s) >= 0x20) std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+} // namespace
+
+namespace detail {
+
+std::uint64_t trace_now_ns() noexcept {
+    // +1 keeps 0 free as TraceScope's "not recording" value.
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - trace_epoch).count()) + 1;
+}
+
+void record_trace_event(const char* name, const char* category, std::uint64_t start_ns, std::uint64_t end_ns) {
+    ThreadBuffer& b = thread_buffer();
+    const std::uint64_t n = b.written.load(std::memory_order_relaxed);
+    TraceSlot& slot = b.events[n % trace_buffer_events];
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    b.written.store(n + 1, std::memory_order_release);
+}
+
+} // namespace detail
+
+void set_tracing_enabled(bool enabled) {
+    detail::tracing_on.store(enabled, std::memory_order_relaxed);
+}
+
+void set_trace_thread_name(std::string_view name) {
+    ThreadBuffer& b = thread_buffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    const std::size_t n = std::min(name.size(), sizeof(b.name) - 1);
+    std::copy_n(name.data(), n, b.name);
+    b.name[n] = '\0';
+}
+
+bool write_chrome_trace(const std::string& path) {
+    struct Thread {
+        std::shared_ptr<ThreadBuffer> buffer;
+        std::string name;
+    };
+    std::vector<Thread> threads;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& b : r.buffers) threads.push_back({ b, b->name });
+    }
+
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    std::vector<TraceEvent> events;
+    for (const auto& [b, name] : threads) {
+        if (!name.empty()) {
+            std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                first ? "" : ",\n", b->tid);
+            write_json_string(f, name.c_str());
+            std::fprintf(f, "}}");
+            first = false;
+        }
+
+        const std::uint64_t end = b->written.load(std::memory_order_acquire);
+        const std::uint64_t begin = std::max(b->cleared.load(std::memory_order_relaxed),
+            end > trace_buffer_events ? end - trace_buffer_events : 0);
+        events.clear();
+        for (std::uint64_t i = begin; i < end; ++i) {
+            // The thread may have wrapped around while we copied; skip slots it has overwritten
+            // or is storing right now.
+            const TraceSlot& slot = b->events[i % trace_buffer_events];
+            const std::uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq != 2 * i + 2) continue;
+            const TraceEvent e{ slot.name.load(std::memory_order_relaxed), slot.category.load(std::memory_order_relaxed),
+                slot.start_ns.load(std::memory_order_relaxed), slot.end_ns.load(std::memory_order_relaxed) };
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq) continue;
+            events.push_back(e);
+        }
+
+        for (const TraceEvent& e : events) {
+            std::fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+            write_json_string(f, e.name);
+            std::fprintf(f, ",\"cat\":");
+            write_json_string(f, e.category);
+            std::fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                b->tid, static_cast<double>(e.start_ns) / 1000.0,
+                static_cast<double>(e.end_ns - e.start_ns) / 1000.0);
+            first = false;
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+void clear_trace() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& b : r.buffers) b->cleared.store(b->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+} // namespace profiling
@@ -0,0 +1,65 @@
+#pragma once
+
+// Scripted interaction with the canvas for the headless scenario runner: a list of steps, each
+// starting at a given frame, once the layout has settled, or on the frame after the previous
+// step. JSON form:
+//
+//   { "diagram": "../example_class_diagram.json", "dt": 0.0166667,
+//     "max_frames": 1200, "settle_frames": 30,
+//     "steps": [
+//       { "at_frame": 10, "action": "expand", "class": "NPC" },
+//       { "after_settle": true, "action": "nested_toggle", "path": "NPC/parent/0" },
+//       { "after_settle": true, "action": "drag", "class": "NPC", "dx": 400, "dy": 0, "frames": 30 },
+//       { "action": "pan", "dx": -200, "dy": 0 },
+//       { "action": "zoom", "factor": 0.5 } ] }
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace scenario {
+
+enum class StepTrigger {
+    AfterPrevious,  // the frame after the previous step
+    AtFrame,        // at_frame, or right after the previous step if that is later
+    AfterSettle,    // the first frame after the previous step with the layout settled
+};
+
+enum class StepAction {
+    Expand,        // class
+    Collapse,      // class
+    Toggle,        // class
+    NestedToggle,  // path; "expanded" sets the card instead of toggling it
+    Drag,          // class moved by (dx, dy) world units over `frames` frames, then released
+    Pan,           // (dx, dy) screen pixels
+    Zoom,          // factor, about the centre of the canvas
+    Focus,         // class centred in the canvas
+};
+
+const char* step_action_name(StepAction action);
+
+struct ScenarioStep {
+    StepTrigger trigger = StepTrigger::AfterPrevious;
+    int at_frame = 0;
+    StepAction action = StepAction::Expand;
+    std::string target;            // class id, or nested card path for NestedToggle
+    std::optional<bool> expanded;  // NestedToggle only
+    double dx = 0.0;
+    double dy = 0.0;
+    double factor = 1.0;
+    int frames = 30;
+};
+
+struct Scenario {
+    std::string diagram;  // class diagram JSON relative to the scenario file; empty if not given
+    float dt = 1.0f / 60.0f;
+    int max_frames = 3000;
+    int settle_frames = 30;  // frames in a row the layout must stay settled after the last step
+    std::vector<ScenarioStep> steps;
+};
+
+// nullopt on malformed JSON or an invalid step; `error`, if given, then says what is wrong.
+std::optional<Scenario> load_scenario_from_json(std::istream& in, std::string* error = nullptr);
+std::optional<Scenario> load_scenario_from_json_file(const std::string& path, std::string* error = nullptr);
+
+} // namespace scenario
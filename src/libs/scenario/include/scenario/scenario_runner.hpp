@@ -0,0 +1,44 @@
+#pragma once
+
+// Plays a Scenario against a canvas with a fixed time step and measures each step: frame time
+// from the step to the next one, frames until the layout settles, and block overlaps. The
+// caller owns the frame loop (ImGui context, window around the canvas) and passes it in.
+#include <scenario/scenario.hpp>
+#include <canvas/canvas.hpp>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace scenario {
+
+struct StepReport {
+    std::size_t step = 0;
+    bool applied = false;      // false if the class or path is not in the diagram
+    int start_frame = 0;
+    int frames = 0;            // up to the next step, or to the end of the run for the last one
+    double action_ms = 0.0;    // applying the action itself (re-measuring blocks, rebuilding bodies)
+    double total_ms = 0.0;     // action_ms plus every frame of the step
+    double max_frame_ms = 0.0;
+    int settle_frames = -1;    // frames from the end of the action until the layout settled; -1: never
+    std::size_t peak_overlap = 0;
+    std::size_t end_overlap = 0;
+};
+
+struct ScenarioReport {
+    std::vector<StepReport> steps;
+    int frames = 0;
+    bool settled = false;  // settled for settle_frames in a row after the last step
+    std::size_t peak_overlap = 0;
+    std::size_t final_overlap = 0;
+    double total_ms = 0.0;
+};
+
+// Runs one frame of `canvas` with `dt` as the frame's delta time and returns the milliseconds
+// spent in it.
+using FrameFunction = std::function<double(canvas::DiagramCanvas& canvas, float dt)>;
+
+// Stops once the layout has stayed settled for settle_frames after the last step, or at
+// max_frames.
+ScenarioReport run_scenario(canvas::DiagramCanvas& canvas, const Scenario& scenario, const FrameFunction& run_frame);
+
+} // namespace scenario
@@ -0,0 +1,130 @@
+#include <scenario/scenario.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+#include <utility>
+
+namespace scenario {
+
+namespace {
+
+struct ActionName {
+    StepAction action;
+    std::string_view name;
+};
+
+constexpr ActionName action_names[] = {
+    { StepAction::Expand, "expand" },
+    { StepAction::Collapse, "collapse" },
+    { StepAction::Toggle, "toggle" },
+    { StepAction::NestedToggle, "nested_toggle" },
+    { StepAction::Drag, "drag" },
+    { StepAction::Pan, "pan" },
+    { StepAction::Zoom, "zoom" },
+    { StepAction::Focus, "focus" },
+};
+
+double number_or(const nlohmann::json& j, const char* key, double fallback) {
+    return j.contains(key) && j[key].is_number() ? j[key].get<double>() : fallback;
+}
+
+bool fail(std::string* error, std::string message) {
+    if (error) *error = std::move(message);
+    return false;
+}
+
+bool parse_step(const nlohmann::json& s, std::size_t index, ScenarioStep& step, std::string* error) {
+    const std::string where = "step " + std::to_string(index) + ": ";
+    if (!s.is_object()) return fail(error, where + "not an object");
+
+    if (s.contains("at_frame") && s["at_frame"].is_number_integer()) {
+        step.trigger = StepTrigger::AtFrame;
+        step.at_frame = std::max(0, s["at_frame"].get<int>());
+    } else if (s.contains("after_settle") && s["after_settle"].is_boolean() && s["after_settle"].get<bool>()) {
+        step.trigger = StepTrigger::AfterSettle;
+    }
+
+    const std::string action = s.contains("action") && s["action"].is_string() ? s["action"].get<std::string>() : "";
+    const auto it = std::find_if(std::begin(action_names), std::end(action_names),
+        [&](const ActionName& a) { return a.name == action; });
+    if (it == std::end(action_names)) return fail(error, where + "unknown action \"" + action + "\"");
+    step.action = it->action;
+
+    switch (step.action) {
+    case StepAction::NestedToggle:
+        if (!s.contains("path") || !s["path"].is_string()) return fail(error, where + "nested_toggle needs \"path\"");
+        step.target = s["path"].get<std::string>();
+        if (s.contains("expanded") && s["expanded"].is_boolean()) step.expanded = s["expanded"].get<bool>();
+        break;
+    case StepAction::Pan:
+        step.dx = number_or(s, "dx", 0.0);
+        step.dy = number_or(s, "dy", 0.0);
+        break;
+    case StepAction::Zoom:
+        step.factor = number_or(s, "factor", 1.0);
+        if (step.factor <= 0.0) return fail(error, where + "zoom needs a positive \"factor\"");
+        break;
+    default:
+        if (!s.contains("class") || !s["class"].is_string())
+            return fail(error, where + std::string(it->name) + " needs \"class\"");
+        step.target = s["class"].get<std::string>();
+        if (step.action == StepAction::Drag) {
+            step.dx = number_or(s, "dx", 0.0);
+            step.dy = number_or(s, "dy", 0.0);
+            step.frames = std::max(1, static_cast<int>(number_or(s, "frames", step.frames)));
+        }
+        break;
+    }
+    return true;
+}
+
+} // namespace
+
+const char* step_action_name(StepAction action) {
+    for (const ActionName& a : action_names)
+        if (a.action == action) return a.name.data();
+    return "?";
+}
+
+std::optional<Scenario> load_scenario_from_json(std::istream& in, std::string* error) {
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(in);
+    } catch (const nlohmann::json::exception& e) {
+        fail(error, e.what());
+        return std::nullopt;
+    }
+    if (!j.is_object() || !j.contains("steps") || !j["steps"].is_array()) {
+        fail(error, "no \"steps\" array");
+        return std::nullopt;
+    }
+
+    Scenario out;
+    if (j.contains("diagram") && j["diagram"].is_string()) out.diagram = j["diagram"].get<std::string>();
+    out.dt = static_cast<float>(number_or(j, "dt", out.dt));
+    out.max_frames = std::max(1, static_cast<int>(number_or(j, "max_frames", out.max_frames)));
+    out.settle_frames = std::max(1, static_cast<int>(number_or(j, "settle_frames", out.settle_frames)));
+    if (out.dt <= 0.0f) {
+        fail(error, "\"dt\" must be positive");
+        return std::nullopt;
+    }
+
+    for (const auto& s : j["steps"]) {
+        ScenarioStep step;
+        if (!parse_step(s, out.steps.size(), step, error)) return std::nullopt;
+        out.steps.push_back(std::move(step));
+    }
+    return out;
+}
+
+std::optional<Scenario> load_scenario_from_json_file(const std::string& path, std::string* error) {
+    std::ifstream f(path);
+    if (!f) {
+        fail(error, "cannot open " + path);
+        return std::nullopt;
+    }
+    return load_scenario_from_json(f, error);
+}
+
+} // namespace scenario
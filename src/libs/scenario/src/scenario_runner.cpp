@@ -0,0 +1,127 @@
+#include <scenario/scenario_runner.hpp>
+#include <diagram_render/nested_expansion.hpp>
+#include <profiling/trace.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace scenario {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool has_class(const canvas::DiagramCanvas& canvas, const std::string& class_id) {
+    const diagram_model::ClassDiagram* diagram = canvas.class_diagram();
+    if (!diagram) return false;
+    return std::any_of(diagram->classes.begin(), diagram->classes.end(),
+        [&](const diagram_model::DiagramClass& c) { return c.id == class_id; });
+}
+
+// Starts the step's action; a drag is then moved by the frame loop.
+bool apply_step(canvas::DiagramCanvas& canvas, const ScenarioStep& step) {
+    switch (step.action) {
+    case StepAction::Expand:
+        return canvas.set_class_block_expanded(step.target, true);
+    case StepAction::Collapse:
+        return canvas.set_class_block_expanded(step.target, false);
+    case StepAction::Toggle: {
+        const auto& expanded = canvas.class_expanded();
+        const auto it = expanded.find(step.target);
+        return canvas.set_class_block_expanded(step.target, it == expanded.end() || !it->second);
+    }
+    case StepAction::NestedToggle: {
+        if (step.expanded) return canvas.set_nested_card_expanded(step.target, *step.expanded);
+        const auto key = diagram_render::nested_path_key(step.target);
+        return key && canvas.set_nested_card_expanded(step.target, !canvas.nested_expanded().contains(*key));
+    }
+    case StepAction::Drag:
+        return canvas.begin_block_drag(step.target);
+    case StepAction::Pan:
+        canvas.pan(static_cast<float>(step.dx), static_cast<float>(step.dy));
+        return true;
+    case StepAction::Zoom:
+        canvas.zoom_at_center(static_cast<float>(step.factor));
+        return true;
+    case StepAction::Focus:
+        if (!has_class(canvas, step.target)) return false;
+        canvas.focus_on_class(step.target);
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+ScenarioReport run_scenario(canvas::DiagramCanvas& canvas, const Scenario& scenario, const FrameFunction& run_frame) {
+    ScenarioReport report;
+    report.steps.reserve(scenario.steps.size());
+    std::size_t next = 0;
+    int last_step_frame = -1;
+    int action_end_frame = 0;           // first frame after the current step's action is done
+    const ScenarioStep* drag = nullptr;  // step whose drag is in progress
+    int settled_run = 0;
+
+    for (int frame = 0; frame < scenario.max_frames; ++frame) {
+        // At most one step per frame, and none while a drag is in progress.
+        if (!drag && next < scenario.steps.size() && frame > last_step_frame) {
+            const ScenarioStep& step = scenario.steps[next];
+            const bool ready = step.trigger == StepTrigger::AfterPrevious
+                || (step.trigger == StepTrigger::AtFrame && frame >= step.at_frame)
+                || (step.trigger == StepTrigger::AfterSettle && canvas.is_layout_settled());
+            if (ready) {
+                profiling::TraceScope trace(step_action_name(step.action), "scenario");
+                StepReport r;
+                r.step = next;
+                r.start_frame = frame;
+                const auto t0 = Clock::now();
+                r.applied = apply_step(canvas, step);
+                r.action_ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+                r.total_ms = r.action_ms;
+                report.steps.push_back(r);
+                action_end_frame = frame;
+                if (r.applied && step.action == StepAction::Drag) {
+                    drag = &step;
+                    action_end_frame = frame + step.frames;
+                }
+                last_step_frame = frame;
+                ++next;
+            }
+        }
+
+        if (drag) {
+            const double t = static_cast<double>(frame + 1 - last_step_frame) / static_cast<double>(drag->frames);
+            canvas.drag_block_by(drag->dx * t, drag->dy * t);
+        }
+        const double ms = run_frame(canvas, scenario.dt);
+        if (drag && frame + 1 >= action_end_frame) {
+            canvas.end_block_drag();
+            drag = nullptr;
+        }
+
+        const std::size_t overlap = canvas.current_overlap_count();
+        const bool settled = canvas.is_layout_settled();
+        report.frames = frame + 1;
+        report.total_ms += ms;
+        report.peak_overlap = std::max(report.peak_overlap, overlap);
+        if (!report.steps.empty()) {
+            StepReport& r = report.steps.back();
+            ++r.frames;
+            r.total_ms += ms;
+            r.max_frame_ms = std::max(r.max_frame_ms, ms);
+            r.peak_overlap = std::max(r.peak_overlap, overlap);
+            r.end_overlap = overlap;
+            if (r.settle_frames < 0 && !drag && settled) r.settle_frames = frame + 1 - action_end_frame;
+        }
+
+        if (next < scenario.steps.size() || drag) continue;
+        settled_run = settled ? settled_run + 1 : 0;
+        if (settled_run >= scenario.settle_frames) {
+            report.settled = true;
+            break;
+        }
+    }
+    report.final_overlap = canvas.current_overlap_count();
+    return report;
+}
+
+} // namespace scenario
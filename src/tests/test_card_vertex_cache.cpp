@@ -0,0 +1,96 @@
+// CardVertexCache: a recording keeps one segment per draw command with card-local hit regions,
+// replays scaled and translated into another draw list, and is dropped by invalidate/clear.
+#include "test_check.hpp"
+#include "card_vertex_cache.hpp"
+#include "imgui.h"
+#include <cmath>
+
+namespace {
+
+bool near(ImVec2 a, ImVec2 b) {
+    return std::fabs(a.x - b.x) < 1e-3f && std::fabs(a.y - b.y) < 1e-3f;
+}
+
+} // namespace
+
+int main()
+{
+    using diagram_render::detail::CardRecording;
+    using diagram_render::detail::CardVertexCache;
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int w = 0, h = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+    ImGui::NewFrame();
+    ImDrawList& target = *ImGui::GetForegroundDrawList();
+
+    CardVertexCache cache;
+    cache.begin_frame();
+    CardRecording& rec = cache.slot(5);
+    CHECK(!rec.matches(200.0, 100.0, 1.0f));
+
+    // Two rectangles, the second under its own clip rect: two draw commands, two segments.
+    {
+        ImDrawList scratch(ImGui::GetDrawListSharedData());
+        CardVertexCache::begin_recording(scratch, target);
+        scratch.AddRectFilled(ImVec2(10.0f, 20.0f), ImVec2(30.0f, 40.0f), IM_COL32(255, 0, 0, 255));
+        scratch.PushClipRect(ImVec2(0.0f, 0.0f), ImVec2(15.0f, 15.0f), true);
+        scratch.AddRectFilled(ImVec2(0.0f, 0.0f), ImVec2(5.0f, 5.0f), IM_COL32(0, 255, 0, 255));
+        scratch.PopClipRect();
+        rec.hit_buttons.clear();
+        rec.hit_buttons.push_back({});
+        rec.hit_buttons.back().x = 110.0;
+        rec.hit_buttons.back().y = 220.0;
+        CardVertexCache::end_recording(scratch, rec, 200.0, 100.0, 1.0f, 100.0, 200.0);
+    }
+    CHECK(rec.matches(200.0, 100.0, 1.0f));
+    CHECK(!rec.matches(200.0, 101.0, 1.0f));
+    CHECK(!rec.matches(200.0, 100.0, 1.5f));
+    CHECK(rec.segments.size() == 2);
+    CHECK(rec.vertices.size() == 8);
+    CHECK(rec.indices.size() == 12);
+    CHECK(rec.hit_buttons.size() == 1 && rec.hit_buttons[0].x == 10.0 && rec.hit_buttons[0].y == 20.0);
+    // Indices are relative to their segment's first vertex.
+    bool local = true;
+    for (const CardRecording::Segment& seg : rec.segments)
+        for (std::uint32_t i = 0; i < seg.idx_count; ++i)
+            local = local && rec.indices[seg.idx_begin + i] < seg.vtx_count;
+    CHECK(local);
+
+    // Replay at twice the recorded zoom, moved to (5, 7).
+    const int vtx_before = target.VtxBuffer.Size;
+    const int cmd_before = target.CmdBuffer.Size;
+    CardVertexCache::replay(rec, target, 2.0f, ImVec2(5.0f, 7.0f));
+    CHECK(target.VtxBuffer.Size == vtx_before + 8);
+    bool moved = true;
+    for (int i = 0; i < 8; ++i) {
+        const ImVec2 p = rec.vertices[i].pos;
+        moved = moved && near(target.VtxBuffer[vtx_before + i].pos, ImVec2(p.x * 2.0f + 5.0f, p.y * 2.0f + 7.0f));
+    }
+    CHECK(moved);
+    bool clipped = false;
+    for (int c = cmd_before - 1; c < target.CmdBuffer.Size; ++c) {
+        const ImVec4& r = target.CmdBuffer[c].ClipRect;
+        clipped = clipped || (near(ImVec2(r.x, r.y), ImVec2(5.0f, 7.0f)) && near(ImVec2(r.z, r.w), ImVec2(35.0f, 37.0f)));
+    }
+    CHECK(clipped);
+
+    // Same atlas: recordings survive begin_frame; invalidate and clear drop them.
+    cache.begin_frame();
+    CHECK(cache.slot(5).valid);
+    cache.invalidate(5);
+    CHECK(!cache.slot(5).valid);
+    cache.slot(5).valid = true;
+    cache.invalidate(1000);  // never recorded: no-op
+    cache.clear();
+    CHECK(!cache.slot(5).valid);
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    return test::test_result();
+}
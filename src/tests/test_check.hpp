@@ -0,0 +1,26 @@
+#pragma once
+
+// Minimal checks for the test executables (no test framework): a failed CHECK prints the
+// expression and its location, and the test's main returns test_result().
+#include <cstdio>
+
+namespace test {
+
+inline int failures = 0;
+
+inline bool check(bool ok, const char* expr, const char* file, int line) {
+    if (!ok) {
+        ++failures;
+        (void)fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+    }
+    return ok;
+}
+
+inline int test_result() {
+    if (failures) (void)fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
+
+} // namespace test
+
+#define CHECK(expr) ::test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
@@ -0,0 +1,82 @@
+// bundle_connection_lines: a hub with enough children gets one trunk and bus, members are cut
+// at the bus, and small hubs and hover-only lines are left alone.
+#include "test_check.hpp"
+#include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/edge_bundling.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <string>
+
+namespace {
+
+using diagram_placement::ConnectionGeometry;
+using diagram_placement::PlacedClassDiagram;
+
+// Parent "Hub" above `children` classes in a row; every child also has "Other" as second parent.
+void make_hub(std::size_t children, diagram_model::ClassDiagram& diagram, PlacedClassDiagram& placed) {
+    diagram.classes.clear();
+    placed.blocks.clear();
+    auto add = [&](std::string id, double x, double y) {
+        diagram_model::DiagramClass c;
+        c.id = id;
+        c.type_name = id;
+        diagram.classes.push_back(c);
+        diagram_placement::PlacedClassBlock b;
+        b.class_id = id;
+        b.class_index = diagram.classes.size() - 1;
+        b.rect = { x, y, 100.0, 50.0 };
+        placed.blocks.push_back(b);
+    };
+    add("Hub", 1000.0, 0.0);
+    add("Other", 3000.0, 0.0);
+    for (std::size_t i = 0; i < children; ++i) {
+        add("Child" + std::to_string(i), static_cast<double>(i) * 150.0, 400.0);
+        diagram.classes.back().parent_class_ids = { "Hub", "Other" };
+    }
+}
+
+} // namespace
+
+int main()
+{
+    diagram_model::ClassDiagram diagram;
+    PlacedClassDiagram placed;
+    ConnectionGeometry geometry;
+    diagram_placement::ConnectionBundles bundles;
+
+    make_hub(12, diagram, placed);
+    diagram_placement::compute_connection_lines(diagram, placed, geometry);
+    diagram_placement::bundle_connection_lines(geometry, bundles);
+    CHECK(bundles.size() == 1);
+    if (bundles.size() == 1) {
+        // Trunk runs from the bus straight up into the hub's bottom-centre anchor.
+        const float* trunk = bundles.trunk.data();
+        CHECK(trunk[2] == 1050.0f && trunk[3] == 50.0f);
+        CHECK(trunk[0] == trunk[2] && trunk[1] > trunk[3]);
+        const float bus_y = bundles.bus[1];
+        CHECK(bundles.bus[3] == bus_y && bus_y == trunk[1]);
+        CHECK(bundles.bus[0] <= 50.0f && bundles.bus[2] >= 11.0f * 150.0f + 50.0f);
+    }
+    std::size_t bundled = 0;
+    for (std::size_t line = 0; line < geometry.size(); ++line) {
+        if (geometry.kind[line] == diagram_placement::ConnectionKind::SecondaryInheritance) {
+            CHECK(!bundles.is_bundled(line));
+            continue;
+        }
+        CHECK(bundles.is_bundled(line));
+        if (!bundles.is_bundled(line)) continue;
+        ++bundled;
+        // Cut where the member reaches the bus.
+        const float* pts = geometry.route(line);
+        const std::uint32_t n = geometry.point_count[line];
+        CHECK(n >= 2 && pts[2 * n - 1] == bundles.bus[1]);
+    }
+    CHECK(bundled == 12);
+
+    // Below min_fan_in nothing is bundled and routes stay whole.
+    make_hub(5, diagram, placed);
+    diagram_placement::compute_connection_lines(diagram, placed, geometry);
+    diagram_placement::bundle_connection_lines(geometry, bundles);
+    CHECK(bundles.size() == 0);
+    for (std::size_t line = 0; line < geometry.size(); ++line) CHECK(!bundles.is_bundled(line));
+    return test::test_result();
+}
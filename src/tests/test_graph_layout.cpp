@@ -0,0 +1,87 @@
+// GraphLayout: connected nodes settle near the ideal edge length, pinned nodes stay put, and
+// coincident nodes (aggregated in one quadtree leaf) repel from where they are.
+#include "test_check.hpp"
+#include <diagram_placement/graph_layout.hpp>
+#include <diagram_model/types.hpp>
+#include <cmath>
+#include <string>
+
+namespace {
+
+diagram_model::Node make_node(std::string id, double x = 0.0, double y = 0.0) {
+    diagram_model::Node n;
+    n.id = id;
+    n.label = id;
+    n.x = x;
+    n.y = y;
+    return n;
+}
+
+diagram_model::Edge make_edge(std::string from, std::string to) {
+    diagram_model::Edge e;
+    e.id = from + "-" + to;
+    e.source_node_id = from;
+    e.target_node_id = to;
+    return e;
+}
+
+struct Centre {
+    double x = 0.0, y = 0.0;
+};
+
+Centre centre_of(const diagram_placement::PlacedDiagram& placed, const std::string& id) {
+    for (const auto& n : placed.placed_nodes)
+        if (n.node_id == id) return { n.rect.x + n.rect.width * 0.5, n.rect.y + n.rect.height * 0.5 };
+    return {};
+}
+
+double distance(Centre a, Centre b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+} // namespace
+
+int main()
+{
+    diagram_placement::GraphLayoutOptions options;
+    options.parallel = false;
+
+    // A free chain settles with edges of the order of the ideal length (the spring-electrical
+    // balance is somewhat shorter), none collapsed.
+    {
+        diagram_model::Diagram diagram;
+        for (int i = 0; i < 6; ++i) diagram.nodes.push_back(make_node("n" + std::to_string(i)));
+        for (int i = 0; i + 1 < 6; ++i)
+            diagram.edges.push_back(make_edge("n" + std::to_string(i), "n" + std::to_string(i + 1)));
+        diagram_placement::GraphLayout layout;
+        layout.set_options(options);
+        layout.sync(diagram);
+        layout.run_to_convergence(2000);
+        CHECK(layout.is_settled());
+        const auto& placed = layout.placed();
+        CHECK(placed.placed_nodes.size() == 6);
+        for (int i = 0; i + 1 < 6; ++i) {
+            const double d = distance(centre_of(placed, "n" + std::to_string(i)), centre_of(placed, "n" + std::to_string(i + 1)));
+            CHECK(d > 0.25 * options.ideal_edge_length && d < 2.0 * options.ideal_edge_length);
+        }
+    }
+
+    // Two pinned nodes on the same spot far from the origin share a quadtree leaf at maximum
+    // depth. A free node tied to them must be pushed away from that spot, not from the origin.
+    {
+        diagram_model::Diagram diagram;
+        diagram.nodes = { make_node("a", 10000.0, 10000.0), make_node("b", 10000.0, 10000.0), make_node("c") };
+        diagram.edges = { make_edge("c", "a"), make_edge("c", "b") };
+        diagram_placement::GraphLayout layout;
+        layout.set_options(options);
+        layout.sync(diagram);
+        const Centre pinned = centre_of(layout.placed(), "a");
+        layout.run_to_convergence(2000);
+        const auto& placed = layout.placed();
+        const Centre a = centre_of(placed, "a");
+        CHECK(a.x == pinned.x && a.y == pinned.y);
+        CHECK(distance(centre_of(placed, "b"), pinned) == 0.0);
+        CHECK(distance(centre_of(placed, "c"), pinned) > 0.25 * options.ideal_edge_length);
+    }
+    return test::test_result();
+}
@@ -0,0 +1,131 @@
+// LineBatch: dashed polylines terminate and keep their pattern around corners for dash lengths
+// of several zoom levels, and polylines longer than one 16-bit chunk are split.
+#include "test_check.hpp"
+#include "line_batch.hpp"
+#include "imgui.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Vertices LineBatch emits per dash (one two-point polyline).
+constexpr int vertices_per_dash = 8;
+
+int flushed_vertices(diagram_render::detail::LineBatch& batch, ImDrawList& list) {
+    const int before = list.VtxBuffer.Size;
+    batch.flush(list);
+    return list.VtxBuffer.Size - before;
+}
+
+// Dashes of a straight line of `length`, counted like the renderer's pattern: dash k starts at
+// k * (dash + gap).
+int expected_dashes(double length, double dash, double gap) {
+    int n = 0;
+    for (int k = 0; k * (dash + gap) < length; ++k)
+        if (std::min(k * (dash + gap) + dash, length) - k * (dash + gap) >= 1e-3) ++n;
+    return n;
+}
+
+// Largest distance between two vertices of one triangle drawn into `list`.
+float max_triangle_span(const ImDrawList& list) {
+    float span = 0.0f;
+    for (const ImDrawCmd& cmd : list.CmdBuffer) {
+        const ImDrawIdx* idx = list.IdxBuffer.Data + cmd.IdxOffset;
+        for (unsigned int i = 0; i + 2 < cmd.ElemCount; i += 3) {
+            const ImVec2 p[3] = { list.VtxBuffer[static_cast<int>(cmd.VtxOffset + idx[i])].pos,
+                list.VtxBuffer[static_cast<int>(cmd.VtxOffset + idx[i + 1])].pos,
+                list.VtxBuffer[static_cast<int>(cmd.VtxOffset + idx[i + 2])].pos };
+            for (int a = 0; a < 3; ++a) {
+                const ImVec2 q = p[(a + 1) % 3];
+                span = std::max(span, std::hypot(p[a].x - q.x, p[a].y - q.y));
+            }
+        }
+    }
+    return span;
+}
+
+} // namespace
+
+int main()
+{
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    unsigned char* pixels = nullptr;
+    int w = 0, h = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+    ImGui::NewFrame();
+    ImDrawList& list = *ImGui::GetForegroundDrawList();
+    const ImU32 color = IM_COL32(255, 255, 255, 255);
+
+    diagram_render::detail::LineBatch batch;
+
+    // Dash and gap as the renderer sizes them (8 and 4 px at zoom 1) against segment lengths
+    // that end near a period boundary; zoom 1.2 once made the walk stall at 14.4 px.
+    const float zooms[] = { 0.25f, 0.3f, 0.7f, 1.0f, 1.2f, 1.7f, 2.9f, 3.3f };
+    const float lengths[] = { 0.5f, 14.4f, 14.4000006f, 28.8f, 100.0f, 333.3f, 1234.5f };
+    for (const float zoom : zooms) {
+        const float dash = 8.0f * zoom;
+        const float gap = 4.0f * zoom;
+        for (const float length : lengths) {
+            // Straight line: exactly the dashes of the pattern.
+            const ImVec2 line[2] = { ImVec2(10.0f, 10.0f), ImVec2(10.0f + length, 10.0f) };
+            batch.begin(list);
+            batch.add_dashed_polyline(line, 2, color, 2.0f, dash, gap);
+            CHECK(flushed_vertices(batch, list) == vertices_per_dash * expected_dashes(length, dash, gap));
+
+            // The same length folded into a staircase of uneven steps: the pattern runs on around
+            // the corners, which split at most one dash each.
+            std::vector<ImVec2> stairs { ImVec2(10.0f, 10.0f) };
+            float left = length;
+            for (int i = 0; left > 0.0f; ++i) {
+                const float step = std::min(left, dash * (0.37f + 0.91f * static_cast<float>(i % 5)));
+                const ImVec2 p = stairs.back();
+                stairs.push_back(i % 2 ? ImVec2(p.x, p.y + step) : ImVec2(p.x + step, p.y));
+                left -= step;
+            }
+            batch.begin(list);
+            batch.add_dashed_polyline(stairs.data(), stairs.size(), color, 2.0f, dash, gap);
+            const int pieces = flushed_vertices(batch, list) / vertices_per_dash;
+            const int dashes = expected_dashes(length, dash, gap);
+            const int corners = static_cast<int>(stairs.size()) - 2;
+            CHECK(pieces >= dashes - 1);
+            CHECK(pieces <= dashes + corners);
+        }
+    }
+
+    // A corner inside the first dash splits it in two and does not restart the pattern.
+    {
+        const ImVec2 straight[2] = { ImVec2(0.0f, 0.0f), ImVec2(100.0f, 0.0f) };
+        const ImVec2 bent[3] = { ImVec2(0.0f, 0.0f), ImVec2(3.0f, 0.0f), ImVec2(3.0f, 97.0f) };
+        batch.begin(list);
+        batch.add_dashed_polyline(straight, 2, color, 2.0f, 6.0f, 4.0f);
+        const int straight_vertices = flushed_vertices(batch, list);
+        batch.add_dashed_polyline(bent, 3, color, 2.0f, 6.0f, 4.0f);
+        CHECK(straight_vertices == 10 * vertices_per_dash);
+        CHECK(flushed_vertices(batch, list) == 11 * vertices_per_dash);
+    }
+
+    // 20k points need 80k vertices, more than 16-bit indices address: every triangle must
+    // still join neighbouring points, not wrap around to the start of the line.
+    {
+        std::vector<ImVec2> long_line;
+        for (int i = 0; i < 20000; ++i)
+            long_line.emplace_back(static_cast<float>(i) * 0.5f, 20.0f);
+        ImGui::EndFrame();
+        ImGui::NewFrame();
+        ImDrawList& fresh = *ImGui::GetForegroundDrawList();
+        batch.begin(fresh);
+        batch.add_polyline(long_line.data(), long_line.size(), color, 1.0f, false);
+        CHECK(flushed_vertices(batch, fresh) >= 4 * 20000);
+        CHECK(max_triangle_span(fresh) < 5.0f);
+    }
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    return test::test_result();
+}
@@ -0,0 +1,140 @@
+// NestedExpansion: the open-addressing set agrees with std::set through inserts and deletes,
+// including colliding keys removed by backward shift, and nested_path_key parses string paths
+// into the same keys the card traversal derives.
+#include "test_check.hpp"
+#include <diagram_render/nested_expansion.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using diagram_render::NestedExpansion;
+using diagram_render::NestedPathKey;
+using diagram_render::NestedSection;
+
+bool same_as(const NestedExpansion& set, const std::set<NestedPathKey>& model,
+    const std::vector<NestedPathKey>& universe)
+{
+    if (set.size() != model.size()) return false;
+    for (const NestedPathKey key : universe)
+        if (set.contains(key) != (model.count(key) != 0)) return false;
+    return true;
+}
+
+diagram_model::DiagramClass make_class(std::string id) {
+    diagram_model::DiagramClass c;
+    c.type_name = id;
+    c.id = std::move(id);
+    return c;
+}
+
+} // namespace
+
+int main()
+{
+    // Keys that are multiples of 2^20 share their home slot in every table up to 2^20 slots,
+    // so they form one long probe run; deleting from its middle must keep the rest reachable.
+    {
+        NestedExpansion set;
+        std::vector<NestedPathKey> keys;
+        for (NestedPathKey k = 1; k <= 40; ++k) keys.push_back(k << 20);
+        for (const NestedPathKey key : keys) set.set(key, true);
+        CHECK(set.size() == keys.size());
+        std::set<NestedPathKey> model(keys.begin(), keys.end());
+        for (std::size_t i = 0; i < keys.size(); i += 3) {
+            set.set(keys[i], false);
+            model.erase(keys[i]);
+            CHECK(same_as(set, model, keys));
+        }
+        set.set(keys[1], true);  // already present
+        CHECK(same_as(set, model, keys));
+        set.set(keys[0], false);  // already absent
+        CHECK(same_as(set, model, keys));
+    }
+
+    // Random inserts, deletes and toggles over a small key range, with a few colliding keys mixed
+    // in, checked against std::set after every step.
+    {
+        std::mt19937_64 rng(12345);
+        std::vector<NestedPathKey> universe;
+        for (int i = 0; i < 200; ++i) universe.push_back(rng() | 1);
+        for (NestedPathKey k = 1; k <= 24; ++k) universe.push_back(k << 32);
+        NestedExpansion set;
+        std::set<NestedPathKey> model;
+        bool agrees = true;
+        for (int step = 0; step < 20000 && agrees; ++step) {
+            const NestedPathKey key = universe[rng() % universe.size()];
+            switch (rng() % 3) {
+            case 0: set.set(key, true); model.insert(key); break;
+            case 1: set.set(key, false); model.erase(key); break;
+            default:
+                if (set.toggle(key)) model.insert(key);
+                else model.erase(key);
+                break;
+            }
+            agrees = same_as(set, model, universe);
+        }
+        CHECK(agrees);
+        set.clear();
+        CHECK(set.size() == 0);
+        CHECK(!set.contains(universe[0]));
+    }
+
+    // String paths: steps are read from the end, so class ids may contain '/'.
+    {
+        using diagram_render::nested_child_key;
+        using diagram_render::nested_path_key;
+        using diagram_render::nested_root_key;
+        const NestedPathKey player = nested_root_key("Player");
+        const NestedPathKey expected = nested_child_key(nested_child_key(player, NestedSection::Child, 0),
+            NestedSection::Parent, 12);
+        std::string_view block;
+        CHECK(nested_path_key("Player/child/0/parent/12", &block) == expected);
+        CHECK(block == "Player");
+        CHECK(nested_path_key("game/Player/child/3", &block)
+            == nested_child_key(nested_root_key("game/Player"), NestedSection::Child, 3));
+        CHECK(block == "game/Player");
+        CHECK(nested_path_key("Player/parent/0") != nested_path_key("Player/child/0"));
+        CHECK(nested_path_key("Player/child/0/parent/1") != nested_path_key("Player/parent/1/child/0"));
+
+        const char* malformed[] = { "", "Player", "Player/child", "Player/child/", "Player/child/x",
+            "Player/child/1x", "Player/child/-1", "Player/sibling/0", "/child/0", "child/0" };
+        for (const char* path : malformed)
+            CHECK(!nested_path_key(path));
+        // Trailing steps that do not parse end the path; the rest is not a valid path either.
+        CHECK(!nested_path_key("Player/child/0/extra"));
+    }
+
+    // Save and load: only cards whose enclosing cards are expanded are listed.
+    {
+        diagram_model::ClassDiagram diagram;
+        diagram.classes.push_back(make_class("A"));
+        diagram.classes.push_back(make_class("B"));
+        diagram.classes.push_back(make_class("C"));
+        diagram.classes[0].child_objects.push_back({ "B", "b" });
+        diagram.classes[1].parent_class_ids.push_back("C");
+
+        NestedExpansion set;
+        CHECK(set.set_path("A/child/0", true));
+        CHECK(set.set_path("A/child/0/parent/0", true));
+        CHECK(!set.set_path("A/child", true));
+        const std::vector<std::string> paths = set.expanded_paths(diagram);
+        CHECK(paths == std::vector<std::string>({ "A/child/0", "A/child/0/parent/0" }));
+
+        CHECK(set.set_path("A/child/0", false));
+        CHECK(set.size() == 1);
+        CHECK(set.expanded_paths(diagram).empty());
+
+        NestedExpansion loaded;
+        for (const std::string& path : paths) CHECK(loaded.set_path(path, true));
+        CHECK(loaded.contains(*diagram_render::nested_path_key("A/child/0/parent/0")));
+        CHECK(loaded.expanded_paths(diagram) == paths);
+    }
+
+    return test::test_result();
+}
@@ -0,0 +1,99 @@
+// OrthogonalRouter: routes are orthogonal, stay out of the blocks in between, and only lines
+// near a moved block are rerouted.
+#include "test_check.hpp"
+#include <diagram_placement/connection_lines.hpp>
+#include <diagram_placement/orthogonal_router.hpp>
+#include <diagram_model/class_diagram.hpp>
+#include <algorithm>
+
+namespace {
+
+using diagram_placement::ConnectionGeometry;
+using diagram_placement::PlacedClassDiagram;
+using diagram_placement::Rect;
+
+diagram_model::DiagramClass make_class(const char* id, const char* parent = nullptr) {
+    diagram_model::DiagramClass c;
+    c.id = id;
+    c.type_name = id;
+    if (parent) c.parent_class_ids.push_back(parent);
+    return c;
+}
+
+void place(PlacedClassDiagram& placed, const diagram_model::ClassDiagram& diagram, std::size_t i, Rect r) {
+    diagram_placement::PlacedClassBlock b;
+    b.class_id = diagram.classes[i].id;
+    b.class_index = i;
+    b.rect = r;
+    placed.blocks.push_back(b);
+}
+
+// Strictly inside, with a little tolerance for points on the inflated boundary.
+bool crosses(const float* a, const float* b, const Rect& r) {
+    const double x0 = std::min(a[0], b[0]), x1 = std::max(a[0], b[0]);
+    const double y0 = std::min(a[1], b[1]), y1 = std::max(a[1], b[1]);
+    return x1 > r.x + 0.5 && x0 < r.x + r.width - 0.5 && y1 > r.y + 0.5 && y0 < r.y + r.height - 0.5;
+}
+
+} // namespace
+
+int main()
+{
+    // Child below, parent above, a block between them (inside the search corridor).
+    diagram_model::ClassDiagram diagram;
+    diagram.classes = { make_class("Parent"), make_class("Child", "Parent"), make_class("Wall"),
+        make_class("Far"), make_class("FarChild", "Far") };
+    PlacedClassDiagram placed;
+    place(placed, diagram, 0, { 0, 0, 100, 50 });
+    place(placed, diagram, 1, { 0, 400, 100, 50 });
+    place(placed, diagram, 2, { -50, 200, 200, 60 });
+    place(placed, diagram, 3, { 2000, 0, 100, 50 });
+    place(placed, diagram, 4, { 2000, 400, 100, 50 });
+    const Rect wall = placed.blocks[2].rect;
+
+    ConnectionGeometry geometry;
+    diagram_placement::build_connection_topology(diagram, geometry);
+    CHECK(geometry.size() == 2);
+
+    diagram_placement::OrthogonalRouterOptions options;
+    options.parallel = false;
+    diagram_placement::OrthogonalRouter router;
+    router.set_options(options);
+    router.route(placed, geometry);
+    CHECK(router.last_rerouted_count() == 2);
+
+    for (std::size_t line = 0; line < geometry.size(); ++line) {
+        const std::uint32_t n = geometry.point_count[line];
+        CHECK(n >= 2);
+        const float* p = geometry.route(line);
+        for (std::uint32_t k = 0; k + 1 < n; ++k) {
+            const float* a = p + 2 * k;
+            const float* b = a + 2;
+            CHECK(a[0] == b[0] || a[1] == b[1]);
+            CHECK(!crosses(a, b, wall));
+        }
+    }
+    // Child top-centre to parent bottom-centre.
+    const float* r0 = geometry.route(0);
+    const std::uint32_t n0 = geometry.point_count[0];
+    CHECK(r0[0] == 50.0f && r0[1] == 400.0f);
+    CHECK(r0[2 * n0 - 2] == 50.0f && r0[2 * n0 - 1] == 50.0f);
+    CHECK(n0 > 2);  // had to go around the wall
+
+    // Nothing moved: nothing rerouted.
+    router.route(placed, geometry);
+    CHECK(router.last_rerouted_count() == 0);
+
+    // Moving the far parent reroutes only its own line.
+    placed.blocks[3].rect.x += 30.0;
+    router.route(placed, geometry);
+    CHECK(router.last_rerouted_count() == 1);
+
+    // The same with the pool.
+    options.parallel = true;
+    router.set_options(options);
+    router.route(placed, geometry);
+    CHECK(router.last_rerouted_count() == 2);
+    CHECK(geometry.point_count[0] == n0);
+    return test::test_result();
+}
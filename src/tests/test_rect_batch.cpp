@@ -0,0 +1,81 @@
+// RectBatch: every kernel the CPU supports gives the same overlaps as the plain expression,
+// with and without gap and inclusive edges, including padding lanes and a begin offset.
+#include "test_check.hpp"
+#include <diagram_placement/rect_batch.hpp>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Box {
+    double left, top, right, bottom;
+};
+
+bool overlaps(const Box& q, const Box& j, double gap, bool inclusive) {
+    if (inclusive) {
+        return q.right + gap >= j.left && j.right + gap >= q.left
+            && q.bottom + gap >= j.top && j.bottom + gap >= q.top;
+    }
+    return q.right + gap > j.left && j.right + gap > q.left && q.bottom + gap > j.top && j.bottom + gap > q.top;
+}
+
+} // namespace
+
+int main()
+{
+    using diagram_placement::RectBatch;
+    using diagram_placement::RectBatchIsa;
+
+    // Coordinates on a coarse grid so that touching edges are common.
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> pos(0, 40);
+    std::uniform_int_distribution<int> extent(1, 8);
+    std::vector<Box> boxes;
+    for (int i = 0; i < 203; ++i) {  // not a multiple of 8: the last group has padding lanes
+        const double x = pos(rng) * 5.0;
+        const double y = pos(rng) * 5.0;
+        boxes.push_back({ x, y, x + extent(rng) * 5.0, y + extent(rng) * 5.0 });
+    }
+    RectBatch batch;
+    for (const Box& b : boxes) batch.push_back(b.left, b.top, b.right, b.bottom);
+    CHECK(batch.size() == boxes.size());
+
+    const RectBatchIsa initial = diagram_placement::rect_batch_isa();
+    int kernels = 0;
+    for (const RectBatchIsa isa : { RectBatchIsa::Scalar, RectBatchIsa::Sse2, RectBatchIsa::Avx2 }) {
+        if (!diagram_placement::set_rect_batch_isa(isa)) continue;
+        ++kernels;
+        bool same = true;
+        for (const double gap : { 0.0, 5.0, -2.5 }) {
+            for (const bool inclusive : { false, true }) {
+                for (std::size_t q = 0; q < boxes.size(); q += 3) {
+                    const Box& b = boxes[q];
+                    const std::size_t begin = q % 11;
+                    std::vector<std::size_t> expected;
+                    for (std::size_t j = begin; j < boxes.size(); ++j)
+                        if (overlaps(b, boxes[j], gap, inclusive)) expected.push_back(j);
+                    std::vector<std::size_t> found;
+                    batch.for_each_overlap(b.left, b.top, b.right, b.bottom, begin, gap, inclusive,
+                        [&](std::size_t j) { found.push_back(j); });
+                    same = same && found == expected;
+                    const std::size_t first = batch.find_first_overlap(b.left, b.top, b.right, b.bottom,
+                        begin, gap, inclusive);
+                    same = same && first == (expected.empty() ? RectBatch::npos : expected.front());
+                }
+            }
+        }
+        CHECK(same);
+    }
+    CHECK(kernels >= 1);
+    CHECK(diagram_placement::set_rect_batch_isa(initial));
+
+    // set() replaces a rect in place.
+    batch.set(0, 1000.0, 1000.0, 1010.0, 1010.0);
+    CHECK(batch.find_first_overlap(1005.0, 1005.0, 1006.0, 1006.0, 0) == 0);
+    batch.clear();
+    CHECK(batch.size() == 0);
+    CHECK(batch.find_first_overlap(0.0, 0.0, 1.0e9, 1.0e9, 0) == RectBatch::npos);
+
+    return test::test_result();
+}
@@ -0,0 +1,94 @@
+// Scenario JSON: every action and trigger parses with its fields and defaults, and malformed
+// scripts are rejected with a message naming the step.
+#include "test_check.hpp"
+#include <scenario/scenario.hpp>
+#include <optional>
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::optional<scenario::Scenario> parse(const std::string& json, std::string* error = nullptr) {
+    std::istringstream in(json);
+    return scenario::load_scenario_from_json(in, error);
+}
+
+} // namespace
+
+int main()
+{
+    using scenario::StepAction;
+    using scenario::StepTrigger;
+
+    const std::optional<scenario::Scenario> s = parse(R"({
+        "diagram": "../example_class_diagram.json", "dt": 0.02, "max_frames": 500, "settle_frames": 12,
+        "steps": [
+          { "at_frame": 10, "action": "expand", "class": "NPC" },
+          { "after_settle": true, "action": "nested_toggle", "path": "NPC/parent/0" },
+          { "action": "nested_toggle", "path": "NPC/child/1", "expanded": false },
+          { "action": "drag", "class": "NPC", "dx": 400, "dy": -20, "frames": 15 },
+          { "action": "drag", "class": "Item" },
+          { "action": "pan", "dx": -200 },
+          { "action": "zoom", "factor": 0.5 },
+          { "action": "collapse", "class": "NPC" },
+          { "action": "toggle", "class": "Item" },
+          { "action": "focus", "class": "Item" } ] })");
+    CHECK(s.has_value());
+    if (s) {
+        CHECK(s->diagram == "../example_class_diagram.json");
+        CHECK(s->dt == 0.02f);
+        CHECK(s->max_frames == 500);
+        CHECK(s->settle_frames == 12);
+        CHECK(s->steps.size() == 10);
+    }
+    if (s && s->steps.size() == 10) {
+        const auto& st = s->steps;
+        CHECK(st[0].trigger == StepTrigger::AtFrame && st[0].at_frame == 10);
+        CHECK(st[0].action == StepAction::Expand && st[0].target == "NPC");
+        CHECK(st[1].trigger == StepTrigger::AfterSettle);
+        CHECK(st[1].action == StepAction::NestedToggle && st[1].target == "NPC/parent/0" && !st[1].expanded);
+        CHECK(st[2].trigger == StepTrigger::AfterPrevious);
+        CHECK(st[2].expanded == std::optional<bool>(false));
+        CHECK(st[3].action == StepAction::Drag && st[3].dx == 400.0 && st[3].dy == -20.0 && st[3].frames == 15);
+        CHECK(st[4].dx == 0.0 && st[4].dy == 0.0 && st[4].frames == 30);
+        CHECK(st[5].action == StepAction::Pan && st[5].dx == -200.0 && st[5].dy == 0.0);
+        CHECK(st[6].action == StepAction::Zoom && st[6].factor == 0.5);
+        CHECK(st[7].action == StepAction::Collapse);
+        CHECK(st[8].action == StepAction::Toggle);
+        CHECK(st[9].action == StepAction::Focus && st[9].target == "Item");
+    }
+    CHECK(std::string(scenario::step_action_name(StepAction::NestedToggle)) == "nested_toggle");
+
+    // Defaults when the script gives only steps.
+    const std::optional<scenario::Scenario> minimal = parse(R"({ "steps": [] })");
+    CHECK(minimal && minimal->diagram.empty() && minimal->steps.empty());
+    CHECK(minimal && minimal->max_frames == 3000 && minimal->settle_frames == 30);
+
+    struct Bad {
+        const char* json;
+        const char* error;  // expected message, or nullptr for any
+    };
+    const Bad bad[] = {
+        { R"({ "steps": [ { "action": "fly" } ] })", R"(step 0: unknown action "fly")" },
+        { R"({ "steps": [ { "action": "expand", "class": "A" }, { "action": "drag" } ] })",
+            R"(step 1: drag needs "class")" },
+        { R"({ "steps": [ { "action": "nested_toggle" } ] })", R"(step 0: nested_toggle needs "path")" },
+        { R"({ "steps": [ { "action": "zoom", "factor": 0 } ] })", R"(step 0: zoom needs a positive "factor")" },
+        { R"({ "steps": [ 3 ] })", "step 0: not an object" },
+        { R"({ "dt": -1, "steps": [] })", R"("dt" must be positive)" },
+        { R"({ "diagram": "x.json" })", R"(no "steps" array)" },
+        { R"({ "steps": )", nullptr },
+    };
+    for (const Bad& b : bad) {
+        std::string error;
+        CHECK(!parse(b.json, &error));
+        CHECK(!error.empty());
+        if (b.error) CHECK(error == b.error);
+    }
+
+    std::string error;
+    CHECK(!scenario::load_scenario_from_json_file("no/such/scenario.json", &error));
+    CHECK(error == "cannot open no/such/scenario.json");
+
+    return test::test_result();
+}
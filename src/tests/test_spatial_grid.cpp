@@ -0,0 +1,76 @@
+// SpatialGrid: area and point queries report exactly the intersecting items, each once, for
+// items spanning several cells and queries reaching outside the grid.
+#include "test_check.hpp"
+#include <diagram_placement/spatial_grid.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+int main()
+{
+    using diagram_placement::Rect;
+    using diagram_placement::SpatialGrid;
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> pos(-500.0, 500.0);
+    std::uniform_real_distribution<double> small(1.0, 40.0);
+    std::vector<Rect> rects;
+    for (int i = 0; i < 400; ++i)
+        rects.push_back({ pos(rng), pos(rng), small(rng), small(rng) });
+    rects.push_back({ -450.0, -20.0, 900.0, 40.0 });  // spans a whole row of cells
+    rects.push_back({ 100.0, 100.0, 0.0, 0.0 });      // empty rect
+
+    for (const double cell_size : { 0.0, 7.0, 250.0 }) {
+        SpatialGrid grid;
+        grid.build(rects, cell_size);
+        CHECK(grid.size() == rects.size());
+
+        bool exact = true;
+        for (int q = 0; q < 300 && exact; ++q) {
+            const Rect area = q % 10 == 0
+                ? Rect{ pos(rng) * 3.0, pos(rng) * 3.0, 2000.0, 2000.0 }  // partly outside the grid
+                : Rect{ pos(rng), pos(rng), small(rng) * 3.0, small(rng) * 3.0 };
+            std::vector<std::uint32_t> expected;
+            for (std::uint32_t i = 0; i < rects.size(); ++i)
+                if (diagram_placement::rects_intersect(rects[i], area)) expected.push_back(i);
+            std::vector<std::uint32_t> found;
+            grid.query(area, [&](std::uint32_t item) { found.push_back(item); });
+            std::sort(found.begin(), found.end());
+            exact = found == expected;  // also fails on duplicates
+        }
+        CHECK(exact);
+
+        bool points = true;
+        for (int q = 0; q < 300 && points; ++q) {
+            const double x = pos(rng);
+            const double y = pos(rng);
+            std::vector<std::uint32_t> expected;
+            for (std::uint32_t i = 0; i < rects.size(); ++i) {
+                const Rect& r = rects[i];
+                if (x >= r.x && x <= r.x + r.width && y >= r.y && y <= r.y + r.height) expected.push_back(i);
+            }
+            std::vector<std::uint32_t> found;
+            grid.query_point(x, y, [&](std::uint32_t item) { found.push_back(item); });
+            std::sort(found.begin(), found.end());
+            points = found == expected;
+        }
+        CHECK(points);
+        // Corner of the empty rect, and far outside the grid.
+        std::vector<std::uint32_t> found;
+        grid.query_point(100.0, 100.0, [&](std::uint32_t item) { found.push_back(item); });
+        CHECK(std::count(found.begin(), found.end(), 401u) == 1);
+        found.clear();
+        grid.query_point(1.0e6, 1.0e6, [&](std::uint32_t item) { found.push_back(item); });
+        CHECK(found.empty());
+    }
+
+    SpatialGrid empty;
+    empty.build({});
+    int calls = 0;
+    empty.query({ 0.0, 0.0, 10.0, 10.0 }, [&](std::uint32_t) { ++calls; });
+    empty.query_point(0.0, 0.0, [&](std::uint32_t) { ++calls; });
+    CHECK(empty.empty() && calls == 0);
+
+    return test::test_result();
+}
@@ -0,0 +1,64 @@
+// TextMeasureCache: repeated measurements come from the cache, invalidate() drops strings and
+// widths, and loading diagrams one after another does not grow the string table.
+#include "test_check.hpp"
+#include <canvas/canvas.hpp>
+#include <diagram_loaders/synthetic_class_diagram.hpp>
+#include <diagram_render/text_measure_cache.hpp>
+#include "imgui.h"
+#include <string>
+
+namespace {
+
+void begin_headless_frame() {
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels = nullptr;
+    int w = 0, h = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+    ImGui::NewFrame();
+}
+
+} // namespace
+
+int main()
+{
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+    begin_headless_frame();
+
+    auto& cache = diagram_render::TextMeasureCache::shared();
+    cache.invalidate();
+    const double health = cache.width("Health");
+    CHECK(health > 0.0);
+    CHECK(cache.width("Health") == health);
+    CHECK(cache.width("Health points") > health);
+    CHECK(cache.width("") == 0.0);
+    CHECK(cache.interned_count() == 2);
+    CHECK(cache.measured_count() == 2);
+    CHECK(health == static_cast<double>(ImGui::CalcTextSize("Health").x));
+
+    cache.invalidate();
+    CHECK(cache.interned_count() == 0);
+    CHECK(cache.measured_count() == 0);
+    CHECK(cache.width("Health") == health);
+
+    // Each diagram brings its own class names; the table holds only the current diagram's.
+    {
+        canvas::DiagramCanvas canvas;
+        std::size_t first = 0;
+        for (std::uint32_t seed = 1; seed <= 4; ++seed) {
+            auto diagram = diagram_loaders::generate_synthetic_class_diagram(200, seed);
+            for (auto& c : diagram.classes) c.type_name = "Round" + std::to_string(seed) + c.id;
+            canvas.set_class_diagram(&diagram);
+            if (seed == 1) first = cache.interned_count();
+            CHECK(cache.interned_count() > 0);
+            CHECK(cache.interned_count() <= first + first / 2);
+            canvas.set_class_diagram(nullptr);
+        }
+    }
+
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    return test::test_result();
+}
@@ -0,0 +1,75 @@
+// WorkerPool: every item runs once, nested calls (also through another pool) run serially
+// instead of deadlocking, and concurrent callers never share a worker id.
+#include "test_check.hpp"
+#include <diagram_placement/worker_pool.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    diagram_placement::WorkerPool pool(3);
+    CHECK(pool.concurrency() == 4);
+
+    std::vector<std::atomic<int>> hits(10000);
+    pool.parallel_for(hits.size(), 1, [&](std::size_t begin, std::size_t end, unsigned worker) {
+        CHECK(worker < pool.concurrency());
+        for (std::size_t i = begin; i < end; ++i) ++hits[i];
+    });
+    bool once = true;
+    for (const auto& h : hits) once = once && h.load() == 1;
+    CHECK(once);
+
+    // Nested: the inner loop runs on the chunk's thread with the chunk's worker id.
+    std::atomic<std::size_t> inner{ 0 };
+    std::atomic<int> wrong_worker{ 0 };
+    pool.parallel_for(64, 1, [&](std::size_t begin, std::size_t end, unsigned worker) {
+        for (std::size_t i = begin; i < end; ++i) {
+            pool.parallel_for(100, 1, [&](std::size_t b, std::size_t e, unsigned nested_worker) {
+                if (nested_worker != worker) ++wrong_worker;
+                inner += e - b;
+            });
+        }
+    });
+    CHECK(inner.load() == 64u * 100u);
+    CHECK(wrong_worker.load() == 0);
+
+    // Across pools: after a chunk of `pool` calls another pool, a nested call back into `pool`
+    // still runs serially on the chunk's worker instead of waiting for itself.
+    diagram_placement::WorkerPool other(2);
+    std::atomic<std::size_t> back{ 0 };
+    std::atomic<int> wrong_back{ 0 };
+    pool.parallel_for(16, 1, [&](std::size_t begin, std::size_t end, unsigned worker) {
+        for (std::size_t i = begin; i < end; ++i) {
+            other.parallel_for(50, 1, [&](std::size_t b, std::size_t e, unsigned) {
+                for (std::size_t j = b; j < e; ++j) ++back;
+            });
+            pool.parallel_for(10, 1, [&](std::size_t b, std::size_t e, unsigned nested_worker) {
+                if (nested_worker != worker) ++wrong_back;
+                back += e - b;
+            });
+        }
+    });
+    CHECK(back.load() == 16u * 60u);
+    CHECK(wrong_back.load() == 0);
+
+    // Concurrent callers: a worker id is never used by two chunks at once.
+    std::vector<std::atomic<int>> in_use(pool.concurrency());
+    std::atomic<int> collisions{ 0 };
+    auto caller = [&] {
+        for (int round = 0; round < 200; ++round) {
+            pool.parallel_for(256, 1, [&](std::size_t, std::size_t, unsigned worker) {
+                if (in_use[worker]++ != 0) ++collisions;
+                std::this_thread::yield();
+                --in_use[worker];
+            });
+        }
+    };
+    std::thread a(caller);
+    std::thread b(caller);
+    caller();
+    a.join();
+    b.join();
+    CHECK(collisions.load() == 0);
+    return test::test_result();
+}